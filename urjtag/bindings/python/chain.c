@@ -1042,10 +1042,92 @@ urjtag_loglevel (PyObject *self, PyObject *args)
     return Py_BuildValue ("");
 }
 
+static PyObject *
+urjtag_run_svf_gang (PyObject *self, PyObject *args)
+{
+    char *fname;
+    PyObject *seq, *item, *list, *exc_args, *rc = NULL;
+    int stop = 0, status;
+    unsigned long ref_freq = 0;
+    urj_chain_t **chains = NULL;
+    int *results = NULL;
+    Py_ssize_t num_chains, i;
+    FILE *svf_file;
+
+    if (!PyArg_ParseTuple (args, "sO|iI", &fname, &seq, &stop, &ref_freq))
+        return NULL;
+
+    seq = PySequence_Fast (seq, "chains must be a sequence of chain objects");
+    if (seq == NULL)
+        return NULL;
+    num_chains = PySequence_Fast_GET_SIZE (seq);
+
+    chains = PyMem_New (urj_chain_t *, num_chains);
+    results = PyMem_New (int, num_chains);
+    if (chains == NULL || results == NULL)
+    {
+        PyErr_NoMemory ();
+        goto out;
+    }
+    for (i = 0; i < num_chains; i++)
+    {
+        item = PySequence_Fast_GET_ITEM (seq, i);
+        if (!PyObject_TypeCheck (item, &urj_pychain_Type))
+        {
+            PyErr_SetString (PyExc_TypeError,
+                             "chains must be a sequence of chain objects");
+            goto out;
+        }
+        chains[i] = ((urj_pychain_t *) item)->urchain;
+        if (!urj_pyc_precheck (chains[i], UPRC_CBL))
+            goto out;
+    }
+
+    svf_file = fopen (fname, FOPEN_R);
+    if (!svf_file)
+    {
+        PyErr_SetFromErrnoWithFilename(PyExc_IOError, fname);
+        goto out;
+    }
+    status = urj_svf_run_gang (chains, num_chains, svf_file, stop, ref_freq,
+                               results);
+    fclose (svf_file);
+
+    /* one boolean per chain, True if it passed */
+    list = PyList_New (num_chains);
+    for (i = 0; list != NULL && i < num_chains; i++)
+        PyList_SET_ITEM (list, i,
+                         PyBool_FromLong (results[i] == URJ_STATUS_OK));
+    if (list == NULL || status == URJ_STATUS_OK)
+    {
+        rc = list;
+        goto out;
+    }
+
+    /* the exception carries the results as its second argument */
+    exc_args = Py_BuildValue ("(sN)", urj_error_get () ? urj_error_describe ()
+                              : _("liburjtag BUG: unknown urjtag error"),
+                              list);
+    urj_error_reset ();
+    if (exc_args != NULL)
+    {
+        PyErr_SetObject (UrjtagError, exc_args);
+        Py_DECREF (exc_args);
+    }
+
+ out:
+    PyMem_Free (chains);
+    PyMem_Free (results);
+    Py_DECREF (seq);
+    return rc;
+}
+
 static PyMethodDef module_methods[] =
 {
     {"loglevel", urjtag_loglevel, METH_VARARGS,
      "Set log level of the urjtag library"},
+    {"run_svf_gang", urjtag_run_svf_gang, METH_VARARGS,
+     "Play a named SVF file on a list of chains in lockstep; returns a list of pass/fail results, on failure these are the second argument of the exception"},
     {NULL}                      /* Sentinel */
 };
 
@@ -32,6 +32,7 @@
 typedef struct
 {
     char **path_list;
+    char *cache_dir;            /* directory of binary part cache, or NULL */
     int debug;
 }
 urj_bsdl_globs_t;
@@ -39,6 +40,7 @@ urj_bsdl_globs_t;
 #define URJ_BSDL_GLOBS_INIT(bsdl) \
     do { \
         bsdl.path_list = NULL; \
+        bsdl.cache_dir = NULL; \
         bsdl.debug = 0; \
     } while (0)
 
@@ -51,6 +53,14 @@ urj_bsdl_globs_t;
  */
 int urj_bsdl_read_file (urj_chain_t *, const char *, int, const char *);
 void urj_bsdl_set_path (urj_chain_t *, const char *);
+/**
+ * Set the directory for the binary part cache. Parts matched during
+ * urj_bsdl_scan_files() are stored there per IDCODE and re-used on later
+ * scans as long as the originating BSDL file is unchanged.
+ * Passing NULL disables the cache.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_bsdl_set_cache (urj_chain_t *, const char *);
 /* @@@@ RFHH ToDo: let urj_bsdl_scan_files also return URJ_STATUS_... */
 /**
  * @return
@@ -0,0 +1,103 @@
+/*
+ * $Id$
+ *
+ * Copyright (C) 2026, UrJTAG developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#ifndef URJ_BSGROUP_H
+#define URJ_BSGROUP_H
+
+#include <stdint.h>
+
+#include "types.h"
+
+#define URJ_PART_GROUP_MAXWIDTH     64
+
+/**
+ * A pin group is an ordered list of signals of one part, compiled to the
+ * positions of their cells in the Boundary Scan Register. It allows to
+ * drive or sample a bus of up to URJ_PART_GROUP_MAXWIDTH signals with a
+ * single call instead of one urj_part_set_signal() per signal.
+ */
+struct URJ_PART_GROUP
+{
+    char *name;
+    urj_part_group_t *next;
+    int width;
+    urj_part_signal_t **signals; /* signals[0] is bit 0 of the value */
+    int *output;                /* BSR bit of the output cell, -1 for none */
+    int *control;               /* BSR bit of the control cell, -1 for none */
+    char *enable;               /* control cell value enabling the output */
+    int *input;                 /* BSR bit of the input cell, -1 for none */
+    int no_output;              /* first signal without output cell or -1 */
+    int no_input;               /* first signal without input cell or -1 */
+};
+
+/**
+ * Compile a group from signal handles. The group is not added to the part.
+ *
+ * @param part    part the signals belong to, must have a BSR
+ * @param name    group name
+ * @param signals signal handles, signals[0] becomes bit 0
+ * @param width   number of signals, 1 .. URJ_PART_GROUP_MAXWIDTH
+ *
+ * @return group on success; NULL on error
+ */
+urj_part_group_t *urj_part_group_alloc (urj_part_t *part, const char *name,
+                                        urj_part_signal_t * const *signals,
+                                        int width);
+void urj_part_group_free (urj_part_group_t *g);
+
+/**
+ * Compile a group from signal names and add it to the part.
+ *
+ * @return group on success; NULL on error
+ */
+urj_part_group_t *urj_part_group_define (urj_part_t *part, const char *name,
+                                         const char * const *signal_names,
+                                         int width);
+/* @return group pointer on success; NULL if not found but does not set
+ * urj_error; NULL on error */
+urj_part_group_t *urj_part_find_group (urj_part_t *part, const char *name);
+
+/**
+ * Set all signals of a group in the input BSR, equivalent to calling
+ * urj_part_set_signal() for every signal with the matching bit of value.
+ *
+ * @param out   1 to drive value onto the signals, 0 to make them inputs
+ * @param value bit i is driven onto signals[i], ignored if out is 0
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_part_group_set (urj_part_t *part, const urj_part_group_t *g, int out,
+                        uint64_t value);
+#define urj_part_group_set_value(p, g, v)   urj_part_group_set ((p), (g), 1, (v))
+#define urj_part_group_set_input(p, g)      urj_part_group_set ((p), (g), 0, 0)
+
+/**
+ * Sample all signals of a group from the output BSR.
+ *
+ * @param value receives bit i from signals[i]
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_part_group_get (urj_part_t *part, const urj_part_group_t *g,
+                        uint64_t *value);
+
+#endif /* URJ_BSGROUP_H */
@@ -177,6 +177,13 @@ struct URJ_CABLE
     urj_cable_queue_info_t done;
     uint32_t delay;
     uint32_t frequency;
+    /* seconds spent in driver calls that move data, TCK cycles issued and
+       number of times the caller waited for data from the cable, only
+       accumulated while io_timing is set */
+    int io_timing;
+    double io_time;
+    uint64_t io_clocks;
+    unsigned long io_round_trips;
 };
 
 void urj_tap_cable_free (urj_cable_t *cable);
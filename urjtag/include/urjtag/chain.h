@@ -45,6 +45,12 @@ struct URJ_CHAIN
     urj_cable_t *cable;
     urj_bsdl_globs_t bsdl;
     int main_part;
+    /* scratch registers holding all parts' IR or DR for a single scan */
+    urj_tap_register_t *scan_in;
+    urj_tap_register_t *scan_out;
+    /* IR of all parts as shifted by the last complete instruction scan */
+    urj_tap_register_t *ir_shifted;
+    int ir_valid;
 };
 
 urj_chain_t *urj_tap_chain_alloc (void);
@@ -68,7 +74,13 @@ int urj_tap_chain_defer_clock (urj_chain_t *chain, int tms, int tdi, int n);
 int urj_tap_chain_set_trst (urj_chain_t *chain, int trst);
 /** @return 0 or 1 on success; -1 on error */
 int urj_tap_chain_get_trst (urj_chain_t *chain);
-/** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
+/**
+ * Shift the active instructions of all parts into the chain and go to
+ * Run-Test/Idle. The scan is skipped if the chain is in Run-Test/Idle and
+ * no part's instruction changed since the last complete instruction scan.
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
 int urj_tap_chain_shift_instructions (urj_chain_t *chain);
 /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
 int urj_tap_chain_shift_instructions_mode (urj_chain_t *chain,
@@ -81,6 +93,35 @@ int urj_tap_chain_shift_data_registers (urj_chain_t *chain,
 int urj_tap_chain_shift_data_registers_mode (urj_chain_t *chain,
                                              int capture_output, int capture,
                                              int chain_exit);
+/**
+ * Queue the shift of the instruction registers of all parts like
+ * urj_tap_chain_shift_instructions_mode() with capture_output set, but do
+ * not wait for the captured bits. They are fetched later with
+ * urj_tap_shift_register_output (chain, out, out, chain_exit) into the
+ * returned register, in the order the scans were queued. The register
+ * holds the instruction registers of all parts, part 0 at bit 0, and must
+ * be freed by the caller.
+ *
+ * @return register for the captured bits; NULL on error
+ */
+urj_tap_register_t *urj_tap_chain_defer_shift_instructions_mode (
+                                    urj_chain_t *chain, int capture,
+                                    int chain_exit);
+/**
+ * Same as urj_tap_chain_defer_shift_instructions_mode() for the data
+ * registers of all parts.
+ *
+ * @return register for the captured bits; NULL on error
+ */
+urj_tap_register_t *urj_tap_chain_defer_shift_data_registers_mode (
+                                    urj_chain_t *chain, int capture,
+                                    int chain_exit);
+/**
+ * Forget the instructions shifted by the last instruction scan, so that
+ * the next urj_tap_chain_shift_instructions() really scans the IR. Done
+ * automatically on TAP reset, TRST and any other IR scan.
+ */
+void urj_tap_chain_invalidate_ir (urj_chain_t *chain);
 void urj_tap_chain_flush (urj_chain_t *chain);
 /** @return 0 or 1 on success; -1 on failure */
 int urj_tap_chain_set_pod_signal (urj_chain_t *chain, int mask, int val);
@@ -76,6 +76,8 @@ typedef enum URJ_ERROR
     URJ_ERROR_UNIMPLEMENTED,
 
     URJ_ERROR_FIRMWARE,
+
+    URJ_ERROR_STAPL,
 }
 urj_error_t;
 
@@ -45,6 +45,10 @@ extern "C"
 time*/
 long double urj_lib_frealtime (CVOID);
 
+/* return the time in seconds of a clock that is not affected by changes
+of the system time, if the platform provides one */
+long double urj_lib_fmonotime (CVOID);
+
 
 #ifdef __cplusplus
 }
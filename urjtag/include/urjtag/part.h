@@ -31,6 +31,8 @@
 #define URJ_PART_PART_MAXLEN            20
 #define URJ_PART_STEPPING_MAXLEN         8
 
+typedef struct URJ_PART_HASH urj_part_hash_t;
+
 struct URJ_PART_PARAMS
 {
     void (*free) (void *);
@@ -47,6 +49,7 @@ struct URJ_PART
     char stepping[URJ_PART_STEPPING_MAXLEN + 1];
     urj_part_signal_t *signals;
     urj_part_salias_t *saliases;
+    urj_part_group_t *groups;
     int instruction_length;
     urj_part_instruction_t *instructions;
     urj_part_instruction_t *active_instruction;
@@ -54,6 +57,12 @@ struct URJ_PART
     int boundary_length;
     urj_bsbit_t **bsbits;
     urj_part_params_t *params;
+    urj_data_register_t *bsr;   /* cached Boundary Scan Register */
+    /* name indices for the lookup functions, maintained by part.c */
+    urj_part_hash_t *signal_hash;
+    urj_part_hash_t *salias_hash;
+    urj_part_hash_t *instruction_hash;
+    urj_part_hash_t *data_register_hash;
 };
 
 urj_part_t *urj_part_alloc (const urj_tap_register_t *id);
@@ -70,6 +79,26 @@ urj_data_register_t *urj_part_find_data_register (urj_part_t *p,
  * urj_error; NULL on error */
 urj_part_signal_t *urj_part_find_signal (urj_part_t *p,
                                          const char *signalname);
+/**
+ * Resolve a list of signal names to signal handles in one go. The handles
+ * remain valid for the lifetime of the part, so bus drivers should resolve
+ * their signals once at initialization and keep the pointers.
+ *
+ * @param p       part to search
+ * @param names   array of signal or signal alias names
+ * @param signals receives the handles, same order as names
+ * @param n       number of entries in names and signals
+ *
+ * @return URJ_STATUS_OK if all signals were found; URJ_STATUS_FAIL and
+ *         urj_error set to URJ_ERROR_NOTFOUND for the first unknown name
+ */
+int urj_part_find_signals (urj_part_t *p, const char * const *names,
+                           urj_part_signal_t **signals, int n);
+/**
+ * @return Boundary Scan Register of the part; NULL if the part has none,
+ *         but does not set urj_error
+ */
+urj_data_register_t *urj_part_get_bsr (urj_part_t *p);
 void urj_part_set_instruction (urj_part_t *p, const char *iname);
 /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
 int urj_part_set_signal (urj_part_t *p, urj_part_signal_t *s, int out, int val);
@@ -25,9 +25,54 @@
 #ifndef URJ_STAPL_H
 #define URJ_STAPL_H
 
+#include <stdio.h>
+
 #include "types.h"
 
+/**
+ * urj_stapl_run(chain, STAPL_file_name, STAPL_action)
+ *
+ * Executes an action of a STAPL program on the chain.  The interpreter
+ * keeps its state per thread, so several threads may each run a program
+ * on their own chain at the same time.  Messages and errors however are
+ * reported through urj_log() and urj_error_state, which are shared by the
+ * whole process: output of concurrent runs may interleave, and the error
+ * state is not protected, so an error in one thread can race with an
+ * error in another.  Rely on the return value of each call, and only
+ * read urj_error_state when no other run is active.
+ *
+ * @param chain           pointer to global chain
+ * @param STAPL_file_name file name of STAPL file
+ * @param STAPL_action    action to execute, as "-aACTION"
+ *
+ * @return
+ *   URJ_STATUS_OK when the action ran with exit code 0;
+ *   URJ_STATUS_FAIL if the file cannot be loaded, the program stops with
+ *   an error or a nonzero exit code, or its CRC does not match
+ */
 int urj_stapl_run (urj_chain_t *chain, char *STAPL_file_name,
                    char *STAPL_action);
 
+/**
+ * urj_stapl_run_profile(chain, STAPL_file_name, STAPL_action, PROFILE_FILE)
+ *
+ * Like urj_stapl_run(), additionally writes an execution profile to
+ * PROFILE_FILE as JSON records, one per line: a "procedure" record for
+ * every procedure and data block with the number of calls, the time from
+ * call to end, the time spent in its own statements and the bits scanned
+ * by them, followed by a "line" record for every statement executed with
+ * its count, time and bits scanned.  Each group is sorted by time, the
+ * longest first.
+ *
+ * @param chain           pointer to global chain
+ * @param STAPL_file_name file name of STAPL file
+ * @param STAPL_action    action to execute, as "-aACTION"
+ * @param PROFILE_FILE    file handle for the JSON records, NULL for none
+ *
+ * @return
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ */
+int urj_stapl_run_profile (urj_chain_t *chain, char *STAPL_file_name,
+                           char *STAPL_action, FILE *PROFILE_FILE);
+
 #endif /* URJ_STAPL_H */
@@ -53,4 +53,134 @@
 int urj_svf_run (urj_chain_t *chain, FILE *SVF_FILE, int stop_on_mismatch,
                  uint32_t ref_freq);
 
+/**
+ * ***************************************************************************
+ * urj_svf_run_profile(chain, SVF_FILE, stop_on_mismatch, ref_freq,
+ *                     PROFILE_FILE)
+ *
+ * Like urj_svf_run(), additionally writes JSON records to PROFILE_FILE, one
+ * per line: a "progress" record for every percent of the input with the
+ * elapsed and the estimated remaining time, and finally a "profile" record
+ * with count, bits, time, time spent in cable I/O and throughput for
+ * SIR, SDR, RUNTEST, STATE, the deferred TDO verification and the rest
+ * ("parse").
+ *
+ * @param chain            pointer to global chain
+ * @param SVF_FILE         file handle of SVF file
+ * @param stop_on_mismatch 1 = stop upon tdo mismatch
+ *                         0 = continue upon mismatch
+ * @param ref_freq         reference frequency for RUNTEST
+ * @param PROFILE_FILE     file handle for the JSON records, NULL for none
+ *
+ * @return
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ * ***************************************************************************/
+
+int urj_svf_run_profile (urj_chain_t *chain, FILE *SVF_FILE,
+                         int stop_on_mismatch, uint32_t ref_freq,
+                         FILE *PROFILE_FILE);
+
+/**
+ * ***************************************************************************
+ * urj_svf_dry_run(chain, SVF_FILE, ref_freq, latency, PROFILE_FILE)
+ *
+ * Executes SVF_FILE without a target, usually on the jim cable, to predict
+ * the programming time. TDO is captured but not verified and SIR/SDR are
+ * shifted as scans of the whole chain with the command's length. The TCK
+ * cycles issued and the round trips, i.e. the times the host waits for TDO
+ * from the cable, are counted per command type and logged together with
+ * the time a cable would need for them. On a real cable the commands reach
+ * the target unverified; the svf command refuses that without 'force'.
+ *
+ * @param chain        pointer to global chain
+ * @param SVF_FILE     file handle of SVF file
+ * @param ref_freq     TCK frequency of the predicted cable and reference
+ *                     for RUNTEST, 0 = frequency set by the file or cable
+ * @param latency      seconds per round trip of the predicted cable
+ * @param PROFILE_FILE file handle for JSON records as written by
+ *                     urj_svf_run_profile(), NULL for none
+ *
+ * @return
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ * ***************************************************************************/
+
+int urj_svf_dry_run (urj_chain_t *chain, FILE *SVF_FILE, uint32_t ref_freq,
+                     double latency, FILE *PROFILE_FILE);
+
+/**
+ * ***************************************************************************
+ * urj_svf_compile(chain, SVF_FILE, BIN_FILE, ref_freq)
+ *
+ * Translates the SVF commands into a binary vector file that urj_svf_run()
+ * plays back without parsing. TDI/TDO/MASK are stored packed, state paths
+ * are resolved and RUNTEST times are converted to clock counts.
+ *
+ * The chain has to be detected, SIR lengths are checked against the active
+ * part.
+ *
+ * @param chain    pointer to global chain
+ * @param SVF_FILE file handle of SVF file
+ * @param BIN_FILE file handle the binary vectors are written to
+ * @param ref_freq reference frequency for RUNTEST, 0 = cable frequency
+ *
+ * @return
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ * ***************************************************************************/
+
+int urj_svf_compile (urj_chain_t *chain, FILE *SVF_FILE, FILE *BIN_FILE,
+                     uint32_t ref_freq);
+
+/**
+ * ***************************************************************************
+ * urj_svf_run_xsvf(chain, XSVF_FILE, stop_on_mismatch, ref_freq)
+ *
+ * Main entry point for the 'xsvf' command. Executes the binary XSVF
+ * commands from XSVF_FILE on the active part, like urj_svf_run() does for
+ * SVF. The file is read sequentially, XREPEAT retries are supported.
+ *
+ * @param chain            pointer to global chain
+ * @param XSVF_FILE        file handle of XSVF file
+ * @param stop_on_mismatch 1 = stop upon tdo mismatch
+ *                         0 = continue upon mismatch
+ * @param ref_freq         reference frequency for XRUNTEST and XWAIT
+ *
+ * @return
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ * ***************************************************************************/
+
+int urj_svf_run_xsvf (urj_chain_t *chain, FILE *XSVF_FILE,
+                      int stop_on_mismatch, uint32_t ref_freq);
+
+/**
+ * ***************************************************************************
+ * urj_svf_run_gang(chains, num_chains, SVF_FILE, stop_on_mismatch, ref_freq,
+ *                  results)
+ *
+ * Executes one SVF file on several chains with identical boards, e.g. a
+ * gang programmer with one cable per board. The file is translated once
+ * as with urj_svf_compile() on the first chain, then the vectors are played
+ * on all chains in lockstep. Each chain has its own TDO verification and
+ * result; mismatches are reported as "svf[index]". Captured TDO is read
+ * back only when the transfers of all cables have been started, so the
+ * cables work in parallel. The jtag shell drives a single chain, this is
+ * available to programs and the Python binding (urjtag.run_svf_gang).
+ *
+ * @param chains           chains to program, each with its own cable
+ * @param num_chains       number of chains
+ * @param SVF_FILE         file handle of SVF file, may be compiled already
+ * @param stop_on_mismatch 1 = stop a chain upon tdo mismatch
+ *                         0 = continue upon mismatch
+ * @param ref_freq         reference frequency for RUNTEST
+ * @param results          num_chains entries, receive URJ_STATUS_OK for each
+ *                         chain that passed without error or mismatch,
+ *                         URJ_STATUS_FAIL otherwise
+ *
+ * @return
+ *   URJ_STATUS_OK if the file was executed, see results for each chain;
+ *   URJ_STATUS_FAIL if it could not be prepared
+ * ***************************************************************************/
+
+int urj_svf_run_gang (urj_chain_t **chains, int num_chains, FILE *SVF_FILE,
+                      int stop_on_mismatch, uint32_t ref_freq, int *results);
+
 #endif /* URJ_SVF_H */
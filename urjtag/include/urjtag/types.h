@@ -36,6 +36,7 @@ typedef struct URJ_PART urj_part_t;
 typedef struct URJ_PARTS urj_parts_t;
 typedef struct URJ_PART_SIGNAL urj_part_signal_t;
 typedef struct URJ_PART_SALIAS urj_part_salias_t;
+typedef struct URJ_PART_GROUP urj_part_group_t;
 typedef struct URJ_PART_INSTRUCTION urj_part_instruction_t;
 typedef struct URJ_PART_PARAMS urj_part_params_t;
 typedef struct URJ_PART_INIT urj_part_init_t;
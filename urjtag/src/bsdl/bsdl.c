@@ -41,6 +41,7 @@
 #include "bsdl_types.h"
 #include "vhdl_parser.h"
 #include "bsdl_parser.h"
+#include "bsdl_cache.h"
 
 #include "bsdl_msg.h"
 
@@ -228,6 +229,49 @@ urj_bsdl_set_path (urj_chain_t *chain, const char *pathlist)
 }
 
 
+/*****************************************************************************
+ * int urj_bsdl_set_cache( chain, dir )
+ *
+ * Sets the directory that holds the binary part cache. A NULL dir
+ * disables the cache.
+ *
+ * Parameters
+ *   chain : pointer to active chain structure
+ *   dir   : cache directory
+ *
+ * Returns
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ ****************************************************************************/
+int
+urj_bsdl_set_cache (urj_chain_t *chain, const char *dir)
+{
+    urj_bsdl_globs_t *globs = &(chain->bsdl);
+    struct stat buf;
+    char *new_dir = NULL;
+
+    if (dir != NULL)
+    {
+        if (stat (dir, &buf) != 0 || !S_ISDIR (buf.st_mode))
+        {
+            urj_error_set (URJ_ERROR_IO, _("'%s' is not a directory"), dir);
+            return URJ_STATUS_FAIL;
+        }
+
+        new_dir = strdup (dir);
+        if (new_dir == NULL)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "strdup(%s) fails", dir);
+            return URJ_STATUS_FAIL;
+        }
+    }
+
+    free (globs->cache_dir);
+    globs->cache_dir = new_dir;
+
+    return URJ_STATUS_OK;
+}
+
+
 /*****************************************************************************
  * urj_bsdl_scan_files( chain, idcode, proc_mode )
  *
@@ -236,6 +280,8 @@ urj_bsdl_set_path (urj_chain_t *chain, const char *pathlist)
  * If mode >= 1 is requested, it will read the first BSDL file with matching
  * idcode in "execute" mode. I.e. all extracted statements are applied to
  * the current part.
+ * When a cache directory is set and a matching part is to be applied, the
+ * cache is consulted first and updated after a BSDL file has matched.
  *
  * Parameters
  *   chain     : pointer to active chain structure
@@ -259,6 +305,11 @@ urj_bsdl_scan_files (urj_chain_t *chain, const char *idcode, int proc_mode)
     if (globs->path_list == NULL)
         return 0;
 
+    if ((proc_mode & URJ_BSDL_MODE_INSTR_EXEC)
+        && (proc_mode & URJ_BSDL_MODE_IDCODE_CHECK)
+        && urj_bsdl_cache_load (chain, idcode, proc_mode) > 0)
+        return 1;
+
     while (globs->path_list[idx] && (result <= 0))
     {
         DIR *dir;
@@ -290,7 +341,13 @@ urj_bsdl_scan_files (urj_chain_t *chain, const char *idcode, int proc_mode)
                             result = urj_bsdl_read_file (chain, name, proc_mode,
                                                          idcode);
                             if (result == 1)
+                            {
                                 printf (_("  Filename:     %s\n"), name);
+                                if (proc_mode & URJ_BSDL_MODE_INSTR_EXEC)
+                                    (void) urj_bsdl_cache_store (chain, idcode,
+                                                                 name,
+                                                                 proc_mode);
+                            }
                         }
                     }
 
@@ -0,0 +1,632 @@
+/*
+ * $Id$
+ *
+ * Copyright (C) 2026, UrJTAG developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ * This file implements a binary cache of the part descriptions that were
+ * extracted from BSDL files. A cache entry is stored per IDCODE and holds
+ * everything that urj_bsdl_process_elements() applies to a part, so that
+ * 'detect' can skip scanning and parsing the BSDL files on subsequent runs.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <sys/stat.h>
+
+#include <urjtag/chain.h>
+#include <urjtag/part.h>
+#include <urjtag/part_instruction.h>
+#include <urjtag/data_register.h>
+#include <urjtag/bssignal.h>
+#include <urjtag/bsbit.h>
+#include <urjtag/tap_register.h>
+
+#include "bsdl_types.h"
+#include "bsdl_msg.h"
+#include "bsdl_cache.h"
+
+#define BSDL_CACHE_MAGIC        "UrJBSDLc"
+#define BSDL_CACHE_MAGIC_LEN    8
+#define BSDL_CACHE_VERSION      1
+#define BSDL_CACHE_SUFFIX       ".bsc"
+
+/* upper limit for strings read back from a cache file,
+   protects against corrupted length fields */
+#define BSDL_CACHE_MAX_STRLEN   4096
+
+
+/*****************************************************************************
+ * char *cache_file_name( urj_chain_t *chain, const char *idcode )
+ *
+ * Builds the name of the cache file for an IDCODE. The binary IDCODE string
+ * is converted to hex digits to obtain a short file name.
+ *
+ * Returns
+ *   malloc'ed file name, NULL on error
+ ****************************************************************************/
+static char *
+cache_file_name (urj_chain_t *chain, const char *idcode)
+{
+    const char *dir = chain->bsdl.cache_dir;
+    size_t id_len = strlen (idcode);
+    size_t len;
+    char *name;
+    char *p;
+    size_t idx;
+
+    len = strlen (dir) + 1 + id_len + strlen (BSDL_CACHE_SUFFIX) + 1;
+    name = malloc (len);
+    if (name == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails", len);
+        return NULL;
+    }
+
+    strcpy (name, dir);
+    strcat (name, "/");
+    p = name + strlen (name);
+
+    if (id_len % 4 == 0)
+    {
+        for (idx = 0; idx < id_len; idx += 4)
+        {
+            int nibble = ((idcode[idx] == '1') << 3)
+                | ((idcode[idx + 1] == '1') << 2)
+                | ((idcode[idx + 2] == '1') << 1)
+                | (idcode[idx + 3] == '1');
+
+            *p++ = "0123456789abcdef"[nibble];
+        }
+        *p = '\0';
+    }
+    else
+        strcpy (p, idcode);
+
+    strcat (name, BSDL_CACHE_SUFFIX);
+
+    return name;
+}
+
+
+/* primitive writers and readers, all values are stored little endian */
+
+static int
+put_u32 (FILE *f, uint32_t v)
+{
+    unsigned char b[4];
+
+    b[0] = v & 0xff;
+    b[1] = (v >> 8) & 0xff;
+    b[2] = (v >> 16) & 0xff;
+    b[3] = (v >> 24) & 0xff;
+
+    return fwrite (b, 1, 4, f) == 4 ? URJ_STATUS_OK : URJ_STATUS_FAIL;
+}
+
+static int
+put_u64 (FILE *f, uint64_t v)
+{
+    if (put_u32 (f, v & 0xffffffff) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    return put_u32 (f, v >> 32);
+}
+
+static int
+put_str (FILE *f, const char *s)
+{
+    size_t len = s ? strlen (s) : 0;
+
+    /* a NULL string is marked by an all-ones length field */
+    if (put_u32 (f, s ? len : 0xffffffff) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    if (len > 0 && fwrite (s, 1, len, f) != len)
+        return URJ_STATUS_FAIL;
+
+    return URJ_STATUS_OK;
+}
+
+static int
+get_u32 (FILE *f, uint32_t *v)
+{
+    unsigned char b[4];
+
+    if (fread (b, 1, 4, f) != 4)
+        return URJ_STATUS_FAIL;
+
+    *v = b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t) b[3] << 24);
+
+    return URJ_STATUS_OK;
+}
+
+static int
+get_i32 (FILE *f, int *v)
+{
+    uint32_t u;
+
+    if (get_u32 (f, &u) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    *v = (int32_t) u;
+
+    return URJ_STATUS_OK;
+}
+
+static int
+get_u64 (FILE *f, uint64_t *v)
+{
+    uint32_t lo, hi;
+
+    if (get_u32 (f, &lo) != URJ_STATUS_OK
+        || get_u32 (f, &hi) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    *v = ((uint64_t) hi << 32) | lo;
+
+    return URJ_STATUS_OK;
+}
+
+/* @return malloc'ed string in *s, which is NULL if NULL was stored */
+static int
+get_str (FILE *f, char **s)
+{
+    uint32_t len;
+
+    *s = NULL;
+    if (get_u32 (f, &len) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    if (len == 0xffffffff)
+        return URJ_STATUS_OK;
+    if (len > BSDL_CACHE_MAX_STRLEN)
+        return URJ_STATUS_FAIL;
+
+    *s = malloc (len + 1);
+    if (*s == NULL)
+        return URJ_STATUS_FAIL;
+    if (len > 0 && fread (*s, 1, len, f) != len)
+    {
+        free (*s);
+        *s = NULL;
+        return URJ_STATUS_FAIL;
+    }
+    (*s)[len] = '\0';
+
+    return URJ_STATUS_OK;
+}
+
+
+/*****************************************************************************
+ * int write_part( FILE *f, urj_part_t *part )
+ *
+ * Serializes the BSDL derived contents of a part. Lists are written in
+ * reverse order since the define functions prepend new elements when the
+ * cache is loaded again.
+ ****************************************************************************/
+static int
+write_part (FILE *f, urj_part_t *part)
+{
+    urj_part_signal_t *s;
+    urj_data_register_t *dr;
+    urj_part_instruction_t *in;
+    urj_data_register_t *bsr;
+    void **list;
+    int num, idx, bits;
+
+    if (put_u32 (f, part->instruction_length) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    /* signals */
+    for (num = 0, s = part->signals; s; s = s->next)
+        num++;
+    list = malloc ((num + 1) * sizeof *list);
+    if (list == NULL)
+        return URJ_STATUS_FAIL;
+    for (idx = 0, s = part->signals; s; s = s->next)
+        list[idx++] = s;
+    if (put_u32 (f, num) != URJ_STATUS_OK)
+        goto fail;
+    for (idx = num - 1; idx >= 0; idx--)
+    {
+        s = list[idx];
+        if (put_str (f, s->name) != URJ_STATUS_OK
+            || put_str (f, s->pin) != URJ_STATUS_OK)
+            goto fail;
+    }
+    free (list);
+
+    /* data registers */
+    for (num = 0, dr = part->data_registers; dr; dr = dr->next)
+        num++;
+    list = malloc ((num + 1) * sizeof *list);
+    if (list == NULL)
+        return URJ_STATUS_FAIL;
+    for (idx = 0, dr = part->data_registers; dr; dr = dr->next)
+        list[idx++] = dr;
+    if (put_u32 (f, num) != URJ_STATUS_OK)
+        goto fail;
+    for (idx = num - 1; idx >= 0; idx--)
+    {
+        dr = list[idx];
+        if (put_str (f, dr->name) != URJ_STATUS_OK
+            || put_u32 (f, dr->in->len) != URJ_STATUS_OK)
+            goto fail;
+    }
+    free (list);
+
+    /* instructions */
+    for (num = 0, in = part->instructions; in; in = in->next)
+        num++;
+    list = malloc ((num + 1) * sizeof *list);
+    if (list == NULL)
+        return URJ_STATUS_FAIL;
+    for (idx = 0, in = part->instructions; in; in = in->next)
+        list[idx++] = in;
+    if (put_u32 (f, num) != URJ_STATUS_OK)
+        goto fail;
+    for (idx = num - 1; idx >= 0; idx--)
+    {
+        in = list[idx];
+        if (put_str (f, in->name) != URJ_STATUS_OK
+            || put_str (f, urj_tap_register_get_string (in->value))
+               != URJ_STATUS_OK
+            || put_str (f, in->data_register ? in->data_register->name : NULL)
+               != URJ_STATUS_OK)
+            goto fail;
+    }
+    free (list);
+
+    /* boundary scan cells
+       the raw safe value (including don't care) survives in the BSR only */
+    bsr = urj_part_get_bsr (part);
+    for (bits = 0, idx = 0; idx < part->boundary_length; idx++)
+        if (part->bsbits[idx])
+            bits++;
+    if (put_u32 (f, bits) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    for (idx = 0; idx < part->boundary_length; idx++)
+    {
+        urj_bsbit_t *b = part->bsbits[idx];
+
+        if (b == NULL)
+            continue;
+        if (put_u32 (f, b->bit) != URJ_STATUS_OK
+            || put_str (f, b->name) != URJ_STATUS_OK
+            || put_u32 (f, b->type) != URJ_STATUS_OK
+            || put_u32 (f, bsr ? bsr->in->data[idx] : b->safe)
+               != URJ_STATUS_OK
+            || put_u32 (f, b->control) != URJ_STATUS_OK
+            || put_u32 (f, b->control >= 0 ? b->control_value : -1)
+               != URJ_STATUS_OK
+            || put_u32 (f, b->control >= 0 ? b->control_state : -1)
+               != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+
+ fail:
+    free (list);
+    return URJ_STATUS_FAIL;
+}
+
+
+/*****************************************************************************
+ * int read_part( FILE *f, urj_part_t *part )
+ *
+ * Applies the serialized part description to a freshly allocated part.
+ ****************************************************************************/
+static int
+read_part (FILE *f, urj_part_t *part)
+{
+    uint32_t num, idx;
+    uint32_t u;
+    char *name = NULL, *str1 = NULL, *str2 = NULL;
+
+    if (get_u32 (f, &u) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    if (urj_part_instruction_length_set (part, u) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    /* signals */
+    if (get_u32 (f, &num) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    for (idx = 0; idx < num; idx++)
+    {
+        urj_part_signal_t *s;
+
+        if (get_str (f, &name) != URJ_STATUS_OK || name == NULL
+            || get_str (f, &str1) != URJ_STATUS_OK)
+            goto fail;
+        s = urj_part_signal_alloc (name);
+        if (s == NULL)
+            goto fail;
+        s->pin = str1;
+        str1 = NULL;
+        s->next = part->signals;
+        part->signals = s;
+        free (name);
+        name = NULL;
+    }
+
+    /* data registers */
+    if (get_u32 (f, &num) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    for (idx = 0; idx < num; idx++)
+    {
+        if (get_str (f, &name) != URJ_STATUS_OK || name == NULL
+            || get_u32 (f, &u) != URJ_STATUS_OK)
+            goto fail;
+        if (urj_part_data_register_define (part, name, u) != URJ_STATUS_OK)
+            goto fail;
+        free (name);
+        name = NULL;
+    }
+
+    /* instructions */
+    if (get_u32 (f, &num) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    for (idx = 0; idx < num; idx++)
+    {
+        if (get_str (f, &name) != URJ_STATUS_OK || name == NULL
+            || get_str (f, &str1) != URJ_STATUS_OK || str1 == NULL
+            || get_str (f, &str2) != URJ_STATUS_OK || str2 == NULL)
+            goto fail;
+        if (urj_part_instruction_define (part, name, str1, str2) == NULL)
+            goto fail;
+        free (name);
+        free (str1);
+        free (str2);
+        name = str1 = str2 = NULL;
+    }
+
+    /* boundary scan cells */
+    if (get_u32 (f, &num) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    for (idx = 0; idx < num; idx++)
+    {
+        int bit, type, safe, control, control_value, control_state;
+
+        if (get_i32 (f, &bit) != URJ_STATUS_OK
+            || get_str (f, &name) != URJ_STATUS_OK || name == NULL
+            || get_i32 (f, &type) != URJ_STATUS_OK
+            || get_i32 (f, &safe) != URJ_STATUS_OK
+            || get_i32 (f, &control) != URJ_STATUS_OK
+            || get_i32 (f, &control_value) != URJ_STATUS_OK
+            || get_i32 (f, &control_state) != URJ_STATUS_OK)
+            goto fail;
+        if (bit < 0 || bit >= part->boundary_length)
+            goto fail;
+        if (urj_part_bsbit_alloc_control (part, bit, name, type, safe,
+                                          control, control_value,
+                                          control_state) != URJ_STATUS_OK)
+            goto fail;
+        free (name);
+        name = NULL;
+    }
+
+    return URJ_STATUS_OK;
+
+ fail:
+    free (name);
+    free (str1);
+    free (str2);
+    return URJ_STATUS_FAIL;
+}
+
+
+/*****************************************************************************
+ * int urj_bsdl_cache_load( chain, idcode, proc_mode )
+ *
+ * Looks up the cache entry for idcode and applies it to the active part.
+ * The entry is only used if the BSDL file it was generated from still
+ * exists with unchanged size and modification time.
+ *
+ * Returns
+ *   1 : cache hit, part has been initialized
+ *   0 : no usable cache entry, part is untouched
+ ****************************************************************************/
+int
+urj_bsdl_cache_load (urj_chain_t *chain, const char *idcode, int proc_mode)
+{
+    urj_part_t *part, *tmp;
+    char magic[BSDL_CACHE_MAGIC_LEN];
+    char *name;
+    char *src = NULL;
+    uint32_t version;
+    uint64_t mtime, size;
+    struct stat buf;
+    FILE *f;
+    int result = 0;
+
+    if (chain->bsdl.cache_dir == NULL || idcode == NULL)
+        return 0;
+    if (chain->parts == NULL)
+        return 0;
+    part = chain->parts->parts[chain->active_part];
+
+    /* only a part that hasn't been configured yet can be taken from cache */
+    if (part->signals || part->instructions || part->data_registers)
+        return 0;
+
+    name = cache_file_name (chain, idcode);
+    if (name == NULL)
+        return 0;
+
+    f = fopen (name, FOPEN_R);
+    if (f == NULL)
+    {
+        free (name);
+        return 0;
+    }
+
+    if (fread (magic, 1, BSDL_CACHE_MAGIC_LEN, f) != BSDL_CACHE_MAGIC_LEN
+        || memcmp (magic, BSDL_CACHE_MAGIC, BSDL_CACHE_MAGIC_LEN) != 0
+        || get_u32 (f, &version) != URJ_STATUS_OK
+        || version != BSDL_CACHE_VERSION
+        || get_str (f, &src) != URJ_STATUS_OK || src == NULL
+        || get_u64 (f, &mtime) != URJ_STATUS_OK
+        || get_u64 (f, &size) != URJ_STATUS_OK)
+    {
+        urj_bsdl_warn (proc_mode, _("Ignoring invalid BSDL cache file '%s'\n"),
+                       name);
+        goto out;
+    }
+
+    /* invalidate the entry if the BSDL source has changed */
+    if (stat (src, &buf) != 0
+        || (uint64_t) buf.st_mtime != mtime
+        || (uint64_t) buf.st_size != size)
+    {
+        urj_bsdl_msg (proc_mode, _("BSDL cache entry '%s' is stale\n"), name);
+        goto out;
+    }
+
+    /* load into a scratch part first so that a truncated cache file
+       cannot leave the real part half configured */
+    tmp = urj_part_alloc (part->id);
+    if (tmp == NULL)
+        goto out;
+
+    if (read_part (f, tmp) != URJ_STATUS_OK)
+    {
+        urj_bsdl_warn (proc_mode, _("Ignoring invalid BSDL cache file '%s'\n"),
+                       name);
+        urj_part_free (tmp);
+        goto out;
+    }
+
+    part->signals = tmp->signals;
+    part->instruction_length = tmp->instruction_length;
+    part->instructions = tmp->instructions;
+    part->data_registers = tmp->data_registers;
+    part->boundary_length = tmp->boundary_length;
+    part->bsbits = tmp->bsbits;
+
+    tmp->signals = NULL;
+    tmp->instructions = NULL;
+    tmp->data_registers = NULL;
+    tmp->boundary_length = 0;
+    tmp->bsbits = NULL;
+    urj_part_free (tmp);
+
+    urj_bsdl_msg (proc_mode, _("Using BSDL cache entry '%s'\n"), name);
+    printf (_("  Filename:     %s (cached)\n"), src);
+    result = 1;
+
+ out:
+    fclose (f);
+    free (src);
+    free (name);
+
+    return result;
+}
+
+
+/*****************************************************************************
+ * int urj_bsdl_cache_store( chain, idcode, bsdl_file, proc_mode )
+ *
+ * Writes the current configuration of the active part to the cache entry
+ * for idcode. bsdl_file is the BSDL file the configuration was taken from.
+ * The entry is written to a temporary file first and then renamed, so that
+ * concurrent readers never see a partial entry.
+ *
+ * Returns
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ ****************************************************************************/
+int
+urj_bsdl_cache_store (urj_chain_t *chain, const char *idcode,
+                      const char *bsdl_file, int proc_mode)
+{
+    urj_part_t *part;
+    char *name, *tmp_name;
+    struct stat buf;
+    FILE *f;
+    int result = URJ_STATUS_FAIL;
+
+    if (chain->bsdl.cache_dir == NULL || idcode == NULL)
+        return URJ_STATUS_OK;
+    if (chain->parts == NULL)
+        return URJ_STATUS_FAIL;
+    part = chain->parts->parts[chain->active_part];
+
+    if (stat (bsdl_file, &buf) != 0)
+        return URJ_STATUS_FAIL;
+
+    name = cache_file_name (chain, idcode);
+    if (name == NULL)
+        return URJ_STATUS_FAIL;
+
+    tmp_name = malloc (strlen (name) + 4 + 1);
+    if (tmp_name == NULL)
+    {
+        free (name);
+        return URJ_STATUS_FAIL;
+    }
+    strcpy (tmp_name, name);
+    strcat (tmp_name, ".tmp");
+
+    f = fopen (tmp_name, FOPEN_W);
+    if (f == NULL)
+    {
+        urj_bsdl_warn (proc_mode, _("Cannot write BSDL cache file '%s'\n"),
+                       tmp_name);
+        goto out;
+    }
+
+    if (fwrite (BSDL_CACHE_MAGIC, 1, BSDL_CACHE_MAGIC_LEN, f)
+        == BSDL_CACHE_MAGIC_LEN
+        && put_u32 (f, BSDL_CACHE_VERSION) == URJ_STATUS_OK
+        && put_str (f, bsdl_file) == URJ_STATUS_OK
+        && put_u64 (f, buf.st_mtime) == URJ_STATUS_OK
+        && put_u64 (f, buf.st_size) == URJ_STATUS_OK
+        && write_part (f, part) == URJ_STATUS_OK)
+        result = URJ_STATUS_OK;
+
+    if (fclose (f) != 0)
+        result = URJ_STATUS_FAIL;
+
+    if (result == URJ_STATUS_OK && rename (tmp_name, name) != 0)
+        result = URJ_STATUS_FAIL;
+
+    if (result != URJ_STATUS_OK)
+    {
+        urj_bsdl_warn (proc_mode, _("Cannot write BSDL cache file '%s'\n"),
+                       name);
+        remove (tmp_name);
+    }
+    else
+        urj_bsdl_msg (proc_mode, _("Stored BSDL cache entry '%s'\n"), name);
+
+ out:
+    free (tmp_name);
+    free (name);
+
+    return result;
+}
+
+
+/*
+ Local Variables:
+ mode:C
+ c-default-style:java
+ indent-tabs-mode:nil
+ End:
+*/
@@ -0,0 +1,33 @@
+/*
+ * $Id$
+ *
+ * Copyright (C) 2026, UrJTAG developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#ifndef URJ_BSDL_CACHE_H
+#define URJ_BSDL_CACHE_H
+
+#include <urjtag/types.h>
+
+/* @return 1 if the active part was initialized from the cache, 0 otherwise */
+int urj_bsdl_cache_load (urj_chain_t *, const char *, int);
+/* @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
+int urj_bsdl_cache_store (urj_chain_t *, const char *, const char *, int);
+
+#endif /* URJ_BSDL_CACHE_H */
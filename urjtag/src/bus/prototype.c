@@ -33,6 +33,7 @@
 #include <urjtag/bus.h>
 #include <urjtag/chain.h>
 #include <urjtag/bssignal.h>
+#include <urjtag/bsgroup.h>
 
 #include "buses.h"
 #include "generic_bus.h"
@@ -44,6 +45,8 @@ typedef struct
     urj_part_signal_t *cs;
     urj_part_signal_t *we;
     urj_part_signal_t *oe;
+    urj_part_group_t *agroup;
+    urj_part_group_t *dgroup;
     int alsbi, amsbi, ai, aw, dlsbi, dmsbi, di, dw, csa, wea, oea;
     int ashift;
 } bus_params_t;
@@ -53,6 +56,8 @@ typedef struct
 #define CS      ((bus_params_t *) bus->params)->cs
 #define WE      ((bus_params_t *) bus->params)->we
 #define OE      ((bus_params_t *) bus->params)->oe
+#define AGROUP  ((bus_params_t *) bus->params)->agroup
+#define DGROUP  ((bus_params_t *) bus->params)->dgroup
 
 #define ALSBI   ((bus_params_t *) bus->params)->alsbi
 #define AMSBI   ((bus_params_t *) bus->params)->amsbi
@@ -87,6 +92,18 @@ prototype_bus_signal_parse (const char *str, char *fmt, int *inst)
     // @@@@ RFHH what about failure?
 }
 
+/**
+ * bus->driver->(*free_bus)
+ *
+ */
+static void
+prototype_bus_free (urj_bus_t *bus)
+{
+    urj_part_group_free (AGROUP);
+    urj_part_group_free (DGROUP);
+    urj_bus_generic_free (bus);
+}
+
 /**
  * bus->driver->(*new_bus)
  *
@@ -336,9 +353,25 @@ prototype_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
         failed = 1;
     }
 
+    if (!failed)
+    {
+        urj_part_signal_t *sigs[32];
+
+        /* compile address and data bus into pin groups,
+           bit i of the group value is signal LSB + i */
+        for (i = 0, j = ALSBI; i < AW; i++, j += AI)
+            sigs[i] = A[j];
+        AGROUP = urj_part_group_alloc (bus->part, "A", sigs, AW);
+        for (i = 0, j = DLSBI; i < DW; i++, j += DI)
+            sigs[i] = D[j];
+        DGROUP = urj_part_group_alloc (bus->part, "D", sigs, DW);
+        if (!AGROUP || !DGROUP)
+            failed = 1;
+    }
+
     if (failed)
     {
-        urj_bus_generic_free (bus);
+        prototype_bus_free (bus);
         return NULL;
     }
 
@@ -380,39 +413,29 @@ prototype_bus_area (urj_bus_t *bus, uint32_t adr, urj_bus_area_t *area)
 static void
 setup_address (urj_bus_t *bus, uint32_t a)
 {
-    int i, j;
-    urj_part_t *p = bus->part;
-
-    a >>= ASHIFT;
-
-    for (i = 0, j = ALSBI; i < AW; i++, j += AI)
-        urj_part_set_signal (p, A[j], 1, (a >> i) & 1);
+    urj_part_group_set_value (bus->part, AGROUP, a >> ASHIFT);
 }
 
 static void
 set_data_in (urj_bus_t *bus)
 {
-    int i, j;
-    urj_part_t *p = bus->part;
-    urj_bus_area_t area;
-
-    prototype_bus_area (bus, 0, &area);
-
-    for (i = 0, j = DLSBI; i < DW; i++, j += DI)
-        urj_part_set_signal_input (p, D[j]);
+    urj_part_group_set_input (bus->part, DGROUP);
 }
 
 static void
 setup_data (urj_bus_t *bus, uint32_t d)
 {
-    int i, j;
-    urj_part_t *p = bus->part;
-    urj_bus_area_t area;
+    urj_part_group_set_value (bus->part, DGROUP, d);
+}
+
+static uint32_t
+get_data (urj_bus_t *bus)
+{
+    uint64_t d = 0;
 
-    prototype_bus_area (bus, 0, &area);
+    urj_part_group_get (bus->part, DGROUP, &d);
 
-    for (i = 0, j = DLSBI; i < DW; i++, j += DI)
-        urj_part_set_signal (p, D[j], 1, (d >> i) & 1);
+    return d;
 }
 
 /**
@@ -444,21 +467,12 @@ prototype_bus_read_start (urj_bus_t *bus, uint32_t adr)
 static uint32_t
 prototype_bus_read_next (urj_bus_t *bus, uint32_t adr)
 {
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
-    int i, j;
-    uint32_t d = 0;
-    urj_bus_area_t area;
-
-    prototype_bus_area (bus, adr, &area);
 
     setup_address (bus, adr);
     urj_tap_chain_shift_data_registers (chain, 1);
 
-    for (i = 0, j = DLSBI; i < DW; i++, j += DI)
-        d |= (uint32_t) (urj_part_get_signal (p, D[j]) << i);
-
-    return d;
+    return get_data (bus);
 }
 
 /**
@@ -470,20 +484,12 @@ prototype_bus_read_end (urj_bus_t *bus)
 {
     urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
-    int i, j;
-    uint32_t d = 0;
-    urj_bus_area_t area;
-
-    prototype_bus_area (bus, 0, &area);
 
     urj_part_set_signal (p, CS, 1, CSA ? 0 : 1);
     urj_part_set_signal (p, OE, 1, OEA ? 0 : 1);
     urj_tap_chain_shift_data_registers (chain, 1);
 
-    for (i = 0, j = DLSBI; i < DW; i++, j += DI)
-        d |= (uint32_t) (urj_part_get_signal (p, D[j]) << i);
-
-    return d;
+    return get_data (bus);
 }
 
 /**
@@ -518,7 +524,7 @@ const urj_bus_driver_t urj_bus_prototype_bus = {
        "           amsb=<addr MSB> alsb=<addr LSB> dmsb=<data MSB> dlsb=<data LSB>\n"
        "           ncs=<CS#>|cs=<CS> noe=<OE#>|oe=<OE> nwe=<WE#>|we=<WE> [amode=auto|x8|x16|x32]"),
     prototype_bus_new,
-    urj_bus_generic_free,
+    prototype_bus_free,
     prototype_bus_printinfo,
     urj_bus_generic_prepare_extest,
     prototype_bus_area,
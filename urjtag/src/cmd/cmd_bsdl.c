@@ -91,6 +91,17 @@ cmd_bsdl_run (urj_chain_t *chain, char *params[])
             result = 1;
         }
 
+        if (strcmp (params[1], "cache") == 0)
+        {
+            if (strcmp (params[2], "off") == 0)
+                result = urj_bsdl_set_cache (chain, NULL);
+            else
+                result = urj_bsdl_set_cache (chain, params[2]);
+            if (result != URJ_STATUS_OK)
+                return URJ_STATUS_FAIL;
+            result = 1;
+        }
+
         if (strcmp (params[1], "debug") == 0)
         {
             if (strcmp (params[2], "on") == 0)
@@ -123,6 +134,7 @@ cmd_bsdl_complete (urj_chain_t *chain, char ***matches, size_t *match_cnt,
 {
     static const char * const main_cmds[] = {
         "path",
+        "cache",
         "test",
         "dump",
         "debug",
@@ -141,7 +153,7 @@ cmd_bsdl_complete (urj_chain_t *chain, char ***matches, size_t *match_cnt,
 
     case 2:
         /* XXX: For "test" and "dump", we'll want to search the bsdl paths */
-        if (!strcmp (tokens[1], "path"))
+        if (!strcmp (tokens[1], "path") || !strcmp (tokens[1], "cache"))
             urj_completion_mayben_add_file (matches, match_cnt, text,
                                             text_len, false);
         else if (!strcmp (tokens[1], "debug"))
@@ -156,14 +168,16 @@ cmd_bsdl_help (void)
 {
     urj_log (URJ_LOG_LEVEL_NORMAL,
              _("Usage: %s path PATHLIST\n"
+               "Usage: %s cache DIR|off\n"
                "Usage: %s test [FILE]\n"
                "Usage: %s dump [FILE]\n"
                "Usage: %s debug on|off\n"
                "Manage BSDL files\n"
                "\n"
                "PATHLIST semicolon separated list of directory paths to search for BSDL files\n"
+               "DIR directory to cache parts matched during 'detect'\n"
                "FILE file containing part description in BSDL format\n"),
-            "bsdl", "bsdl", "bsdl", "bsdl");
+            "bsdl", "bsdl", "bsdl", "bsdl", "bsdl");
 }
 
 const urj_cmd_t urj_cmd_bsdl = {
@@ -0,0 +1,252 @@
+/*
+ * $Id$
+ *
+ * Copyright (C) 2026, UrJTAG developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <urjtag/error.h>
+#include <urjtag/part.h>
+#include <urjtag/chain.h>
+#include <urjtag/bssignal.h>
+#include <urjtag/bsgroup.h>
+
+#include <urjtag/cmd.h>
+
+#include "cmd.h"
+
+/* like urj_cmd_get_number(), but 64 bits wide also where long is not */
+static int
+cmd_group_get_value (const char *s, uint64_t *value)
+{
+    int n;
+    size_t l = strlen (s);
+
+    n = -1;
+    if (sscanf (s, "0x%" SCNx64 "%n", value, &n) == 1 && n == l)
+        return URJ_STATUS_OK;
+
+    n = -1;
+    if (sscanf (s, "%" SCNu64 "%n", value, &n) == 1 && n == l)
+        return URJ_STATUS_OK;
+
+    urj_error_set (URJ_ERROR_SYNTAX, "not a number: '%s'", s);
+
+    return URJ_STATUS_FAIL;
+}
+
+static int
+cmd_group_run (urj_chain_t *chain, char *params[])
+{
+    int num_params = urj_cmd_params (params);
+    urj_part_group_t *g;
+    urj_part_t *part;
+
+    if (num_params < 2)
+    {
+        urj_error_set (URJ_ERROR_SYNTAX,
+                       "%s: #parameters should be >= %d, not %d",
+                       params[0], 2, num_params);
+        return URJ_STATUS_FAIL;
+    }
+
+    if (urj_cmd_test_cable (chain) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    part = urj_tap_chain_active_part (chain);
+    if (part == NULL)
+        return URJ_STATUS_FAIL;
+
+    if (strcasecmp (params[1], "list") == 0)
+    {
+        for (g = part->groups; g; g = g->next)
+        {
+            int i;
+
+            urj_log (URJ_LOG_LEVEL_NORMAL, "%s", g->name);
+            for (i = g->width - 1; i >= 0; i--)
+                urj_log (URJ_LOG_LEVEL_NORMAL, " %s", g->signals[i]->name);
+            urj_log (URJ_LOG_LEVEL_NORMAL, "\n");
+        }
+        return URJ_STATUS_OK;
+    }
+
+    if (num_params < 3)
+    {
+        urj_error_set (URJ_ERROR_SYNTAX,
+                       "%s: #parameters should be >= %d, not %d",
+                       params[0], 3, num_params);
+        return URJ_STATUS_FAIL;
+    }
+
+    if (strcasecmp (params[1], "define") == 0)
+    {
+        const char *names[URJ_PART_GROUP_MAXWIDTH];
+        int width = num_params - 3;
+        int i;
+
+        if (width < 1 || width > URJ_PART_GROUP_MAXWIDTH)
+        {
+            urj_error_set (URJ_ERROR_SYNTAX,
+                           "%s: group needs 1..%d signals, not %d",
+                           params[0], URJ_PART_GROUP_MAXWIDTH, width);
+            return URJ_STATUS_FAIL;
+        }
+
+        /* signals are given MSB first, bit 0 of the group is the last one */
+        for (i = 0; i < width; i++)
+            names[i] = params[num_params - 1 - i];
+
+        return urj_part_group_define (part, params[2], names, width) == NULL
+            ? URJ_STATUS_FAIL : URJ_STATUS_OK;
+    }
+
+    g = urj_part_find_group (part, params[2]);
+    if (g == NULL)
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND, _("group '%s' not found"),
+                       params[2]);
+        return URJ_STATUS_FAIL;
+    }
+
+    if (strcasecmp (params[1], "set") == 0)
+    {
+        uint64_t data = 0;
+
+        if (num_params == 4 && strcasecmp (params[3], "in") == 0)
+            return urj_part_group_set_input (part, g);
+
+        if (num_params != 5 || strcasecmp (params[3], "out") != 0)
+        {
+            urj_error_set (URJ_ERROR_SYNTAX,
+                           "%s: expected 'set GROUP in' or 'set GROUP out DATA'",
+                           params[0]);
+            return URJ_STATUS_FAIL;
+        }
+
+        if (cmd_group_get_value (params[4], &data) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+        return urj_part_group_set_value (part, g, data);
+    }
+
+    if (strcasecmp (params[1], "get") == 0)
+    {
+        uint64_t data;
+
+        if (num_params != 3)
+        {
+            urj_error_set (URJ_ERROR_SYNTAX,
+                           "%s: #parameters should be %d, not %d",
+                           params[0], 3, num_params);
+            return URJ_STATUS_FAIL;
+        }
+
+        if (urj_part_group_get (part, g, &data) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+        urj_log (URJ_LOG_LEVEL_NORMAL, "%s = 0x%0*" PRIX64 "\n", g->name,
+                 (g->width + 3) / 4, data);
+
+        return URJ_STATUS_OK;
+    }
+
+    urj_error_set (URJ_ERROR_SYNTAX, "%s: unknown subcommand '%s'",
+                   params[0], params[1]);
+    return URJ_STATUS_FAIL;
+}
+
+static void
+cmd_group_help (void)
+{
+    urj_log (URJ_LOG_LEVEL_NORMAL,
+             _("Usage: %s define GROUP SIGNAL...\n"
+               "Usage: %s set GROUP in\n"
+               "Usage: %s set GROUP out DATA\n"
+               "Usage: %s get GROUP\n"
+               "Usage: %s list\n"
+               "Access a group of signals as one value in the BSR (Boundary Scan Register).\n"
+               "\n"
+               "GROUP         group name\n"
+               "SIGNAL        signal names, most significant bit first (max. %d)\n"
+               "DATA          value to drive onto the signals\n"),
+             "group", "group", "group", "group", "group",
+             URJ_PART_GROUP_MAXWIDTH);
+}
+
+static void
+cmd_group_complete (urj_chain_t *chain, char ***matches, size_t *match_cnt,
+                    char * const *tokens, const char *text, size_t text_len,
+                    size_t token_point)
+{
+    static const char * const main_cmds[] = {
+        "define", "set", "get", "list",
+    };
+    static const char * const dir[] = {
+        "in", "out",
+    };
+    urj_part_t *part;
+    urj_part_group_t *g;
+
+    switch (token_point)
+    {
+    case 1:
+        urj_completion_mayben_add_matches (matches, match_cnt, text, text_len,
+                                           main_cmds);
+        break;
+
+    case 2:  /* group name */
+        if (!strcmp (tokens[1], "set") || !strcmp (tokens[1], "get"))
+        {
+            part = urj_tap_chain_active_part (chain);
+            if (part == NULL)
+                return;
+            for (g = part->groups; g; g = g->next)
+                urj_completion_mayben_add_match (matches, match_cnt, text,
+                                                 text_len, g->name);
+        }
+        break;
+
+    case 3:
+        if (!strcmp (tokens[1], "set"))
+            urj_completion_mayben_add_matches (matches, match_cnt, text,
+                                               text_len, dir);
+        else if (!strcmp (tokens[1], "define"))
+            cmd_signal_complete (chain, matches, match_cnt, text, text_len);
+        break;
+
+    default:
+        if (!strcmp (tokens[1], "define"))
+            cmd_signal_complete (chain, matches, match_cnt, text, text_len);
+        break;
+    }
+}
+
+const urj_cmd_t urj_cmd_group = {
+    "group",
+    N_("access a group of signals as one value"),
+    cmd_group_help,
+    cmd_group_run,
+    cmd_group_complete,
+};
@@ -54,6 +54,8 @@ cmd_instruction_run (urj_chain_t *chain, char *params[])
     switch (urj_cmd_params (params))
     {
     case 2:
+        /* an explicit instruction command always leads to a real IR scan */
+        urj_tap_chain_invalidate_ir (chain);
         urj_part_set_instruction (part, params[1]);
         if (part->active_instruction == NULL)
         {
@@ -39,6 +39,7 @@
 #endif
 #ifndef ENABLE_SVF
 #define URJ_CMD_SKIP_svf
+#define URJ_CMD_SKIP_xsvf
 #endif
 
 #include "generated_cmd_list.h"
@@ -64,7 +64,7 @@ cmd_scan_run (urj_chain_t *chain, char *params[])
         return URJ_STATUS_FAIL;
 
     /* search for Boundary Scan Register */
-    bsr = urj_part_find_data_register (part, "BSR");
+    bsr = urj_part_get_bsr (part);
     if (!bsr)
     {
         urj_error_set (URJ_ERROR_NOTFOUND,
@@ -51,6 +51,7 @@ cmd_shift_run (urj_chain_t *chain, char *params[])
     if (strcasecmp (params[1], "ir") == 0)
     {
         /* @@@@ RFHH check result */
+        urj_tap_chain_invalidate_ir (chain);
         urj_tap_chain_shift_instructions (chain);
         return URJ_STATUS_OK;
     }
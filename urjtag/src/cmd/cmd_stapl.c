@@ -22,6 +22,11 @@
  *
  */
 
+#include <sysdep.h>
+
+#include <stdio.h>
+#include <string.h>
+
 #include <urjtag/error.h>
 #include <urjtag/parse.h>
 #include <urjtag/jtag.h>
@@ -34,7 +39,9 @@
 static int
 cmd_stapl_run (urj_chain_t *chain, char *params[])
 {
-    int num_params;
+    FILE *PROFILE_FILE = NULL;
+    int num_params, i;
+    const char *profile = NULL;
     int result = URJ_STATUS_OK;
 
     num_params = urj_cmd_params (params);
@@ -46,7 +53,29 @@ cmd_stapl_run (urj_chain_t *chain, char *params[])
         return URJ_STATUS_FAIL;
     }
 
-    result = urj_stapl_run (chain, params[1], params[2]);
+    for (i = 3; i < num_params; i++)
+    {
+        if (strncasecmp (params[i], "profile=", 8) == 0)
+            profile = params[i] + 8;
+        else
+        {
+            urj_error_set (URJ_ERROR_SYNTAX, "%s: unknown command '%s'",
+                           params[0], params[i]);
+            return URJ_STATUS_FAIL;
+        }
+    }
+
+    if (profile != NULL && (PROFILE_FILE = fopen (profile, FOPEN_W)) == NULL)
+    {
+        urj_error_IO_set ("%s: cannot open file '%s'", params[0], profile);
+        return URJ_STATUS_FAIL;
+    }
+
+    result = urj_stapl_run_profile (chain, params[1], params[2],
+                                    PROFILE_FILE);
+
+    if (PROFILE_FILE != NULL)
+        fclose (PROFILE_FILE);
 
     return result;
 }
@@ -55,10 +84,13 @@ static void
 cmd_stapl_help (void)
 {
     urj_log (URJ_LOG_LEVEL_NORMAL,
-             _("Usage: %s FILE -aACTION\n"
+             _("Usage: %s FILE -aACTION [profile=<file>]\n"
                "Execute stapl commands from FILE.\n"
                "ACTION     : Name of stapl action"
                "to be executed from the FILE.\n"
+               "profile    : Write calls, time and scanned bits per procedure\n"
+               "             and per line to <file> as JSON records, one per line,\n"
+               "             sorted by time\n"
                "\n" "FILE file containing stapl code\n"),
              "stapl");
 }
@@ -68,7 +100,12 @@ cmd_stapl_complete (urj_chain_t *chain, char ***matches, size_t *match_cnt,
                     char * const *tokens, const char *text, size_t text_len,
                     size_t token_point)
 {
-    urj_completion_mayben_add_file (matches, match_cnt, text, text_len, true);
+    if (token_point < 3)
+        urj_completion_mayben_add_file (matches, match_cnt, text, text_len,
+                                        true);
+    else
+        urj_completion_mayben_add_match (matches, match_cnt, text, text_len,
+                                         "profile=");
 }
 
 const urj_cmd_t urj_cmd_stapl = {
@@ -33,20 +33,79 @@
 
 #include <urjtag/error.h>
 #include <urjtag/log.h>
+#include <urjtag/chain.h>
+#include <urjtag/cable.h>
 
 #include <urjtag/svf.h>
 #include <urjtag/cmd.h>
 
 #include "cmd.h"
 
+static int
+cmd_svf_compile (urj_chain_t *chain, char *params[], int num_params)
+{
+    FILE *SVF_FILE, *BIN_FILE;
+    uint32_t ref_freq = 0;
+    int result;
+
+    if (num_params < 4 || num_params > 5)
+    {
+        urj_error_set (URJ_ERROR_SYNTAX,
+                       "%s: #parameters should be %d or %d, not %d",
+                       params[0], 4, 5, num_params);
+        return URJ_STATUS_FAIL;
+    }
+
+    if (num_params == 5)
+    {
+        if (strncasecmp (params[4], "ref_freq=", 9) != 0)
+        {
+            urj_error_set (URJ_ERROR_SYNTAX, "%s: unknown command '%s'",
+                           params[0], params[4]);
+            return URJ_STATUS_FAIL;
+        }
+        ref_freq = strtol (params[4] + 9, NULL, 10);
+    }
+
+    if (urj_cmd_test_cable (chain) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    if ((SVF_FILE = fopen (params[2], FOPEN_R)) == NULL)
+    {
+        urj_error_IO_set ("%s: cannot open file '%s'", params[0], params[2]);
+        return URJ_STATUS_FAIL;
+    }
+    if ((BIN_FILE = fopen (params[3], FOPEN_W)) == NULL)
+    {
+        urj_error_IO_set ("%s: cannot open file '%s'", params[0], params[3]);
+        fclose (SVF_FILE);
+        return URJ_STATUS_FAIL;
+    }
+
+    result = urj_svf_compile (chain, SVF_FILE, BIN_FILE, ref_freq);
+
+    fclose (SVF_FILE);
+    if (fclose (BIN_FILE) != 0 && result == URJ_STATUS_OK)
+    {
+        urj_error_IO_set ("%s: cannot write file '%s'", params[0], params[3]);
+        result = URJ_STATUS_FAIL;
+    }
+
+    return result;
+}
+
 static int
 cmd_svf_run (urj_chain_t *chain, char *params[])
 {
-    FILE *SVF_FILE;
+    FILE *SVF_FILE, *PROFILE_FILE = NULL;
     int num_params, i;
     int stop = 0;
     int print_progress = 0;
+    int dry_run = 0;
+    int force = 0;
     uint32_t ref_freq = 0;
+    double latency = 0.0;
+    const char *profile = NULL;
     urj_log_level_t old_log_level = urj_log_state.level;
     int result = URJ_STATUS_OK;
 
@@ -59,14 +118,25 @@ cmd_svf_run (urj_chain_t *chain, char *params[])
         return URJ_STATUS_FAIL;
     }
 
+    if (strcasecmp (params[1], "compile") == 0)
+        return cmd_svf_compile (chain, params, num_params);
+
     for (i = 2; i < num_params; i++)
     {
         if (strcasecmp (params[i], "stop") == 0)
             stop = 1;
         else if (strcasecmp (params[i], "progress") == 0)
             print_progress = 1;
+        else if (strcasecmp (params[i], "dry_run") == 0)
+            dry_run = 1;
+        else if (strcasecmp (params[i], "force") == 0)
+            force = 1;
+        else if (strncasecmp (params[i], "latency=", 8) == 0)
+            latency = strtod (params[i] + 8, NULL) / 1e6;
         else if (strncasecmp (params[i], "ref_freq=", 9) == 0)
             ref_freq = strtol (params[i] + 9, NULL, 10);
+        else if (strncasecmp (params[i], "profile=", 8) == 0)
+            profile = params[i] + 8;
         else
         {
             urj_error_set (URJ_ERROR_SYNTAX, "%s: unknown command '%s'",
@@ -75,12 +145,39 @@ cmd_svf_run (urj_chain_t *chain, char *params[])
         }
     }
 
+    /* without TDO checks a dry run on real hardware would program the
+       target unverified */
+    if (dry_run)
+    {
+        if (urj_cmd_test_cable (chain) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+        if (!force && strcasecmp (chain->cable->driver->name, "jim") != 0)
+        {
+            urj_error_set (URJ_ERROR_ILLEGAL_STATE,
+                           "%s: dry_run needs the jim cable, add 'force' to run it on cable '%s'",
+                           params[0], chain->cable->driver->name);
+            return URJ_STATUS_FAIL;
+        }
+    }
+
+    if (profile != NULL && (PROFILE_FILE = fopen (profile, FOPEN_W)) == NULL)
+    {
+        urj_error_IO_set ("%s: cannot open file '%s'", params[0], profile);
+        return URJ_STATUS_FAIL;
+    }
+
     if (print_progress)
         urj_log_state.level = URJ_LOG_LEVEL_DETAIL;
 
     if ((SVF_FILE = fopen (params[1], FOPEN_R)) != NULL)
     {
-        result = urj_svf_run (chain, SVF_FILE, stop, ref_freq);
+        if (dry_run)
+            result = urj_svf_dry_run (chain, SVF_FILE, ref_freq, latency,
+                                      PROFILE_FILE);
+        else
+            result = urj_svf_run_profile (chain, SVF_FILE, stop, ref_freq,
+                                          PROFILE_FILE);
 
         fclose (SVF_FILE);
     }
@@ -90,6 +187,9 @@ cmd_svf_run (urj_chain_t *chain, char *params[])
         result = URJ_STATUS_FAIL;
     }
 
+    if (PROFILE_FILE != NULL)
+        fclose (PROFILE_FILE);
+
     urj_log_state.level = old_log_level;
 
     return result;
@@ -104,15 +204,31 @@ cmd_svf_complete (urj_chain_t *chain, char ***matches, size_t *match_cnt,
         "stop",
         "progress",
         "ref_freq=",
+        "profile=",
+        "dry_run",
+        "latency=",
+        "force",
     };
 
     switch (token_point)
     {
     case 1:
+        urj_completion_mayben_add_match (matches, match_cnt, text, text_len,
+                                         "compile");
         urj_completion_mayben_add_file (matches, match_cnt, text,
                                         text_len, false);
         break;
 
+    case 2:
+    case 3:
+        if (!strcasecmp (tokens[1], "compile"))
+        {
+            urj_completion_mayben_add_file (matches, match_cnt, text,
+                                            text_len, false);
+            break;
+        }
+        /* fall through */
+
     default:
         urj_completion_mayben_add_matches (matches, match_cnt, text, text_len,
                                            main_cmds);
@@ -125,12 +241,23 @@ cmd_svf_help (void)
 {
     urj_log (URJ_LOG_LEVEL_NORMAL,
              _("Usage: %s FILE [stop] [progress] [ref_freq=<frequency>]\n"
+               "                [profile=<file>] [dry_run [latency=<us>] [force]]\n"
+               "Usage: %s compile FILE OUTFILE [ref_freq=<frequency>]\n"
                "Execute svf commands from FILE.\n"
                "stop     : Command execution stops upon TDO mismatch.\n"
                "progress : Continually displays progress status.\n"
                "ref_freq : Use <frequency> as the reference for 'RUNTEST xxx SEC' commands\n"
+               "profile  : Write progress and a time and throughput report per command\n"
+               "           type to <file> as JSON records, one per line\n"
+               "dry_run  : Execute without verifying TDO on the jim cable and report\n"
+               "           TCK cycles, round trips and the time a cable running at\n"
+               "           ref_freq with <us> microseconds latency per round trip needs\n"
+               "force    : Allow dry_run on other cables, which then shift all data into\n"
+               "           the target, e.g. program it, without checking TDO\n"
+               "compile  : Translate FILE into binary vectors in OUTFILE, which can be\n"
+               "           executed with 'svf OUTFILE' for the same chain.\n"
                "\n" "FILE file containing SVF commands\n"),
-             "svf");
+             "svf", "svf");
 }
 
 const urj_cmd_t urj_cmd_svf = {
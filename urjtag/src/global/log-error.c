@@ -203,6 +203,8 @@ urj_error_string (urj_error_t err)
     case URJ_ERROR_UNIMPLEMENTED:       return "unimplemented";
 
     case URJ_ERROR_FIRMWARE:            return "firmware";
+
+    case URJ_ERROR_STAPL:               return "stapl player";
     }
 
     return "UNDEFINED ERROR";
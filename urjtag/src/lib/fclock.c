@@ -161,3 +161,26 @@ urj_lib_frealtime (void)
 #endif
 #endif
 #endif
+
+/* ------------------------------------------------------------------ */
+
+long double
+urj_lib_fmonotime (void)
+{
+#if defined _POSIX_TIMERS && defined CLOCK_MONOTONIC && !defined __APPLE__
+    long double result;
+
+    struct timespec t;
+    if (clock_gettime (CLOCK_MONOTONIC, &t) == -1)
+    {
+        perror ("urj_lib_fmonotime (clock_gettime)");
+        exit (EXIT_FAILURE);
+    }
+    result =
+        (long double) t.tv_sec + (long double) t.tv_nsec * (long double) 1e-9;
+
+    return result;
+#else
+    return urj_lib_frealtime ();
+#endif
+}
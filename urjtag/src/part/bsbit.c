@@ -43,7 +43,7 @@ urj_part_bsbit_alloc_control (urj_part_t *part, int bit, const char *name,
     urj_data_register_t *bsr;
     urj_part_signal_t *signal;
 
-    bsr = urj_part_find_data_register (part, "BSR");
+    bsr = urj_part_get_bsr (part);
     if (bsr == NULL)
     {
         urj_error_set(URJ_ERROR_NOTFOUND,
@@ -0,0 +1,305 @@
+/*
+ * $Id$
+ *
+ * Copyright (C) 2026, UrJTAG developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <urjtag/error.h>
+#include <urjtag/part.h>
+#include <urjtag/data_register.h>
+#include <urjtag/tap_register.h>
+#include <urjtag/bssignal.h>
+#include <urjtag/bsbit.h>
+#include <urjtag/bsgroup.h>
+
+urj_part_group_t *
+urj_part_group_alloc (urj_part_t *part, const char *name,
+                      urj_part_signal_t * const *signals, int width)
+{
+    urj_part_group_t *g;
+    int i;
+
+    if (!part || !name || !signals)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "NULL part, name or signals");
+        return NULL;
+    }
+
+    if (width < 1 || width > URJ_PART_GROUP_MAXWIDTH)
+    {
+        urj_error_set (URJ_ERROR_INVALID,
+                       _("group width must be 1..%d, not %d"),
+                       URJ_PART_GROUP_MAXWIDTH, width);
+        return NULL;
+    }
+
+    if (!urj_part_get_bsr (part))
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND,
+                       _("Boundary Scan Register (BSR) not found"));
+        return NULL;
+    }
+
+    g = calloc (1, sizeof *g);
+    if (!g)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd,%zd) fails",
+                       (size_t) 1, sizeof *g);
+        return NULL;
+    }
+
+    g->name = strdup (name);
+    g->signals = malloc (width * sizeof *g->signals);
+    g->output = malloc (width * sizeof *g->output);
+    g->control = malloc (width * sizeof *g->control);
+    g->enable = malloc (width * sizeof *g->enable);
+    g->input = malloc (width * sizeof *g->input);
+    if (!g->name || !g->signals || !g->output || !g->control || !g->enable
+        || !g->input)
+    {
+        urj_part_group_free (g);
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc fails");
+        return NULL;
+    }
+
+    g->width = width;
+    g->no_output = -1;
+    g->no_input = -1;
+
+    for (i = 0; i < width; i++)
+    {
+        urj_part_signal_t *s = signals[i];
+
+        if (!s)
+        {
+            urj_part_group_free (g);
+            urj_error_set (URJ_ERROR_INVALID, "NULL signal in group '%s'",
+                           name);
+            return NULL;
+        }
+
+        g->signals[i] = s;
+
+        if (s->output)
+        {
+            urj_bsbit_t *b = part->bsbits[s->output->bit];
+
+            g->output[i] = s->output->bit;
+            g->control[i] = b->control;
+            g->enable[i] = b->control >= 0 ? b->control_value ^ 1 : 0;
+        }
+        else
+        {
+            g->output[i] = -1;
+            g->control[i] = -1;
+            g->enable[i] = 0;
+            if (g->no_output < 0)
+                g->no_output = i;
+        }
+
+        if (s->input)
+            g->input[i] = s->input->bit;
+        else
+        {
+            g->input[i] = -1;
+            if (g->no_input < 0)
+                g->no_input = i;
+        }
+    }
+
+    return g;
+}
+
+void
+urj_part_group_free (urj_part_group_t *g)
+{
+    if (!g)
+        return;
+
+    free (g->name);
+    free (g->signals);
+    free (g->output);
+    free (g->control);
+    free (g->enable);
+    free (g->input);
+    free (g);
+}
+
+urj_part_group_t *
+urj_part_group_define (urj_part_t *part, const char *name,
+                       const char * const *signal_names, int width)
+{
+    urj_part_signal_t *signals[URJ_PART_GROUP_MAXWIDTH];
+    urj_part_group_t *g;
+
+    if (!part || !name || !signal_names)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "NULL part, name or signal names");
+        return NULL;
+    }
+
+    if (urj_part_find_group (part, name) != NULL)
+    {
+        urj_error_set (URJ_ERROR_ALREADY,
+                       _("Group '%s' already defined"), name);
+        return NULL;
+    }
+
+    if (width < 1 || width > URJ_PART_GROUP_MAXWIDTH)
+    {
+        urj_error_set (URJ_ERROR_INVALID,
+                       _("group width must be 1..%d, not %d"),
+                       URJ_PART_GROUP_MAXWIDTH, width);
+        return NULL;
+    }
+
+    if (urj_part_find_signals (part, signal_names, signals, width)
+        != URJ_STATUS_OK)
+        return NULL;
+
+    g = urj_part_group_alloc (part, name, signals, width);
+    if (!g)
+        return NULL;
+
+    g->next = part->groups;
+    part->groups = g;
+
+    return g;
+}
+
+urj_part_group_t *
+urj_part_find_group (urj_part_t *part, const char *name)
+{
+    urj_part_group_t *g;
+
+    if (!part || !name)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "NULL part or group name");
+        return NULL;
+    }
+
+    for (g = part->groups; g; g = g->next)
+        if (strcasecmp (name, g->name) == 0)
+            break;
+
+    return g;
+}
+
+int
+urj_part_group_set (urj_part_t *part, const urj_part_group_t *g, int out,
+                    uint64_t value)
+{
+    urj_data_register_t *bsr;
+    char *data;
+    int i;
+
+    if (!part || !g)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "NULL part or group");
+        return URJ_STATUS_FAIL;
+    }
+
+    bsr = urj_part_get_bsr (part);
+    if (!bsr)
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND,
+                       _("Boundary Scan Register (BSR) not found"));
+        return URJ_STATUS_FAIL;
+    }
+    data = bsr->in->data;
+
+    if (out)
+    {
+        if (g->no_output >= 0)
+        {
+            urj_error_set (URJ_ERROR_INVALID,
+                           _("signal '%s' cannot be set as output"),
+                           g->signals[g->no_output]->name);
+            return URJ_STATUS_FAIL;
+        }
+
+        for (i = 0; i < g->width; i++)
+        {
+            data[g->output[i]] = (value >> i) & 1;
+            if (g->control[i] >= 0)
+                data[g->control[i]] = g->enable[i];
+        }
+    }
+    else
+    {
+        if (g->no_input >= 0)
+        {
+            urj_error_set (URJ_ERROR_INVALID,
+                           _("signal '%s' cannot be set as input"),
+                           g->signals[g->no_input]->name);
+            return URJ_STATUS_FAIL;
+        }
+
+        for (i = 0; i < g->width; i++)
+            if (g->control[i] >= 0)
+                data[g->control[i]] = g->enable[i] ^ 1;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_part_group_get (urj_part_t *part, const urj_part_group_t *g,
+                    uint64_t *value)
+{
+    urj_data_register_t *bsr;
+    const char *data;
+    uint64_t v = 0;
+    int i;
+
+    if (!part || !g || !value)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "NULL part, group or value");
+        return URJ_STATUS_FAIL;
+    }
+
+    bsr = urj_part_get_bsr (part);
+    if (!bsr)
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND,
+                       _("Boundary Scan Register (BSR) not found"));
+        return URJ_STATUS_FAIL;
+    }
+
+    if (g->no_input >= 0)
+    {
+        urj_error_set (URJ_ERROR_INVALID,
+                       _("signal '%s' is not input signal"),
+                       g->signals[g->no_input]->name);
+        return URJ_STATUS_FAIL;
+    }
+
+    data = bsr->out->data;
+    for (i = 0; i < g->width; i++)
+        v |= (uint64_t) (data[g->input[i]] & 1) << i;
+
+    *value = v;
+
+    return URJ_STATUS_OK;
+}
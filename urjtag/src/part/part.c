@@ -26,6 +26,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 #include <urjtag/error.h>
 #include <urjtag/part.h>
@@ -34,9 +35,243 @@
 #include <urjtag/part_instruction.h>
 #include <urjtag/data_register.h>
 #include <urjtag/bsbit.h>
+#include <urjtag/bsgroup.h>
 
 urj_part_init_t *urj_part_inits = NULL;
 
+/* name index
+ *
+ * Every part keeps a case-insensitive open addressing hash for its signals,
+ * signal aliases, instructions and data registers. The lists themselves
+ * remain the primary storage and new elements are always prepended to them,
+ * partly by code outside of this file. Each index therefore remembers the
+ * list head it has seen last and picks up new elements on the next lookup. */
+
+#define PART_HASH_MIN_SIZE      16
+
+typedef enum
+{
+    PART_HASH_SIGNAL,
+    PART_HASH_SALIAS,
+    PART_HASH_INSTRUCTION,
+    PART_HASH_DATA_REGISTER,
+}
+part_hash_kind_t;
+
+struct URJ_PART_HASH
+{
+    part_hash_kind_t kind;
+    const void *head;           /* list head at last synchronization */
+    unsigned int size;          /* number of slots, power of 2 */
+    unsigned int count;         /* used slots */
+    void **slots;
+};
+
+static const char *
+part_hash_elem_name (part_hash_kind_t kind, const void *e)
+{
+    switch (kind)
+    {
+    case PART_HASH_SIGNAL:
+        return ((const urj_part_signal_t *) e)->name;
+    case PART_HASH_SALIAS:
+        return ((const urj_part_salias_t *) e)->name;
+    case PART_HASH_INSTRUCTION:
+        return ((const urj_part_instruction_t *) e)->name;
+    case PART_HASH_DATA_REGISTER:
+        return ((const urj_data_register_t *) e)->name;
+    }
+    return NULL;
+}
+
+static void *
+part_hash_elem_next (part_hash_kind_t kind, const void *e)
+{
+    switch (kind)
+    {
+    case PART_HASH_SIGNAL:
+        return ((const urj_part_signal_t *) e)->next;
+    case PART_HASH_SALIAS:
+        return ((const urj_part_salias_t *) e)->next;
+    case PART_HASH_INSTRUCTION:
+        return ((const urj_part_instruction_t *) e)->next;
+    case PART_HASH_DATA_REGISTER:
+        return ((const urj_data_register_t *) e)->next;
+    }
+    return NULL;
+}
+
+/* FNV-1a over the lower case name */
+static unsigned int
+part_hash_string (const char *name)
+{
+    unsigned int h = 2166136261u;
+
+    for (; *name; name++)
+    {
+        h ^= (unsigned char) tolower ((unsigned char) *name);
+        h *= 16777619u;
+    }
+
+    return h;
+}
+
+static void
+part_hash_free (urj_part_hash_t *h)
+{
+    if (!h)
+        return;
+    free (h->slots);
+    free (h);
+}
+
+/* place e in its slot, replacing an element of the same name */
+static void
+part_hash_put (urj_part_hash_t *h, void *e)
+{
+    const char *name = part_hash_elem_name (h->kind, e);
+    unsigned int mask = h->size - 1;
+    unsigned int i = part_hash_string (name) & mask;
+
+    while (h->slots[i])
+    {
+        if (strcasecmp (name, part_hash_elem_name (h->kind, h->slots[i])) == 0)
+        {
+            h->slots[i] = e;
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    h->slots[i] = e;
+    h->count++;
+}
+
+/** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
+static int
+part_hash_resize (urj_part_hash_t *h, unsigned int size)
+{
+    void **old = h->slots;
+    unsigned int old_size = h->size;
+    unsigned int i;
+
+    h->slots = calloc (size, sizeof *h->slots);
+    if (!h->slots)
+    {
+        h->slots = old;
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%u,%zd) fails",
+                       size, sizeof *h->slots);
+        return URJ_STATUS_FAIL;
+    }
+    h->size = size;
+    h->count = 0;
+
+    for (i = 0; i < old_size; i++)
+        if (old[i])
+            part_hash_put (h, old[i]);
+    free (old);
+
+    return URJ_STATUS_OK;
+}
+
+/**
+ * Bring the index in line with the list starting at head.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+static int
+part_hash_sync (urj_part_hash_t **hp, part_hash_kind_t kind, void *head)
+{
+    urj_part_hash_t *h = *hp;
+    const void *e;
+    void **added;
+    unsigned int n, i;
+
+    if (!h)
+    {
+        h = calloc (1, sizeof *h);
+        if (!h)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd) fails",
+                           sizeof *h);
+            return URJ_STATUS_FAIL;
+        }
+        h->kind = kind;
+        *hp = h;
+    }
+
+    if (h->head == head)
+        return URJ_STATUS_OK;
+
+    /* collect the elements prepended since the last sync */
+    n = 0;
+    for (e = head; e && e != h->head; e = part_hash_elem_next (kind, e))
+        n++;
+    if (e != h->head)
+    {
+        /* previously indexed elements vanished, start from scratch */
+        free (h->slots);
+        h->slots = NULL;
+        h->size = 0;
+        h->count = 0;
+        h->head = NULL;
+    }
+
+    if ((h->count + n) * 2 >= h->size)
+    {
+        unsigned int size = h->size ? h->size : PART_HASH_MIN_SIZE;
+
+        while ((h->count + n) * 2 >= size)
+            size *= 2;
+        if (part_hash_resize (h, size) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+    }
+
+    added = malloc ((n + 1) * sizeof *added);
+    if (!added)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
+                       (n + 1) * sizeof *added);
+        return URJ_STATUS_FAIL;
+    }
+    for (i = 0, e = head; i < n; i++, e = part_hash_elem_next (kind, e))
+        added[i] = (void *) e;
+
+    /* oldest first, so that the element nearest to the list head wins
+       for duplicate names just like with a linear search */
+    for (i = n; i > 0; i--)
+        part_hash_put (h, added[i - 1]);
+    free (added);
+
+    h->head = head;
+
+    return URJ_STATUS_OK;
+}
+
+/**
+ * @return element of the list starting at head; NULL if not found (urj_error
+ *         is only set on errors)
+ */
+static void *
+part_hash_find (urj_part_hash_t **hp, part_hash_kind_t kind, void *head,
+                const char *name)
+{
+    urj_part_hash_t *h;
+    unsigned int mask, i;
+
+    if (head == NULL)
+        return NULL;
+    if (part_hash_sync (hp, kind, head) != URJ_STATUS_OK)
+        return NULL;
+
+    h = *hp;
+    mask = h->size - 1;
+    for (i = part_hash_string (name) & mask; h->slots[i]; i = (i + 1) & mask)
+        if (strcasecmp (name, part_hash_elem_name (kind, h->slots[i])) == 0)
+            return h->slots[i];
+
+    return NULL;
+}
+
 /* part */
 
 urj_part_t *
@@ -57,6 +292,7 @@ urj_part_alloc (const urj_tap_register_t *id)
     p->stepping[0] = '\0';
     p->signals = NULL;
     p->saliases = NULL;
+    p->groups = NULL;
     p->instruction_length = 0;
     p->instructions = NULL;
     p->active_instruction = NULL;
@@ -64,6 +300,11 @@ urj_part_alloc (const urj_tap_register_t *id)
     p->boundary_length = 0;
     p->bsbits = NULL;
     p->params = NULL;
+    p->bsr = NULL;
+    p->signal_hash = NULL;
+    p->salias_hash = NULL;
+    p->instruction_hash = NULL;
+    p->data_register_hash = NULL;
 
     return p;
 }
@@ -82,6 +323,11 @@ urj_part_free (urj_part_t *p)
     if (p->alias)
         free (p->alias);        /* djf */
 
+    part_hash_free (p->signal_hash);
+    part_hash_free (p->salias_hash);
+    part_hash_free (p->instruction_hash);
+    part_hash_free (p->data_register_hash);
+
     /* signals */
     while (p->signals)
     {
@@ -98,6 +344,14 @@ urj_part_free (urj_part_t *p)
         urj_part_salias_free (sa);
     }
 
+    /* groups */
+    while (p->groups)
+    {
+        urj_part_group_t *g = p->groups;
+        p->groups = g->next;
+        urj_part_group_free (g);
+    }
+
     /* instructions */
     while (p->instructions)
     {
@@ -129,45 +383,39 @@ urj_part_free (urj_part_t *p)
 urj_part_instruction_t *
 urj_part_find_instruction (urj_part_t *p, const char *iname)
 {
-    urj_part_instruction_t *i;
-
     if (!p || !iname)
     {
         urj_error_set (URJ_ERROR_INVALID, "NULL part or instruction name");
         return NULL;
     }
 
-    i = p->instructions;
-    while (i)
-    {
-        if (strcasecmp (iname, i->name) == 0)
-            break;
-        i = i->next;
-    }
-
-    return i;
+    return part_hash_find (&p->instruction_hash, PART_HASH_INSTRUCTION,
+                           p->instructions, iname);
 }
 
 urj_data_register_t *
 urj_part_find_data_register (urj_part_t *p, const char *drname)
 {
-    urj_data_register_t *dr;
-
     if (!p || !drname)
     {
         urj_error_set (URJ_ERROR_INVALID, "NULL part or data register name");
         return NULL;
     }
 
-    dr = p->data_registers;
-    while (dr)
-    {
-        if (strcasecmp (drname, dr->name) == 0)
-            break;
-        dr = dr->next;
-    }
+    return part_hash_find (&p->data_register_hash, PART_HASH_DATA_REGISTER,
+                           p->data_registers, drname);
+}
+
+urj_data_register_t *
+urj_part_get_bsr (urj_part_t *p)
+{
+    if (!p)
+        return NULL;
+
+    if (!p->bsr)
+        p->bsr = urj_part_find_data_register (p, "BSR");
 
-    return dr;
+    return p->bsr;
 }
 
 urj_part_signal_t *
@@ -182,23 +430,43 @@ urj_part_find_signal (urj_part_t *p, const char *signalname)
         return NULL;
     }
 
-    s = p->signals;
-    while (s)
+    s = part_hash_find (&p->signal_hash, PART_HASH_SIGNAL, p->signals,
+                        signalname);
+    if (s)
+        return s;
+
+    sa = part_hash_find (&p->salias_hash, PART_HASH_SALIAS, p->saliases,
+                         signalname);
+    if (sa)
+        return sa->signal;
+
+    return NULL;
+}
+
+int
+urj_part_find_signals (urj_part_t *p, const char * const *names,
+                       urj_part_signal_t **signals, int n)
+{
+    int i;
+
+    if (!p || !names || !signals)
     {
-        if (strcasecmp (signalname, s->name) == 0)
-            return s;
-        s = s->next;
+        urj_error_set (URJ_ERROR_INVALID, "NULL part, names or signals");
+        return URJ_STATUS_FAIL;
     }
 
-    sa = p->saliases;
-    while (sa)
+    for (i = 0; i < n; i++)
     {
-        if (strcasecmp (signalname, sa->name) == 0)
-            return sa->signal;
-        sa = sa->next;
+        signals[i] = urj_part_find_signal (p, names[i]);
+        if (!signals[i])
+        {
+            urj_error_set (URJ_ERROR_NOTFOUND, _("signal '%s' not found"),
+                           names[i]);
+            return URJ_STATUS_FAIL;
+        }
     }
 
-    return NULL;
+    return URJ_STATUS_OK;
 }
 
 void
@@ -219,8 +487,7 @@ urj_part_set_signal (urj_part_t *p, urj_part_signal_t *s, int out, int val)
         return URJ_STATUS_FAIL;
     }
 
-    /* search for Boundary Scan Register */
-    bsr = urj_part_find_data_register (p, "BSR");
+    bsr = urj_part_get_bsr (p);
     if (!bsr)
     {
         urj_error_set (URJ_ERROR_NOTFOUND,
@@ -272,8 +539,7 @@ urj_part_get_signal (urj_part_t *p, const urj_part_signal_t *s)
         return -1;
     }
 
-    /* search for Boundary Scan Register */
-    bsr = urj_part_find_data_register (p, "BSR");
+    bsr = urj_part_get_bsr (p);
     if (!bsr)
     {
         urj_error_set (URJ_ERROR_NOTFOUND,
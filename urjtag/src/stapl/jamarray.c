@@ -20,6 +20,7 @@
 #include "jamsym.h"
 #include "jamstack.h"
 #include "jamheap.h"
+#include "jamjtag.h"
 #include "jamutil.h"
 #include "jamcomp.h"
 #include "jamarray.h"
@@ -69,6 +70,7 @@ int urj_jam_read_bool_binary (JAMS_HEAP_RECORD *heap_record);
 int urj_jam_read_bool_hex (JAMS_HEAP_RECORD *heap_record);
 int urj_jam_read_bool_run_length (JAMS_HEAP_RECORD *heap_record);
 int urj_jam_read_bool_compressed (JAMS_HEAP_RECORD *heap_record);
+int urj_jam_load_boolean_array_data (JAMS_HEAP_RECORD *heap_record);
 int urj_jam_read_boolean_array_data (JAMS_HEAP_RECORD *heap_record,
                                  char *statement_buffer);
 int urj_jam_extract_int_comma_sep (JAMS_HEAP_RECORD *heap_record,
@@ -1140,27 +1142,82 @@ urj_jam_read_bool_run_length (JAMS_HEAP_RECORD *heap_record)
 /****************************************************************************/
 /*                                                                          */
 
+/*
+ *  State of urj_jam_read_aca_bits(): bits of the last ACA character not
+ *  used yet, and the character that ended the data (0 while reading)
+ */
+static JAM_THREAD_LOCAL int urj_jam_aca_value = 0;
+static JAM_THREAD_LOCAL int urj_jam_aca_bits = 0;
+static JAM_THREAD_LOCAL int urj_jam_aca_end_char = 0;
+
+static short
+urj_jam_read_aca_bits (short bits)
+/*                                                                          */
+/*  Description:    Reads the next "bits" bits of ACA data from the input   */
+/*                  stream, least significant bit first, for                */
+/*                  urj_jam_uncompress_stream().                            */
+/*                                                                          */
+/*  Returns:        Up to 16 bit value. -1 at the end of the data.          */
+/*                                                                          */
+{
+    short result = 0;
+    short shift = 0;
+    int take = 0;
+    int ch = 0;
+
+    while (bits > 0)
+    {
+        if (urj_jam_aca_bits == 0)
+        {
+            if (urj_jam_aca_end_char != 0)
+            {
+                return -1;
+            }
+
+            ch = urj_jam_get_real_char ();
+            urj_jam_aca_value = urj_jam_6bit_char (ch);
+
+            if (urj_jam_aca_value == -1)
+            {
+                urj_jam_aca_end_char = ch;
+                return -1;
+            }
+
+            urj_jam_aca_bits = 6;
+        }
+
+        take = (bits < urj_jam_aca_bits) ? bits : urj_jam_aca_bits;
+        result = (short) (result |
+                          ((urj_jam_aca_value & ((1 << take) - 1)) << shift));
+        urj_jam_aca_value >>= take;
+        urj_jam_aca_bits -= take;
+        shift = (short) (shift + take);
+        bits = (short) (bits - take);
+    }
+
+    return result;
+}
+
+/****************************************************************************/
+/*                                                                          */
+
 JAM_RETURN_TYPE
 urj_jam_read_bool_compressed (JAMS_HEAP_RECORD *heap_record)
 /*                                                                          */
 /*  Description:    Reads Boolean array data directly from input stream.    */
-/*                  Works on data encoded using ACA representation.         */
+/*                  Works on data encoded using ACA representation.  The    */
+/*                  data is uncompressed while it is read, straight into    */
+/*                  the heap record.                                        */
 /*                                                                          */
 /*  Returns:        JAMC_SUCCESS for success, else appropriate error code   */
 /*                                                                          */
 /****************************************************************************/
 {
     int ch = 0;
-    int bit = 0;
     int word = 0;
-    int value = 0;
     int32_t uncompressed_length = 0L;
-    char *in = NULL;
     char *ch_data = NULL;
-    int32_t in_size = 0L;
     int32_t out_size = 0L;
-    int32_t address = 0L;
-    BOOL done = false;
     int32_t *heap_data = &heap_record->data[0];
     JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
@@ -1169,94 +1226,111 @@ urj_jam_read_bool_compressed (JAMS_HEAP_RECORD *heap_record)
         status = JAMC_IO_ERROR;
     }
 
-    /*
-     *      We need two memory buffers:
-     *
-     *      in   (length of compressed bitstream)
-     *      out  (length of uncompressed bitstream)
-     *
-     *      The "out" buffer is inside the heap record.  The "in" buffer
-     *      resides in temporary storage above the last heap record.
-     */
-
-    out_size = (heap_record->dimension >> 3) +
-        ((heap_record->dimension & 7) ? 1 : 0);
-    in = urj_jam_get_temp_workspace (out_size + (out_size / 10) + 100);
-    if (in == NULL)
+    if (status == JAMC_SUCCESS)
     {
-        status = JAMC_OUT_OF_MEMORY;
+        out_size = (heap_record->dimension >> 3) +
+            ((heap_record->dimension & 7) ? 1 : 0);
+
+        urj_jam_aca_value = 0;
+        urj_jam_aca_bits = 0;
+        urj_jam_aca_end_char = 0;
+
+        uncompressed_length =
+            urj_jam_uncompress_stream (urj_jam_read_aca_bits,
+                                       (char *) heap_data, out_size,
+                                       urj_jam_version);
+
+        if (uncompressed_length != out_size)
+        {
+            status = JAMC_SYNTAX_ERROR;
+        }
     }
 
-    while ((status == JAMC_SUCCESS) && (!done))
+    /*
+     *      Skip the padding up to the end of the data
+     */
+    ch = urj_jam_aca_end_char;
+    while ((status == JAMC_SUCCESS) && (ch == 0))
     {
         ch = urj_jam_get_real_char ();
 
-        if (ch == JAMC_SEMICOLON_CHAR)
+        if (urj_jam_6bit_char (ch) != -1)
         {
-            done = true;
+            ch = 0;
         }
-        else
-        {
-            value = urj_jam_6bit_char (ch);
+    }
 
-            if (value == -1)
-            {
-                status = JAMC_SYNTAX_ERROR;
-            }
-            else
-            {
-                for (bit = 0; bit < 6; ++bit)
-                {
-                    if (value & (1 << (bit % 6)))
-                    {
-                        in[address >> 3] |= (1L << (address & 7));
-                    }
-                    else
-                    {
-                        in[address >> 3] &=
-                            ~(unsigned int) (1 << (address & 7));
-                    }
-                    ++address;
-                }
-            }
+    if ((status == JAMC_SUCCESS) && (ch != JAMC_SEMICOLON_CHAR))
+    {
+        status = (ch == EOF) ? JAMC_UNEXPECTED_END : JAMC_SYNTAX_ERROR;
+    }
+
+    if (status == JAMC_SUCCESS)
+    {
+        /* convert data from bytes into 32-bit words */
+        out_size = (heap_record->dimension >> 5) +
+            ((heap_record->dimension & 0x1f) ? 1 : 0);
+        ch_data = (char *) heap_data;
+
+        for (word = 0; word < out_size; ++word)
+        {
+            heap_data[word] =
+                ((((int32_t) ch_data[(word * 4) + 3]) & 0xff) << 24L) |
+                ((((int32_t) ch_data[(word * 4) + 2]) & 0xff) << 16L) |
+                ((((int32_t) ch_data[(word * 4) + 1]) & 0xff) << 8L) |
+                (((int32_t) ch_data[word * 4]) & 0xff);
         }
     }
 
-    if (done && (status == JAMC_SUCCESS))
+    return status;
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+JAM_RETURN_TYPE
+urj_jam_load_boolean_array_data (JAMS_HEAP_RECORD *heap_record)
+/*                                                                          */
+/*  Description:    Reads the RLC or ACA initialization data of a Boolean   */
+/*                  array whose data was too long for the statement buffer. */
+/*                  This is done when the array is referenced for the first */
+/*                  time, so arrays not used by the action being run are    */
+/*                  never uncompressed.  The file pointer is restored.      */
+/*                  The TDO data of pending captures into the array is      */
+/*                  collected here as well.                                 */
+/*                                                                          */
+/*  Returns:        JAMC_SUCCESS for success, else appropriate error code   */
+/*                                                                          */
+/****************************************************************************/
+{
+    JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+    status = urj_jam_jtag_reference_array (heap_record->data);
+
+    if ((status == JAMC_SUCCESS) && heap_record->deferred)
     {
-        /*
-         *      Uncompress the data
-         */
-        in_size = (address >> 3) + ((address & 7) ? 1 : 0);
-        uncompressed_length =
-            urj_jam_uncompress (in, in_size, (char *) heap_data, out_size,
-                            urj_jam_version);
+        heap_record->deferred = false;
 
-        if (uncompressed_length != out_size)
+        if (heap_record->rep == JAM_BOOL_RUN_LENGTH)
         {
-            status = JAMC_SYNTAX_ERROR;
+            status = urj_jam_read_bool_run_length (heap_record);
+        }
+        else if (heap_record->rep == JAM_BOOL_COMPRESSED)
+        {
+            status = urj_jam_read_bool_compressed (heap_record);
         }
         else
         {
-            /* convert data from bytes into 32-bit words */
-            out_size = (heap_record->dimension >> 5) +
-                ((heap_record->dimension & 0x1f) ? 1 : 0);
-            ch_data = (char *) heap_data;
+            status = JAMC_INTERNAL_ERROR;
+        }
 
-            for (word = 0; word < out_size; ++word)
-            {
-                heap_data[word] =
-                    ((((int32_t) ch_data[(word * 4) + 3]) & 0xff) << 24L) |
-                    ((((int32_t) ch_data[(word * 4) + 2]) & 0xff) << 16L) |
-                    ((((int32_t) ch_data[(word * 4) + 1]) & 0xff) << 8L) |
-                    (((int32_t) ch_data[word * 4]) & 0xff);
-            }
+        if ((urj_jam_seek (urj_jam_current_file_position) != 0) &&
+            (status == JAMC_SUCCESS))
+        {
+            status = JAMC_IO_ERROR;
         }
     }
 
-    if (in != NULL)
-        urj_jam_free_temp_workspace (in);
-
     return status;
 }
 
@@ -1518,11 +1592,9 @@ JAM_RETURN_TYPE urj_jam_read_boolean_array_data
                 break;
 
             case JAM_BOOL_RUN_LENGTH:
-                status = urj_jam_read_bool_run_length (heap_record);
-                break;
-
             case JAM_BOOL_COMPRESSED:
-                status = urj_jam_read_bool_compressed (heap_record);
+                /* read by urj_jam_load_boolean_array_data() on first use */
+                heap_record->deferred = true;
                 break;
 
             default:
@@ -1986,7 +2058,7 @@ JAM_RETURN_TYPE urj_jam_get_array_value
     }
     else
     {
-        heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+        heap_record = symbol_record->heap_record;
 
         if (heap_record == NULL)
         {
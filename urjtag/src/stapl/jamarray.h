@@ -16,6 +16,9 @@
 JAM_RETURN_TYPE urj_jam_read_boolean_array_data
     (JAMS_HEAP_RECORD *heap_record, char *statement_buffer);
 
+JAM_RETURN_TYPE urj_jam_load_boolean_array_data
+    (JAMS_HEAP_RECORD *heap_record);
+
 JAM_RETURN_TYPE urj_jam_read_integer_array_data
     (JAMS_HEAP_RECORD *heap_record, char *statement_buffer);
 
@@ -28,6 +28,13 @@ short urj_jam_bits_required (short n);
 short urj_jam_read_packed (char *buffer, int32_t length, short bits);
 int32_t urj_jam_uncompress (char *in, int32_t in_length, char *out,
                         int32_t out_length, int version);
+int32_t urj_jam_uncompress_stream (short (*read_bits) (short bits),
+                                   char *out, int32_t out_length,
+                                   int version);
+
+/* input of urj_jam_uncompress() */
+static JAM_THREAD_LOCAL char *urj_jam_packed_buffer = NULL;
+static JAM_THREAD_LOCAL int32_t urj_jam_packed_length = 0L;
 
 /****************************************************************************/
 /*                                                                          */
@@ -75,8 +82,8 @@ urj_jam_read_packed (char *buffer, int32_t length, short bits)
 /****************************************************************************/
 {
     short result = -1;
-    static int32_t index = 0L;
-    static short bits_avail = 0;
+    static JAM_THREAD_LOCAL int32_t index = 0L;
+    static JAM_THREAD_LOCAL short bits_avail = 0;
     short shift = 0;
 
     /* If buffer is NULL then initialize. */
@@ -124,6 +131,16 @@ urj_jam_read_packed (char *buffer, int32_t length, short bits)
 /****************************************************************************/
 /*                                                                          */
 
+static short
+urj_jam_read_packed_buffer (short bits)
+{
+    return urj_jam_read_packed (urj_jam_packed_buffer, urj_jam_packed_length,
+                                bits);
+}
+
+/****************************************************************************/
+/*                                                                          */
+
 int32_t urj_jam_uncompress
     (char *in, int32_t in_length, char *out, int32_t out_length, int version)
 /*                                                                          */
@@ -135,26 +152,55 @@ int32_t urj_jam_uncompress
 /*                      3) in doesn't contain ACA compressed data.          */
 /*                                                                          */
 /****************************************************************************/
+{
+    urj_jam_read_packed (NULL, 0, 0);
+    urj_jam_packed_buffer = in;
+    urj_jam_packed_length = in_length;
+
+    return urj_jam_uncompress_stream (urj_jam_read_packed_buffer, out,
+                                      out_length, version);
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+int32_t urj_jam_uncompress_stream
+    (short (*read_bits) (short bits), char *out, int32_t out_length,
+     int version)
+/*                                                                          */
+/*  Description:    Uncompress data delivered by "read_bits" and write      */
+/*                  result to "out".  read_bits() returns the next "bits"   */
+/*                  bits of the compressed data, least significant bit      */
+/*                  first, or -1 at the end of the data.  Matches refer to  */
+/*                  data already written to "out", so the compressed data   */
+/*                  does not need to be held in memory.                     */
+/*                                                                          */
+/*  Returns:        Length of uncompressed data. -1 if:                     */
+/*                      1) out_length is too small                          */
+/*                      2) Internal error in the code                       */
+/*                      3) the data ends early or is not ACA compressed     */
+/*                                                                          */
+/****************************************************************************/
 {
     int32_t i, j, data_length = 0L;
-    short offset, length;
+    short offset, length, value;
     int32_t match_data_length = MATCH_DATA_LENGTH;
 
     if (version == 2)
         --match_data_length;
 
-    urj_jam_read_packed (NULL, 0, 0);
     for (i = 0; i < out_length; ++i)
         out[i] = 0;
 
     /* Read number of bytes in data. */
-    for (i = 0; i < sizeof (in_length); ++i)
+    for (i = 0; (data_length != -1L) && (i < sizeof (int32_t)); ++i)
     {
-        data_length =
-            data_length | ((int32_t)
-                           urj_jam_read_packed (in, in_length,
-                                            CHAR_BITS) << (int32_t) (i *
-                                                                     CHAR_BITS));
+        value = read_bits (CHAR_BITS);
+        if (value == -1)
+            data_length = -1L;
+        else
+            data_length = data_length | ((int32_t) value << (int32_t) (i *
+                                                                   CHAR_BITS));
     }
 
     if (data_length > out_length)
@@ -165,31 +211,34 @@ int32_t urj_jam_uncompress
         while (i < data_length)
         {
             /* A 0 bit indicates literal data. */
-            if (urj_jam_read_packed (in, in_length, 1) == 0)
+            value = read_bits (1);
+            if (value == 0)
             {
                 for (j = 0; j < DATA_BLOB_LENGTH; ++j)
                 {
                     if (i < data_length)
                     {
-                        out[i] =
-                            (char) urj_jam_read_packed (in, in_length, CHAR_BITS);
+                        value = read_bits (CHAR_BITS);
+                        if (value == -1)
+                            break;
+                        out[i] = (char) value;
                         i++;
                     }
                 }
             }
-            else
+            else if (value == 1)
             {
                 /* A 1 bit indicates offset/length to follow. */
                 offset =
-                    urj_jam_read_packed (in, in_length,
-                                     urj_jam_bits_required ((short)
-                                                        (i >
-                                                         match_data_length ?
-                                                         match_data_length :
-                                                         i)));
-                length = urj_jam_read_packed (in, in_length, CHAR_BITS);
-
-                for (j = 0; j < length; ++j)
+                    read_bits (urj_jam_bits_required ((short)
+                                                      (i >
+                                                       match_data_length ?
+                                                       match_data_length :
+                                                       i)));
+                length = read_bits (CHAR_BITS);
+                if ((offset < 0) || (offset > i) || (length == -1))
+                    value = -1;
+                for (j = 0; (value != -1) && (j < length); ++j)
                 {
                     if (i < data_length)
                     {
@@ -198,6 +247,12 @@ int32_t urj_jam_uncompress
                     }
                 }
             }
+
+            if (value == -1)
+            {
+                /* premature end or corrupted data */
+                data_length = -1L;
+            }
         }
     }
 
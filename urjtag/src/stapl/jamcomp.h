@@ -17,4 +17,8 @@
 int32_t urj_jam_uncompress
     (char *in, int32_t in_length, char *out, int32_t out_length, int version);
 
+int32_t urj_jam_uncompress_stream
+    (short (*read_bits) (short bits), char *out, int32_t out_length,
+     int version);
+
 #endif /* INC_JAMCOMP_H */
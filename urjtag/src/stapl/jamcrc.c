@@ -21,6 +21,10 @@ void urj_jam_crc_update (unsigned short *shift_register, int data);
 unsigned short urj_jam_get_crc_value (unsigned short *shift_register);
 int urj_jam_check_crc (char *program, int32_t program_size,
                    unsigned short *expected_crc, unsigned short *actual_crc);
+
+/* next character of the program buffer, or EOF */
+#define JAM_CRC_GETC() ((read_position < program_size) ? \
+    (int) program[read_position++] : EOF)
 /****************************************************************************/
 /*                                                                          */
 
@@ -96,14 +100,16 @@ JAM_RETURN_TYPE urj_jam_check_crc
      int32_t program_size,
      unsigned short *expected_crc, unsigned short *actual_crc)
 /*                                                                          */
-/*  Description:    This function reads the entire input stream and         */
+/*  Description:    This function reads the entire program buffer and       */
 /*                  computes the CRC of everything up to the CRC statement  */
 /*                  itself (and the preceding new-line, if applicable).     */
 /*                  Carriage return characters (0x0d) which are followed    */
 /*                  by new-line characters (0x0a) are ignored, so the CRC   */
 /*                  will not change when the file is converted from MS-DOS  */
 /*                  text format (with CR-LF) to UNIX text format (only LF)  */
-/*                  and visa-versa.                                         */
+/*                  and visa-versa.  The buffer is read directly, not       */
+/*                  through urj_jam_getc(), so that this may run in another */
+/*                  thread while the program is executed.                   */
 /*                                                                          */
 /*  Returns:        JAMC_SUCCESS for success, else appropriate error code   */
 /*                                                                          */
@@ -116,6 +122,7 @@ JAM_RETURN_TYPE urj_jam_check_crc
     BOOL found_expected_crc = false;
     int ch = 0;
     int32_t position = 0L;
+    int32_t read_position = 0L;
     int32_t left_quote_position = -1L;
     unsigned short crc_shift_register = 0;
     unsigned short crc_shift_register_backup[4] = { 0 };
@@ -124,16 +131,16 @@ JAM_RETURN_TYPE urj_jam_check_crc
     unsigned short tmp_actual_crc = 0;
     JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
-    urj_jam_program = program;
-    urj_jam_program_size = program_size;
-
-    status = urj_jam_seek (0);
+    if (program_size <= 0L)
+    {
+        status = JAMC_IO_ERROR;
+    }
 
     urj_jam_crc_init (&crc_shift_register);
 
     while ((status == JAMC_SUCCESS) && (!found_expected_crc))
     {
-        ch = urj_jam_getc ();
+        ch = JAM_CRC_GETC ();
 
         if ((ch != EOF) && (ch != JAMC_RETURN_CHAR))
         {
@@ -170,16 +177,16 @@ JAM_RETURN_TYPE urj_jam_check_crc
                 /* skip over any additional white space */
                 do
                 {
-                    ch = urj_jam_getc ();
+                    ch = JAM_CRC_GETC ();
                 }
                 while ((ch != EOF) && (isspace ((char) ch)));
 
                 if (isxdigit ((char) ch))
                 {
                     /* get remaining three characters of CRC */
-                    ch_queue[2] = urj_jam_getc ();
-                    ch_queue[1] = urj_jam_getc ();
-                    ch_queue[0] = urj_jam_getc ();
+                    ch_queue[2] = JAM_CRC_GETC ();
+                    ch_queue[1] = JAM_CRC_GETC ();
+                    ch_queue[0] = JAM_CRC_GETC ();
 
                     if ((isxdigit ((char) ch_queue[2])) &&
                         (isxdigit ((char) ch_queue[1])) &&
@@ -194,7 +201,7 @@ JAM_RETURN_TYPE urj_jam_check_crc
                         /* skip over any additional white space */
                         do
                         {
-                            ch = urj_jam_getc ();
+                            ch = JAM_CRC_GETC ();
                         }
                         while ((ch != EOF) && (isspace ((char) ch)));
 
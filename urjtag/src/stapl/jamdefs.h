@@ -158,16 +158,12 @@ typedef enum
 /*                                                                          */
 /****************************************************************************/
 
-extern char *urj_jam_workspace;
+extern JAM_THREAD_LOCAL char *urj_jam_program;
 
-extern int32_t urj_jam_workspace_size;
+extern JAM_THREAD_LOCAL int32_t urj_jam_program_size;
 
-extern char *urj_jam_program;
+extern JAM_THREAD_LOCAL char **urj_jam_init_list;
 
-extern int32_t urj_jam_program_size;
-
-extern char **urj_jam_init_list;
-
-extern JAME_PHASE_TYPE urj_jam_phase;
+extern JAM_THREAD_LOCAL JAME_PHASE_TYPE urj_jam_phase;
 
 #endif /* INC_JAMDEFS_H */
@@ -37,57 +37,112 @@
 /*                                                                          */
 /****************************************************************************/
 
-/* pointer to memory buffer for variable, symbol and stack storage */
-char *urj_jam_workspace = NULL;
-
-/* size of available memory buffer */
-int32_t urj_jam_workspace_size = 0L;
-
 /* pointer to Jam program text */
-char *urj_jam_program = NULL;
+JAM_THREAD_LOCAL char *urj_jam_program = NULL;
 
 /* size of program buffer */
-int32_t urj_jam_program_size = 0L;
+JAM_THREAD_LOCAL int32_t urj_jam_program_size = 0L;
 
 /* current position in input stream */
-int32_t urj_jam_current_file_position = 0L;
+JAM_THREAD_LOCAL int32_t urj_jam_current_file_position = 0L;
 
 /* position in input stream of the beginning of the current statement */
-int32_t urj_jam_current_statement_position = 0L;
+JAM_THREAD_LOCAL int32_t urj_jam_current_statement_position = 0L;
 
 /* position of the beginning of the next statement (the one after the */
 /* current statement, but not necessarily the next one to be executed) */
-int32_t urj_jam_next_statement_position = 0L;
+JAM_THREAD_LOCAL int32_t urj_jam_next_statement_position = 0L;
 
 /* name of desired action (Jam 2.0 only) */
-char *urj_jam_action = NULL;
+JAM_THREAD_LOCAL char *urj_jam_action = NULL;
 
 /* pointer to initialization list */
-char **urj_jam_init_list = NULL;
+JAM_THREAD_LOCAL char **urj_jam_init_list = NULL;
 
 /* buffer for constant literal boolean array data */
 #define JAMC_MAX_LITERAL_ARRAYS 4
-int32_t urj_jam_literal_array_buffer[JAMC_MAX_LITERAL_ARRAYS];
+JAM_THREAD_LOCAL int32_t urj_jam_literal_array_buffer[JAMC_MAX_LITERAL_ARRAYS];
 
 /* buffer for constant literal ACA array data */
-int32_t *urj_jam_literal_aca_buffer[JAMC_MAX_LITERAL_ARRAYS];
+JAM_THREAD_LOCAL int32_t *urj_jam_literal_aca_buffer[JAMC_MAX_LITERAL_ARRAYS];
 
 /* number of vector signals */
-int urj_jam_vector_signal_count = 0;
+JAM_THREAD_LOCAL int urj_jam_vector_signal_count = 0;
 
 /* version of Jam language used:  0 = unknown */
-int urj_jam_version = 0;
+JAM_THREAD_LOCAL int urj_jam_version = 0;
 
 /* phase of Jam execution */
-JAME_PHASE_TYPE urj_jam_phase = JAM_UNKNOWN_PHASE;
+JAM_THREAD_LOCAL JAME_PHASE_TYPE urj_jam_phase = JAM_UNKNOWN_PHASE;
 
 /* current procedure or data block */
-JAMS_SYMBOL_RECORD *urj_jam_current_block = NULL;
+JAM_THREAD_LOCAL JAMS_SYMBOL_RECORD *urj_jam_current_block = NULL;
 
 /* this global flag indicates that we are processing the items in */
 /* the "uses" list for a procedure, executing the data blocks if */
 /* they have not yet been initialized, but not calling any procedures */
-BOOL urj_jam_checking_uses_list = false;
+JAM_THREAD_LOCAL BOOL urj_jam_checking_uses_list = false;
+
+/*
+ *  Statements read again, keyed by their file position.  The first pass
+ *  through the program reads every statement once; loops, GOTO and
+ *  procedure calls go back to statements which were read before, and
+ *  those are kept so that their text is not scanned and preprocessed
+ *  again each time they are executed.
+ */
+#define JAMC_STATEMENT_CACHE_SIZE 1024  /* number of hash buckets */
+#define JAMC_MAX_CACHED_STATEMENT 1024  /* longer statements are read again */
+
+typedef struct JAMS_STATEMENT_CACHE
+{
+    struct JAMS_STATEMENT_CACHE *next;
+    int32_t file_position;      /* where the statement was read from */
+    int32_t end_position;       /* urj_jam_current_file_position after it */
+    int32_t statement_position; /* -1 if the statement is empty */
+    int32_t next_statement_position;
+    char label[JAMC_MAX_NAME_LENGTH + 1];
+    char statement[1];
+} JAMS_STATEMENT_CACHE;
+
+static JAM_THREAD_LOCAL JAMS_STATEMENT_CACHE
+    *jam_statement_cache[JAMC_STATEMENT_CACHE_SIZE];
+
+/* end of the part of the program which has been read at least once */
+static JAM_THREAD_LOCAL int32_t jam_statement_frontier = 0L;
+
+/*
+ *  Execution profile, enabled by urj_jam_set_profile().  The time from the
+ *  start of a statement to the start of the next one, not counting the
+ *  statements of procedures it calls, and the bits it scans are added up
+ *  per statement and per procedure or data block.  Blocks also get the
+ *  time from their call to their end.  Scans are queued by the cable, so
+ *  their time may be charged to the statement which waits for them.
+ */
+#define JAMC_PROFILE_HASH_SIZE 1024 /* number of hash buckets */
+
+typedef struct JAMS_PROFILE_RECORD
+{
+    struct JAMS_PROFILE_RECORD *next;
+    struct JAMS_PROFILE_RECORD *block_record; /* record of the block */
+    JAMS_SYMBOL_RECORD *block;  /* procedure or data block, or NULL */
+    int32_t position;           /* of the statement, -1 for a block */
+    int32_t line;
+    int32_t count;
+    int depth;                  /* nested calls of a block */
+    double call_time;           /* start of the outermost call */
+    double seconds;
+    double total_seconds;       /* blocks only: from call to end */
+    int64_t bits;
+} JAMS_PROFILE_RECORD;
+
+static JAM_THREAD_LOCAL BOOL jam_profile_enabled = false;
+static JAM_THREAD_LOCAL JAMS_PROFILE_RECORD
+    *jam_profile_table[JAMC_PROFILE_HASH_SIZE];
+static JAM_THREAD_LOCAL JAMS_PROFILE_RECORD *jam_profile_blocks = NULL;
+static JAM_THREAD_LOCAL JAMS_PROFILE_RECORD *jam_profile_current = NULL;
+static JAM_THREAD_LOCAL int32_t jam_profile_statement_count = 0L;
+static JAM_THREAD_LOCAL double jam_profile_mark = 0.0;
+static JAM_THREAD_LOCAL int64_t jam_profile_bit_mark = 0;
 
 /* function prototypes for forward reference */
 int urj_jam_get_statement (char *statement_buffer, char *label_buffer);
@@ -179,16 +234,16 @@ void urj_jam_free_literal_aca_buffers (void);
 int urj_jam_execute_statement (char *statement_buffer, BOOL *done,
                            BOOL *reuse_statement_buffer, int *exit_code);
 int32_t urj_jam_get_line_of_position (int32_t position);
-int urj_jam_execute (char *program, int32_t program_size, char *workspace,
-                 int32_t workspace_size, char *action, char **init_list,
+int urj_jam_execute (char *program, int32_t program_size, char *action,
+                 char **init_list,
                  int reset_jtag, int32_t *error_line, int *exit_code,
                  int *format_version);
 
 /****************************************************************************/
 /*                                                                          */
 
-JAM_RETURN_TYPE
-urj_jam_get_statement (char *statement_buffer, char *label_buffer)
+static JAM_RETURN_TYPE
+urj_jam_read_statement (char *statement_buffer, char *label_buffer)
 /*                                                                          */
 /*  Description:    This function reads a full statement from the input     */
 /*                  stream, preprocesses it to remove comments, and stores  */
@@ -387,6 +442,458 @@ urj_jam_get_statement (char *statement_buffer, char *label_buffer)
     return status;
 }
 
+/****************************************************************************/
+/*                                                                          */
+
+static void
+urj_jam_free_statement_cache (void)
+{
+    JAMS_STATEMENT_CACHE *cache = NULL;
+    int i;
+
+    for (i = 0; i < JAMC_STATEMENT_CACHE_SIZE; ++i)
+    {
+        while (jam_statement_cache[i] != NULL)
+        {
+            cache = jam_statement_cache[i];
+            jam_statement_cache[i] = cache->next;
+            free (cache);
+        }
+    }
+
+    jam_statement_frontier = 0L;
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+void
+urj_jam_set_profile (int enable)
+/*                                                                          */
+/*  Description:    Enables or disables the execution profile for the next  */
+/*                  programs executed by the calling thread.  The profile   */
+/*                  is reported through urj_jam_export_profile().           */
+/*                                                                          */
+/*  Returns:        Nothing                                                 */
+/*                                                                          */
+/****************************************************************************/
+{
+    jam_profile_enabled = enable ? true : false;
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+static JAMS_PROFILE_RECORD *
+urj_jam_profile_block (JAMS_SYMBOL_RECORD *block)
+/*                                                                          */
+/*  Description:    Finds or adds the profile record of a procedure or     */
+/*                  data block.                                             */
+/*                                                                          */
+/*  Returns:        pointer to the record, or NULL for the statements       */
+/*                  outside of blocks or if memory is not available         */
+/*                                                                          */
+/****************************************************************************/
+{
+    JAMS_PROFILE_RECORD *record = jam_profile_blocks;
+
+    if (block == NULL)
+    {
+        return NULL;
+    }
+
+    while ((record != NULL) && (record->block != block))
+    {
+        record = record->next;
+    }
+
+    if (record == NULL)
+    {
+        record = calloc (1, sizeof (JAMS_PROFILE_RECORD));
+
+        if (record != NULL)
+        {
+            record->block = block;
+            record->position = -1L;
+            record->next = jam_profile_blocks;
+            jam_profile_blocks = record;
+        }
+    }
+
+    return record;
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+static void
+urj_jam_profile_charge (void)
+/*                                                                          */
+/*  Description:    Adds the time and the scanned bits since the last call  */
+/*                  to the statement being executed and to its block.       */
+/*                                                                          */
+/*  Returns:        Nothing                                                 */
+/*                                                                          */
+/****************************************************************************/
+{
+    double now = urj_jam_profile_clock ();
+    double seconds = now - jam_profile_mark;
+    int64_t bits = urj_jam_scan_bit_count - jam_profile_bit_mark;
+
+    if (jam_profile_current != NULL)
+    {
+        jam_profile_current->seconds += seconds;
+        jam_profile_current->bits += bits;
+
+        if (jam_profile_current->block_record != NULL)
+        {
+            jam_profile_current->block_record->seconds += seconds;
+            jam_profile_current->block_record->bits += bits;
+        }
+    }
+
+    jam_profile_mark = now;
+    jam_profile_bit_mark = urj_jam_scan_bit_count;
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+static JAMS_PROFILE_RECORD *
+urj_jam_profile_enter_statement (void)
+/*                                                                          */
+/*  Description:    Starts charging the statement at the current statement  */
+/*                  position, which is about to be executed.                */
+/*                                                                          */
+/*  Returns:        the record of the statement executed before, to be      */
+/*                  passed to urj_jam_profile_leave_statement()             */
+/*                                                                          */
+/****************************************************************************/
+{
+    JAMS_PROFILE_RECORD *outer = jam_profile_current;
+    JAMS_PROFILE_RECORD *record = NULL;
+    int32_t position = urj_jam_current_statement_position;
+    int hash = (int) (position % JAMC_PROFILE_HASH_SIZE);
+
+    urj_jam_profile_charge ();
+
+    record = jam_profile_table[hash];
+
+    while ((record != NULL) && (record->position != position))
+    {
+        record = record->next;
+    }
+
+    if (record == NULL)
+    {
+        record = calloc (1, sizeof (JAMS_PROFILE_RECORD));
+
+        if (record != NULL)
+        {
+            record->block = urj_jam_current_block;
+            record->block_record = urj_jam_profile_block (record->block);
+            record->position = position;
+            record->next = jam_profile_table[hash];
+            jam_profile_table[hash] = record;
+            ++jam_profile_statement_count;
+        }
+    }
+
+    if (record != NULL)
+    {
+        ++record->count;
+    }
+
+    jam_profile_current = record;
+
+    return outer;
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+static void
+urj_jam_profile_leave_statement (JAMS_PROFILE_RECORD *outer)
+/*                                                                          */
+/*  Description:    Ends charging the statement just executed and resumes   */
+/*                  charging the statement which executed it, if any.       */
+/*                                                                          */
+/*  Returns:        Nothing                                                 */
+/*                                                                          */
+/****************************************************************************/
+{
+    urj_jam_profile_charge ();
+
+    jam_profile_current = outer;
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+static void
+urj_jam_profile_call (JAMS_SYMBOL_RECORD *block, BOOL enter)
+/*                                                                          */
+/*  Description:    Counts a call of a procedure or data block, and adds    */
+/*                  the time from the outermost call to its end.           */
+/*                                                                          */
+/*  Returns:        Nothing                                                 */
+/*                                                                          */
+/****************************************************************************/
+{
+    JAMS_PROFILE_RECORD *record = urj_jam_profile_block (block);
+
+    if (record == NULL)
+    {
+        return;
+    }
+
+    if (enter)
+    {
+        ++record->count;
+
+        if (record->depth++ == 0)
+        {
+            record->call_time = urj_jam_profile_clock ();
+        }
+    }
+    else if ((record->depth > 0) && (--record->depth == 0))
+    {
+        record->total_seconds += urj_jam_profile_clock () - record->call_time;
+    }
+}
+
+static int
+urj_jam_profile_compare_position (const void *a, const void *b)
+{
+    const JAMS_PROFILE_RECORD *ra = *(JAMS_PROFILE_RECORD * const *) a;
+    const JAMS_PROFILE_RECORD *rb = *(JAMS_PROFILE_RECORD * const *) b;
+
+    return (ra->position > rb->position) - (ra->position < rb->position);
+}
+
+static int
+urj_jam_profile_compare_time (const void *a, const void *b)
+{
+    const JAMS_PROFILE_RECORD *ra = *(JAMS_PROFILE_RECORD * const *) a;
+    const JAMS_PROFILE_RECORD *rb = *(JAMS_PROFILE_RECORD * const *) b;
+    double ta = (ra->position < 0L) ? ra->total_seconds : ra->seconds;
+    double tb = (rb->position < 0L) ? rb->total_seconds : rb->seconds;
+
+    if (ta != tb)
+    {
+        return (ta < tb) ? 1 : -1;
+    }
+
+    return urj_jam_profile_compare_position (a, b);
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+static void
+urj_jam_profile_report (void)
+/*                                                                          */
+/*  Description:    Passes the profile records to urj_jam_export_profile(), */
+/*                  the blocks first, each group sorted by time.  The line  */
+/*                  numbers of all statements are found in one pass over    */
+/*                  the program.                                            */
+/*                                                                          */
+/*  Returns:        Nothing                                                 */
+/*                                                                          */
+/****************************************************************************/
+{
+    JAMS_PROFILE_RECORD **records = NULL;
+    JAMS_PROFILE_RECORD *record = NULL;
+    int32_t count = 0L;
+    int32_t index = 0L;
+    int32_t line = 1L;
+    int32_t position = 0L;
+    int i;
+
+    for (record = jam_profile_blocks; record != NULL; record = record->next)
+    {
+        ++count;
+    }
+
+    if (count + jam_profile_statement_count == 0L)
+    {
+        return;
+    }
+
+    records = malloc ((size_t) (count + jam_profile_statement_count) *
+                      sizeof (JAMS_PROFILE_RECORD *));
+
+    if (records == NULL)
+    {
+        return;
+    }
+
+    for (record = jam_profile_blocks; record != NULL; record = record->next)
+    {
+        records[index++] = record;
+    }
+
+    qsort (records, (size_t) count, sizeof (JAMS_PROFILE_RECORD *),
+           urj_jam_profile_compare_time);
+
+    for (i = 0; i < JAMC_PROFILE_HASH_SIZE; ++i)
+    {
+        for (record = jam_profile_table[i]; record != NULL;
+             record = record->next)
+        {
+            records[index++] = record;
+        }
+    }
+
+    qsort (&records[count], (size_t) jam_profile_statement_count,
+           sizeof (JAMS_PROFILE_RECORD *), urj_jam_profile_compare_position);
+
+    if (urj_jam_seek (0L) == 0)
+    {
+        for (index = count; index < count + jam_profile_statement_count;
+             ++index)
+        {
+            while (position < records[index]->position)
+            {
+                if (urj_jam_getc () == JAMC_NEWLINE_CHAR)
+                {
+                    ++line;
+                }
+                ++position;
+            }
+
+            records[index]->line = line;
+        }
+    }
+
+    qsort (&records[count], (size_t) jam_profile_statement_count,
+           sizeof (JAMS_PROFILE_RECORD *), urj_jam_profile_compare_time);
+
+    for (index = 0; index < count + jam_profile_statement_count; ++index)
+    {
+        record = records[index];
+
+        urj_jam_export_profile
+            ((record->block != NULL) ? record->block->name : "",
+             (record->position < 0L) ? 0L : record->line,
+             record->count,
+             (record->position < 0L) ? record->total_seconds : record->seconds,
+             record->seconds, record->bits);
+    }
+
+    free (records);
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+static void
+urj_jam_free_profile (void)
+{
+    JAMS_PROFILE_RECORD *record = NULL;
+    int i;
+
+    for (i = 0; i < JAMC_PROFILE_HASH_SIZE; ++i)
+    {
+        while (jam_profile_table[i] != NULL)
+        {
+            record = jam_profile_table[i];
+            jam_profile_table[i] = record->next;
+            free (record);
+        }
+    }
+
+    while (jam_profile_blocks != NULL)
+    {
+        record = jam_profile_blocks;
+        jam_profile_blocks = record->next;
+        free (record);
+    }
+
+    jam_profile_current = NULL;
+    jam_profile_statement_count = 0L;
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+JAM_RETURN_TYPE
+urj_jam_get_statement (char *statement_buffer, char *label_buffer)
+/*                                                                          */
+/*  Description:    Gets the statement at the current file position.        */
+/*                  Statements before the furthest position read so far     */
+/*                  are taken from the statement cache, or read and added   */
+/*                  to it.                                                  */
+/*                                                                          */
+/*  Returns:        JAMC_SUCCESS for success, else appropriate error code   */
+/*                                                                          */
+/****************************************************************************/
+{
+    JAM_RETURN_TYPE status = JAMC_SUCCESS;
+    JAMS_STATEMENT_CACHE *cache = NULL;
+    int32_t position = urj_jam_current_file_position;
+    int hash = (int) (position % JAMC_STATEMENT_CACHE_SIZE);
+    BOOL revisit = (position < jam_statement_frontier);
+    size_t length = 0;
+
+    if (revisit)
+    {
+        cache = jam_statement_cache[hash];
+
+        while ((cache != NULL) && (cache->file_position != position))
+        {
+            cache = cache->next;
+        }
+
+        if ((cache != NULL) && (urj_jam_seek (cache->end_position) == 0))
+        {
+            strcpy (statement_buffer, cache->statement);
+            strcpy (label_buffer, cache->label);
+
+            urj_jam_current_file_position = cache->end_position;
+            if (cache->statement_position != -1L)
+            {
+                urj_jam_current_statement_position =
+                    cache->statement_position;
+            }
+            urj_jam_next_statement_position = cache->next_statement_position;
+
+            return JAMC_SUCCESS;
+        }
+    }
+
+    status = urj_jam_read_statement (statement_buffer, label_buffer);
+
+    if (urj_jam_current_file_position > jam_statement_frontier)
+    {
+        jam_statement_frontier = urj_jam_current_file_position;
+    }
+
+    length = strlen (statement_buffer);
+
+    if (revisit && (status == JAMC_SUCCESS) &&
+        (length <= JAMC_MAX_CACHED_STATEMENT))
+    {
+        cache = malloc (sizeof (JAMS_STATEMENT_CACHE) + length);
+
+        if (cache != NULL)
+        {
+            cache->file_position = position;
+            cache->end_position = urj_jam_current_file_position;
+            cache->statement_position = (length > 0) ?
+                urj_jam_current_statement_position : -1L;
+            cache->next_statement_position = urj_jam_next_statement_position;
+            strcpy (cache->label, label_buffer);
+            strcpy (cache->statement, statement_buffer);
+
+            cache->next = jam_statement_cache[hash];
+            jam_statement_cache[hash] = cache;
+        }
+    }
+
+    return status;
+}
+
 struct JAMS_INSTR_MAP
 {
     JAME_INSTRUCTION instruction;
@@ -686,8 +1193,7 @@ JAM_RETURN_TYPE urj_jam_get_array_subrange
 
         if (statement_buffer[index] == JAMC_NULL_CHAR)
         {
-            JAMS_HEAP_RECORD *heap_record =
-                (JAMS_HEAP_RECORD *) symbol_record->value;
+            JAMS_HEAP_RECORD *heap_record = symbol_record->heap_record;
 
             if (heap_record == NULL)
             {
@@ -814,7 +1320,7 @@ JAM_RETURN_TYPE urj_jam_convert_literal_binary
         if (rev_index > 1)
         {
             long_ptr =
-                (int32_t *) (((int32_t) statement_buffer) & 0xfffffffcL);
+                (int32_t *) (((uintptr_t) statement_buffer) & ~(uintptr_t) 3);
         }
         else if (arg < JAMC_MAX_LITERAL_ARRAYS)
         {
@@ -947,7 +1453,7 @@ JAM_RETURN_TYPE urj_jam_convert_literal_array
         if (rev_index > 1)
         {
             long_ptr =
-                (int32_t *) (((int32_t) statement_buffer) & 0xfffffffcL);
+                (int32_t *) (((uintptr_t) statement_buffer) & ~(uintptr_t) 3);
         }
         else if (arg < JAMC_MAX_LITERAL_ARRAYS)
         {
@@ -1429,8 +1935,7 @@ JAM_RETURN_TYPE urj_jam_get_array_argument
 
                         if (status == JAMC_SUCCESS)
                         {
-                            heap_record = (JAMS_HEAP_RECORD *)
-                                tmp_symbol_rec->value;
+                            heap_record = tmp_symbol_rec->heap_record;
 
                             if (heap_record == NULL)
                             {
@@ -1552,6 +2057,7 @@ urj_jam_process_uses_item (char *block_name)
     JAMS_SYMBOL_RECORD *tmp_current_block = urj_jam_current_block;
     JAME_PHASE_TYPE tmp_phase = urj_jam_phase;
     BOOL done = false;
+    BOOL profiled = false;
     int exit_code = 0;
 
     statement_buffer = malloc (JAMC_MAX_STATEMENT_LENGTH + 1024);
@@ -1739,6 +2245,12 @@ urj_jam_process_uses_item (char *block_name)
             {
                 urj_jam_current_block = symbol_record;
                 urj_jam_phase = JAM_DATA_PHASE;
+
+                if (jam_profile_enabled)
+                {
+                    urj_jam_profile_call (symbol_record, true);
+                    profiled = true;
+                }
             }
 
             /*
@@ -1793,6 +2305,11 @@ urj_jam_process_uses_item (char *block_name)
         }
     }
 
+    if (profiled)
+    {
+        urj_jam_profile_call (symbol_record, false);
+    }
+
     urj_jam_current_block = tmp_current_block;
     urj_jam_phase = tmp_phase;
 
@@ -1900,6 +2417,7 @@ JAM_RETURN_TYPE urj_jam_call_procedure
     JAMS_HEAP_RECORD *heap_record = NULL;
     JAMS_SYMBOL_RECORD *tmp_current_block = urj_jam_current_block;
     JAME_PHASE_TYPE tmp_phase = urj_jam_phase;
+    BOOL profiled = false;
 
     statement_buffer = malloc (JAMC_MAX_STATEMENT_LENGTH + 1024);
 
@@ -2014,9 +2532,9 @@ JAM_RETURN_TYPE urj_jam_call_procedure
             }
         }
 
-        if ((status == JAMC_SUCCESS) && (symbol_record->value != 0L))
+        if ((status == JAMC_SUCCESS) && (symbol_record->heap_record != NULL))
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
             status = urj_jam_process_uses_list ((char *) heap_record->data);
         }
 
@@ -2054,6 +2572,12 @@ JAM_RETURN_TYPE urj_jam_call_procedure
     {
         urj_jam_current_block = symbol_record;
         urj_jam_phase = JAM_PROCEDURE_PHASE;
+
+        if (jam_profile_enabled)
+        {
+            urj_jam_profile_call (symbol_record, true);
+            profiled = true;
+        }
     }
 
     /*
@@ -2093,6 +2617,11 @@ JAM_RETURN_TYPE urj_jam_call_procedure
         }
     }
 
+    if (profiled)
+    {
+        urj_jam_profile_call (symbol_record, false);
+    }
+
     urj_jam_current_block = tmp_current_block;
     urj_jam_phase = tmp_phase;
 
@@ -2247,7 +2776,7 @@ JAM_RETURN_TYPE urj_jam_call_procedure_from_procedure
         if ((urj_jam_current_block != NULL) &&
             (urj_jam_current_block->type == JAM_PROCEDURE_BLOCK))
         {
-            heap_record = (JAMS_HEAP_RECORD *) urj_jam_current_block->value;
+            heap_record = urj_jam_current_block->heap_record;
 
             if (heap_record != NULL)
             {
@@ -2598,7 +3127,7 @@ urj_jam_process_boolean (char *statement_buffer)
              */
             if ((status == JAMC_SUCCESS) &&
                 (symbol_record->type == JAM_BOOLEAN_ARRAY_WRITABLE) &&
-                (symbol_record->value == 0))
+                (symbol_record->heap_record == NULL))
             {
                 if (statement_buffer[index] == JAMC_EQUAL_CHAR)
                 {
@@ -2612,7 +3141,7 @@ urj_jam_process_boolean (char *statement_buffer)
 
                     if (status == JAMC_SUCCESS)
                     {
-                        symbol_record->value = (int32_t) heap_record;
+                        symbol_record->heap_record = heap_record;
 
                         /*
                          *      Initialize heap data for array
@@ -2633,7 +3162,7 @@ urj_jam_process_boolean (char *statement_buffer)
 
                     if (status == JAMC_SUCCESS)
                     {
-                        symbol_record->value = (int32_t) heap_record;
+                        symbol_record->heap_record = heap_record;
                     }
                 }
             }
@@ -3047,10 +3576,13 @@ JAM_RETURN_TYPE urj_jam_process_drscan_compare
         {
             save_ch = statement_buffer[expr_end];
             statement_buffer[expr_end] = JAMC_NULL_CHAR;
+            /* the array is only written, pending captures into it can wait */
+            urj_jam_looking_up_capture = true;
             status = urj_jam_get_array_argument (&statement_buffer[expr_begin],
                                              &symbol_record,
                                              &literal_array_data,
                                              &start_index, &stop_index, 1);
+            urj_jam_looking_up_capture = false;
             statement_buffer[expr_end] = save_ch;
         }
 
@@ -3070,7 +3602,7 @@ JAM_RETURN_TYPE urj_jam_process_drscan_compare
         {
             if (symbol_record != NULL)
             {
-                heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+                heap_record = symbol_record->heap_record;
 
                 if (heap_record != NULL)
                 {
@@ -3092,7 +3624,7 @@ JAM_RETURN_TYPE urj_jam_process_drscan_compare
             if (statement_buffer[delimiter] == JAMC_SEMICOLON_CHAR)
             {
                 status = urj_jam_swap_dr (count_value, in_data, in_index,
-                                      tdi_data, start_index);
+                                      tdi_data, start_index, true);
                 return status;
             }
             else if (statement_buffer[delimiter] == JAMC_COMMA_CHAR)
@@ -3163,7 +3695,7 @@ JAM_RETURN_TYPE urj_jam_process_drscan_compare
     {
         if (symbol_record != NULL)
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
 
             if (heap_record != NULL)
             {
@@ -3232,7 +3764,7 @@ JAM_RETURN_TYPE urj_jam_process_drscan_compare
     {
         if (symbol_record != NULL)
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
 
             if (heap_record != NULL)
             {
@@ -3317,7 +3849,7 @@ JAM_RETURN_TYPE urj_jam_process_drscan_compare
     if (status == JAMC_SUCCESS)
     {
         status = urj_jam_swap_dr (count_value, in_data, in_index, temp_array,
-                              start_index);
+                              start_index, false);
     }
 
     /*
@@ -3400,9 +3932,12 @@ JAM_RETURN_TYPE urj_jam_process_drscan_capture
     {
         save_ch = statement_buffer[expr_end];
         statement_buffer[expr_end] = JAMC_NULL_CHAR;
+        /* the array is only written, pending captures into it can wait */
+        urj_jam_looking_up_capture = true;
         status = urj_jam_get_array_argument (&statement_buffer[expr_begin],
                                          &symbol_record, &literal_array_data,
                                          &start_index, &stop_index, 1);
+        urj_jam_looking_up_capture = false;
         statement_buffer[expr_end] = save_ch;
     }
 
@@ -3422,7 +3957,7 @@ JAM_RETURN_TYPE urj_jam_process_drscan_capture
     {
         if (symbol_record != NULL)
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
 
             if (heap_record != NULL)
             {
@@ -3445,7 +3980,7 @@ JAM_RETURN_TYPE urj_jam_process_drscan_capture
     if (status == JAMC_SUCCESS)
     {
         status = urj_jam_swap_dr (count_value, in_data, in_index,
-                              tdi_data, start_index);
+                              tdi_data, start_index, true);
     }
 
     return status;
@@ -3565,7 +4100,7 @@ urj_jam_process_drscan (char *statement_buffer)
     {
         if (symbol_record != NULL)
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
 
             if (heap_record != NULL)
             {
@@ -3926,8 +4461,8 @@ urj_jam_process_export (char *statement_buffer)
                                     (ba_symbol_record->type ==
                                      JAM_BOOLEAN_ARRAY_INITIALIZED))
                                 {
-                                    ba_heap_record = (JAMS_HEAP_RECORD *)
-                                        ba_symbol_record->value;
+                                    ba_heap_record =
+                                        ba_symbol_record->heap_record;
                                     if ((ba_start_index < 0L) ||
                                         (ba_start_index >=
                                          ba_heap_record->dimension)
@@ -4582,7 +5117,7 @@ urj_jam_process_integer (char *statement_buffer)
 
             if ((status == JAMC_SUCCESS) &&
                 (symbol_record->type == JAM_INTEGER_ARRAY_WRITABLE) &&
-                (symbol_record->value == 0))
+                (symbol_record->heap_record == NULL))
             {
                 if (statement_buffer[index] == JAMC_EQUAL_CHAR)
                 {
@@ -4594,7 +5129,7 @@ urj_jam_process_integer (char *statement_buffer)
 
                     if (status == JAMC_SUCCESS)
                     {
-                        symbol_record->value = (int32_t) heap_record;
+                        symbol_record->heap_record = heap_record;
 
                         status = urj_jam_read_integer_array_data (heap_record,
                                                               &statement_buffer
@@ -4612,7 +5147,7 @@ urj_jam_process_integer (char *statement_buffer)
 
                     if (status == JAMC_SUCCESS)
                     {
-                        symbol_record->value = (int32_t) heap_record;
+                        symbol_record->heap_record = heap_record;
                     }
                 }
             }
@@ -4775,7 +5310,7 @@ JAM_RETURN_TYPE urj_jam_process_irscan_compare
     {
         if (symbol_record != NULL)
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
 
             if (heap_record != NULL)
             {
@@ -4844,7 +5379,7 @@ JAM_RETURN_TYPE urj_jam_process_irscan_compare
     {
         if (symbol_record != NULL)
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
 
             if (heap_record != NULL)
             {
@@ -4920,7 +5455,8 @@ JAM_RETURN_TYPE urj_jam_process_irscan_compare
      */
     if (status == JAMC_SUCCESS)
     {
-        status = urj_jam_swap_ir (count_value, in_data, in_index, temp_array, 0);
+        status = urj_jam_swap_ir (count_value, in_data, in_index, temp_array, 0,
+                              false);
     }
 
     /*
@@ -4999,9 +5535,12 @@ JAM_RETURN_TYPE urj_jam_process_irscan_capture
     {
         save_ch = statement_buffer[expr_end];
         statement_buffer[expr_end] = JAMC_NULL_CHAR;
+        /* the array is only written, pending captures into it can wait */
+        urj_jam_looking_up_capture = true;
         status = urj_jam_get_array_argument (&statement_buffer[expr_begin],
                                          &symbol_record, &literal_array_data,
                                          &start_index, &stop_index, 1);
+        urj_jam_looking_up_capture = false;
         statement_buffer[expr_end] = save_ch;
     }
 
@@ -5021,7 +5560,7 @@ JAM_RETURN_TYPE urj_jam_process_irscan_capture
     {
         if (symbol_record != NULL)
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
 
             if (heap_record != NULL)
             {
@@ -5044,7 +5583,7 @@ JAM_RETURN_TYPE urj_jam_process_irscan_capture
     if (status == JAMC_SUCCESS)
     {
         status = urj_jam_swap_ir (count_value, in_data, in_index,
-                              tdi_data, start_index);
+                              tdi_data, start_index, true);
     }
 
     return status;
@@ -5164,7 +5703,7 @@ urj_jam_process_irscan (char *statement_buffer)
     {
         if (symbol_record != NULL)
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
 
             if (heap_record != NULL)
             {
@@ -5581,7 +6120,7 @@ urj_jam_process_assignment (char *statement_buffer, BOOL let)
                 /* get pointer to heap record */
                 if (status == JAMC_SUCCESS)
                 {
-                    heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+                    heap_record = symbol_record->heap_record;
 
                     if (heap_record == NULL)
                     {
@@ -5744,8 +6283,7 @@ urj_jam_process_assignment (char *statement_buffer, BOOL let)
                                     (symbol_record->type ==
                                      JAM_BOOLEAN_ARRAY_INITIALIZED))
                                 {
-                                    heap_record = (JAMS_HEAP_RECORD *)
-                                        symbol_record->value;
+                                    heap_record = symbol_record->heap_record;
 
                                     /* check array bounds */
                                     if ((source_subrange_begin < 0L) ||
@@ -6260,7 +6798,7 @@ urj_jam_process_pop (char *statement_buffer)
                 /* get pointer to heap record */
                 if (status == JAMC_SUCCESS)
                 {
-                    heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+                    heap_record = symbol_record->heap_record;
 
                     if (heap_record == NULL)
                     {
@@ -6521,8 +7059,7 @@ JAM_RETURN_TYPE urj_jam_process_pre_post
                 {
                     if (symbol_record != NULL)
                     {
-                        heap_record =
-                            (JAMS_HEAP_RECORD *) symbol_record->value;
+                        heap_record = symbol_record->heap_record;
 
                         if (heap_record != NULL)
                         {
@@ -6923,7 +7460,7 @@ urj_jam_process_procedure (char *statement_buffer)
                     ++index;    /* skip over white space */
                 }
 
-                if (symbol_record->value == 0)
+                if (symbol_record->heap_record == NULL)
                 {
                     status = urj_jam_add_heap_record (symbol_record, &heap_record,
                                                   strlen
@@ -6932,14 +7469,14 @@ urj_jam_process_procedure (char *statement_buffer)
 
                     if (status == JAMC_SUCCESS)
                     {
-                        symbol_record->value = (int32_t) heap_record;
+                        symbol_record->heap_record = heap_record;
                         strcpy ((char *) heap_record->data,
                                     &statement_buffer[index]);
                     }
                 }
                 else
                 {
-                    heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+                    heap_record = symbol_record->heap_record;
                 }
 
                 /*
@@ -7356,7 +7893,7 @@ JAM_RETURN_TYPE urj_jam_process_vector_capture
     {
         if (symbol_record != NULL)
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
 
             if (!heap_record)
                 status = JAMC_INTERNAL_ERROR;
@@ -7464,7 +8001,7 @@ JAM_RETURN_TYPE urj_jam_process_vector_compare
     {
         if (symbol_record != NULL)
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
 
             if (heap_record != NULL)
             {
@@ -7533,7 +8070,7 @@ JAM_RETURN_TYPE urj_jam_process_vector_compare
     {
         if (symbol_record != NULL)
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
 
             if (heap_record != NULL)
             {
@@ -7715,7 +8252,7 @@ urj_jam_process_vector (char *statement_buffer)
     {
         if (symbol_record != NULL)
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
 
             if (heap_record != NULL)
             {
@@ -7772,7 +8309,7 @@ urj_jam_process_vector (char *statement_buffer)
     {
         if (symbol_record != NULL)
         {
-            heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+            heap_record = symbol_record->heap_record;
 
             if (heap_record != NULL)
             {
@@ -8249,6 +8786,12 @@ JAM_RETURN_TYPE urj_jam_execute_statement
 {
     JAME_INSTRUCTION instruction_code = JAM_ILLEGAL_INSTR;
     JAM_RETURN_TYPE status = JAMC_SUCCESS;
+    JAMS_PROFILE_RECORD *outer_profile_record = NULL;
+
+    if (jam_profile_enabled)
+    {
+        outer_profile_record = urj_jam_profile_enter_statement ();
+    }
 
     instruction_code = urj_jam_get_instruction (statement_buffer);
 
@@ -8417,6 +8960,11 @@ JAM_RETURN_TYPE urj_jam_execute_statement
 
     urj_jam_free_literal_aca_buffers ();
 
+    if (jam_profile_enabled)
+    {
+        urj_jam_profile_leave_statement (outer_profile_record);
+    }
+
     return status;
 }
 
@@ -8461,8 +9009,6 @@ urj_jam_get_line_of_position (int32_t position)
 JAM_RETURN_TYPE urj_jam_execute
     (char *program,
      int32_t program_size,
-     char *workspace,
-     int32_t workspace_size,
      char *action,
      char **init_list,
      int reset_jtag,
@@ -8487,8 +9033,6 @@ JAM_RETURN_TYPE urj_jam_execute
 
     urj_jam_program = program;
     urj_jam_program_size = program_size;
-    urj_jam_workspace = workspace;
-    urj_jam_workspace_size = workspace_size;
     urj_jam_action = action;
     urj_jam_init_list = init_list;
 
@@ -8499,22 +9043,17 @@ JAM_RETURN_TYPE urj_jam_execute
     urj_jam_version = 0;
     urj_jam_phase = JAM_UNKNOWN_PHASE;
     urj_jam_current_block = NULL;
+    jam_statement_frontier = 0L;
+    jam_profile_current = NULL;
+    jam_profile_statement_count = 0L;
+    jam_profile_mark = jam_profile_enabled ? urj_jam_profile_clock () : 0.0;
+    jam_profile_bit_mark = 0;
 
     for (i = 0; i < JAMC_MAX_LITERAL_ARRAYS; ++i)
     {
         urj_jam_literal_aca_buffer[i] = NULL;
     }
 
-    /*
-     *      Ensure that workspace is DWORD aligned
-     */
-    if (urj_jam_workspace != NULL)
-    {
-        urj_jam_workspace_size -= (((int32_t) urj_jam_workspace) & 3L);
-        urj_jam_workspace_size &= (~3L);
-        urj_jam_workspace = (char *) (((int32_t) urj_jam_workspace + 3L) & (~3L));
-    }
-
     /*
      *      Initialize symbol table and stack
      */
@@ -8586,6 +9125,14 @@ JAM_RETURN_TYPE urj_jam_execute
             urj_jam_get_line_of_position (urj_jam_current_statement_position);
     }
 
+    if (jam_profile_enabled)
+    {
+        urj_jam_profile_report ();
+    }
+
+    urj_jam_free_profile ();
+    urj_jam_free_statement_cache ();
+    urj_jam_free_expression_cache ();
     urj_jam_free_literal_aca_buffers ();
     urj_jam_free_jtag_padding_buffers (reset_jtag);
     urj_jam_free_heap ();
@@ -19,11 +19,11 @@
 /*                                                                          */
 /****************************************************************************/
 
-extern int32_t urj_jam_current_file_position;
+extern JAM_THREAD_LOCAL int32_t urj_jam_current_file_position;
 
-extern int32_t urj_jam_current_statement_position;
+extern JAM_THREAD_LOCAL int32_t urj_jam_current_statement_position;
 
-extern int32_t urj_jam_next_statement_position;
+extern JAM_THREAD_LOCAL int32_t urj_jam_next_statement_position;
 
 /* prototype for external function in jamarray.c */
 extern int urj_jam_6bit_char (int ch);
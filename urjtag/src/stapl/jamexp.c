@@ -126,15 +126,16 @@ struct
     {"FLOOR", 5, FLOOR_TOK}
 };
 
-char urj_jam_ch = '\0';             /* next character from input file */
-int urj_jam_strptr = 0;
-int urj_jam_token = 0;
-char urj_jam_token_buffer[MAX_BUFFER_LENGTH];
-int urj_jam_token_buffer_index;
-char urj_jam_parse_string[MAX_BUFFER_LENGTH];
-int32_t urj_jam_parse_value = 0;
-int urj_jam_expression_type = 0;
-JAMS_SYMBOL_RECORD *urj_jam_array_symbol_rec = NULL;
+/* next character from input file */
+JAM_THREAD_LOCAL char urj_jam_ch = '\0';
+JAM_THREAD_LOCAL int urj_jam_strptr = 0;
+JAM_THREAD_LOCAL int urj_jam_token = 0;
+JAM_THREAD_LOCAL char urj_jam_token_buffer[MAX_BUFFER_LENGTH];
+JAM_THREAD_LOCAL int urj_jam_token_buffer_index;
+JAM_THREAD_LOCAL char urj_jam_parse_string[MAX_BUFFER_LENGTH];
+JAM_THREAD_LOCAL int32_t urj_jam_parse_value = 0;
+JAM_THREAD_LOCAL int urj_jam_expression_type = 0;
+JAM_THREAD_LOCAL JAMS_SYMBOL_RECORD *urj_jam_array_symbol_rec = NULL;
 
 #define YYMAXDEPTH 300          /* This fixes a stack depth problem on  */
                         /* all platforms.                       */
@@ -189,19 +190,69 @@ typedef struct EXP_STACK
     int32_t val;
     int32_t loper;              /* left and right operands for DIV */
     int32_t roper;              /* we save it for CEIL/FLOOR's use */
+    JAMS_SYMBOL_RECORD *symbol_rec;     /* for JAM_ARRAY_REFERENCE */
 } EXPN_STACK;
 
 #define YYSTYPE EXPN_STACK      /* must be a #define for yacc */
 
-YYSTYPE urj_jam_null_expression = { 0, 0, 0, 0, 0 };
+YYSTYPE urj_jam_null_expression = { 0, 0, 0, 0, 0, NULL };
 
-JAM_RETURN_TYPE urj_jam_return_code = JAMC_SUCCESS;
+JAM_THREAD_LOCAL JAM_RETURN_TYPE urj_jam_return_code = JAMC_SUCCESS;
 
-JAME_EXPRESSION_TYPE urj_jam_expr_type = JAM_ILLEGAL_EXPR_TYPE;
+JAM_THREAD_LOCAL JAME_EXPRESSION_TYPE urj_jam_expr_type = JAM_ILLEGAL_EXPR_TYPE;
 
 #define NULL_EXP urj_jam_null_expression    /* .. for 1 operand operators */
 
-#define CALC(operator, lval, rval) urj_jam_exp_eval((operator), (lval), (rval))
+#define CALC(operator, lval, rval) urj_jam_exp_calc((operator), (lval), (rval))
+
+/*
+ *  Expression cache.  The first evaluation of an expression records the
+ *  values and operators in the order the parser reduces them, with the
+ *  symbols already looked up.  Evaluating the same text in the same block
+ *  again replays the recorded steps on a value stack instead of running
+ *  the lexer and parser, which matters for expressions inside loops.
+ */
+#define JAMC_MAX_EXPRESSION_STEPS 256
+#define JAMC_EXPRESSION_CACHE_SIZE 256  /* number of hash buckets */
+#define JAMC_MAX_CACHED_EXPRESSIONS 1024
+
+typedef enum
+{
+    JAM_STEP_VALUE,             /* constant */
+    JAM_STEP_INTEGER,           /* integer variable */
+    JAM_STEP_BOOLEAN,           /* Boolean variable */
+    JAM_STEP_ARRAY,             /* array reference */
+    JAM_STEP_OPERATOR
+} JAME_STEP_TYPE;
+
+typedef struct JAMS_EXPRESSION_STEP
+{
+    JAME_STEP_TYPE step_type;
+    OPERATOR_TYPE otype;
+    int operands;               /* values taken from the stack by otype */
+    JAME_EXPRESSION_TYPE type;
+    int32_t val;
+    JAMS_SYMBOL_RECORD *symbol_rec;
+} JAMS_EXPRESSION_STEP;
+
+typedef struct JAMS_EXPRESSION_CACHE
+{
+    struct JAMS_EXPRESSION_CACHE *next;
+    JAMS_SYMBOL_RECORD *block;  /* urj_jam_current_block when parsed */
+    int expression_type;        /* urj_jam_expression_type after parsing */
+    int step_count;
+    JAMS_EXPRESSION_STEP *step;
+    char *expression;
+} JAMS_EXPRESSION_CACHE;
+
+static JAM_THREAD_LOCAL JAMS_EXPRESSION_CACHE
+    *jam_expression_cache[JAMC_EXPRESSION_CACHE_SIZE];
+static JAM_THREAD_LOCAL int jam_expression_cache_count = 0;
+
+/* steps of the expression being parsed, jam_record_count is -1 if none */
+static JAM_THREAD_LOCAL JAMS_EXPRESSION_STEP
+    jam_record_step[JAMC_MAX_EXPRESSION_STEPS];
+static JAM_THREAD_LOCAL int jam_record_count = -1;
 
 /* --- FUNCTION PROTOTYPES -------------------------------------------- */
 
@@ -234,7 +285,7 @@ int urj_jam_yylex (void);
 #ifndef YYSTYPE
 #define YYSTYPE int
 #endif
-YYSTYPE urj_jam_yylval, urj_jam_yyval;
+JAM_THREAD_LOCAL YYSTYPE urj_jam_yylval, urj_jam_yyval;
 #define YYERRCODE 256
 
 /* # line 333 "jamexp.y" */
@@ -242,6 +293,8 @@ YYSTYPE urj_jam_yylval, urj_jam_yyval;
 
 int32_t urj_jam_convert_bool_to_int (int32_t *data, int32_t msb, int32_t lsb);
 EXPN_STACK urj_jam_exp_eval (OPERATOR_TYPE otype, EXPN_STACK op1, EXPN_STACK op2);
+static EXPN_STACK urj_jam_exp_calc (OPERATOR_TYPE otype, EXPN_STACK op1,
+                                    EXPN_STACK op2);
 void urj_jam_exp_lexer (void);
 bool urj_jam_constant_is_ok (const char *string);
 bool urj_jam_binary_constant_is_ok (const char *string);
@@ -344,6 +397,7 @@ urj_jam_exp_eval (OPERATOR_TYPE otype, YYSTYPE op1, YYSTYPE op2)
     rtn.val = 0;
     rtn.loper = 0;
     rtn.roper = 0;
+    rtn.symbol_rec = NULL;
 
     switch (otype)
     {
@@ -804,7 +858,7 @@ urj_jam_exp_eval (OPERATOR_TYPE otype, YYSTYPE op1, YYSTYPE op2)
             ((op2.type == JAM_INTEGER_EXPR)
              || (op2.type == JAM_INT_OR_BOOL_EXPR)))
         {
-            symbol_rec = (JAMS_SYMBOL_RECORD *) op1.val;
+            symbol_rec = op1.symbol_rec;
             urj_jam_return_code =
                 urj_jam_get_array_value (symbol_rec, op2.val, &rtn.val);
 
@@ -854,7 +908,7 @@ urj_jam_exp_eval (OPERATOR_TYPE otype, YYSTYPE op1, YYSTYPE op2)
                 ((symbol_rec->type == JAM_BOOLEAN_ARRAY_WRITABLE) ||
                  (symbol_rec->type == JAM_BOOLEAN_ARRAY_INITIALIZED)))
             {
-                heap_rec = (JAMS_HEAP_RECORD *) symbol_rec->value;
+                heap_rec = symbol_rec->heap_record;
 
                 if (heap_rec != NULL)
                 {
@@ -873,13 +927,13 @@ urj_jam_exp_eval (OPERATOR_TYPE otype, YYSTYPE op1, YYSTYPE op2)
     case ARRAY_ALL:
         if (op1.type == JAM_ARRAY_REFERENCE)
         {
-            symbol_rec = (JAMS_SYMBOL_RECORD *) op1.val;
+            symbol_rec = op1.symbol_rec;
 
             if ((symbol_rec != NULL) &&
                 ((symbol_rec->type == JAM_BOOLEAN_ARRAY_WRITABLE) ||
                  (symbol_rec->type == JAM_BOOLEAN_ARRAY_INITIALIZED)))
             {
-                heap_rec = (JAMS_HEAP_RECORD *) symbol_rec->value;
+                heap_rec = symbol_rec->heap_record;
 
                 if (heap_rec != NULL)
                 {
@@ -1184,6 +1238,8 @@ urj_jam_yyerror (char *msg)
 
     if (urj_jam_return_code == JAMC_SUCCESS)
         urj_jam_return_code = JAMC_SYNTAX_ERROR;
+
+    jam_record_count = -1;
 }
 
 
@@ -1269,9 +1325,8 @@ urj_jam_yylex (void)
             case JAM_INTEGER_ARRAY_INITIALIZED:
             case JAM_BOOLEAN_ARRAY_INITIALIZED:
                 /* Success, swap token to be an ARRAY_TOK, */
-                /* save pointer to symbol record in value field */
+                /* save pointer to symbol record in symbol_rec field */
                 urj_jam_token = ARRAY_TOK;
-                val = (int32_t) symbol_rec;
                 type = JAM_ARRAY_REFERENCE;
                 urj_jam_array_symbol_rec = symbol_rec;
                 break;
@@ -1296,9 +1351,305 @@ urj_jam_yylex (void)
     urj_jam_yylval.child_otype = 0;
     urj_jam_yylval.loper = 0;
     urj_jam_yylval.roper = 0;
+    urj_jam_yylval.symbol_rec =
+        (urj_jam_token == ARRAY_TOK) ? symbol_rec : NULL;
+
+    if (urj_jam_return_code != JAMC_SUCCESS)
+    {
+        jam_record_count = -1;
+    }
+    else if ((jam_record_count >= 0) &&
+             ((urj_jam_token == VALUE_TOK) || (urj_jam_token == ARRAY_TOK)))
+    {
+        if (jam_record_count < JAMC_MAX_EXPRESSION_STEPS)
+        {
+            JAMS_EXPRESSION_STEP *step = &jam_record_step[jam_record_count++];
+
+            if (symbol_rec == NULL)
+            {
+                step->step_type = JAM_STEP_VALUE;
+            }
+            else if (urj_jam_token == ARRAY_TOK)
+            {
+                step->step_type = JAM_STEP_ARRAY;
+            }
+            else if (type == JAM_BOOLEAN_EXPR)
+            {
+                step->step_type = JAM_STEP_BOOLEAN;
+            }
+            else
+            {
+                step->step_type = JAM_STEP_INTEGER;
+            }
+            step->val = val;
+            step->type = type;
+            step->symbol_rec = symbol_rec;
+        }
+        else
+        {
+            /* too long to be cached */
+            jam_record_count = -1;
+        }
+    }
 
     return urj_jam_token;
 }
+
+
+/************************************************************************/
+/*                                                                      */
+
+static EXPN_STACK
+urj_jam_exp_calc (OPERATOR_TYPE otype, EXPN_STACK op1, EXPN_STACK op2)
+/*                                                                      */
+/*  Reduce action of the parser: records the operator if the            */
+/*  expression is being recorded for the cache, then evaluates it.      */
+/*                                                                      */
+{
+    EXPN_STACK rtn;
+
+    if (jam_record_count >= JAMC_MAX_EXPRESSION_STEPS)
+    {
+        jam_record_count = -1;
+    }
+    else if (jam_record_count >= 0)
+    {
+        JAMS_EXPRESSION_STEP *step = &jam_record_step[jam_record_count++];
+
+        step->step_type = JAM_STEP_OPERATOR;
+        step->otype = otype;
+        step->symbol_rec = NULL;
+
+        switch (otype)
+        {
+        case ARRAY_RANGE:
+            /* array reference, msb and lsb */
+            step->operands = 3;
+            break;
+
+        case UMINUS:
+        case NOT:
+        case BITWISE_NOT:
+        case ABS:
+        case INT:
+        case LOG2:
+        case SQRT:
+        case CIEL:
+        case FLOOR:
+        case POUND:
+        case DOLLAR:
+        case ARRAY_ALL:
+            step->operands = 1;
+            break;
+
+        default:
+            step->operands = 2;
+            break;
+        }
+    }
+
+    rtn = urj_jam_exp_eval (otype, op1, op2);
+
+    if (urj_jam_return_code != JAMC_SUCCESS)
+    {
+        jam_record_count = -1;
+    }
+
+    return rtn;
+}
+
+
+/************************************************************************/
+/*                                                                      */
+
+static unsigned int
+urj_jam_expression_hash (const char *expression)
+{
+    unsigned int hash = 0;
+
+    while (*expression != JAMC_NULL_CHAR)
+    {
+        hash = (hash * 31) + (unsigned char) *expression++;
+    }
+
+    return hash % JAMC_EXPRESSION_CACHE_SIZE;
+}
+
+
+/************************************************************************/
+/*                                                                      */
+
+void
+urj_jam_free_expression_cache (void)
+/*                                                                      */
+/*  Frees all cached expressions.  The cache refers to symbol records,  */
+/*  it must be freed together with the symbol table.                    */
+/*                                                                      */
+{
+    JAMS_EXPRESSION_CACHE *cache = NULL;
+    int i;
+
+    for (i = 0; i < JAMC_EXPRESSION_CACHE_SIZE; ++i)
+    {
+        while (jam_expression_cache[i] != NULL)
+        {
+            cache = jam_expression_cache[i];
+            jam_expression_cache[i] = cache->next;
+            free (cache);
+        }
+    }
+
+    jam_expression_cache_count = 0;
+}
+
+
+/************************************************************************/
+/*                                                                      */
+
+static void
+urj_jam_cache_expression (const char *expression)
+/*                                                                      */
+/*  Saves the steps recorded while parsing the expression.  When the    */
+/*  cache is full it is emptied, so that the expressions used by the    */
+/*  part of the program running now are cached.                         */
+/*                                                                      */
+{
+    JAMS_EXPRESSION_CACHE *cache = NULL;
+    unsigned int hash = urj_jam_expression_hash (expression);
+    size_t step_size = jam_record_count * sizeof (JAMS_EXPRESSION_STEP);
+
+    if (jam_expression_cache_count >= JAMC_MAX_CACHED_EXPRESSIONS)
+    {
+        urj_jam_free_expression_cache ();
+    }
+
+    cache = malloc (sizeof (JAMS_EXPRESSION_CACHE) + step_size +
+                    strlen (expression) + 1);
+
+    if (cache != NULL)
+    {
+        cache->block = urj_jam_current_block;
+        cache->expression_type = urj_jam_expression_type;
+        cache->step_count = jam_record_count;
+        cache->step = (JAMS_EXPRESSION_STEP *) &cache[1];
+        memcpy (cache->step, jam_record_step, step_size);
+        cache->expression = (char *) cache->step + step_size;
+        strcpy (cache->expression, expression);
+
+        cache->next = jam_expression_cache[hash];
+        jam_expression_cache[hash] = cache;
+        ++jam_expression_cache_count;
+    }
+}
+
+
+/************************************************************************/
+/*                                                                      */
+
+static JAMS_EXPRESSION_CACHE *
+urj_jam_find_expression (const char *expression)
+{
+    JAMS_EXPRESSION_CACHE *cache =
+        jam_expression_cache[urj_jam_expression_hash (expression)];
+
+    while ((cache != NULL) &&
+           ((cache->block != urj_jam_current_block) ||
+            (strcmp (cache->expression, expression) != 0)))
+    {
+        cache = cache->next;
+    }
+
+    return cache;
+}
+
+
+/************************************************************************/
+/*                                                                      */
+
+static void
+urj_jam_replay_expression (const JAMS_EXPRESSION_CACHE *cache)
+/*                                                                      */
+/*  Evaluates a cached expression.  Variables are read when the steps   */
+/*  are replayed, operators are evaluated by urj_jam_exp_eval() in the  */
+/*  same order as the parser would reduce them.                         */
+/*                                                                      */
+{
+    EXPN_STACK stack[JAMC_MAX_EXPRESSION_STEPS];
+    const JAMS_EXPRESSION_STEP *step = NULL;
+    JAM_RETURN_TYPE status = JAMC_SUCCESS;
+    int depth = 0;
+    int i;
+
+    for (i = 0; i < cache->step_count; ++i)
+    {
+        step = &cache->step[i];
+
+        if (step->step_type == JAM_STEP_OPERATOR)
+        {
+            depth -= step->operands;
+
+            if (step->operands == 3)
+            {
+                stack[depth] = urj_jam_exp_eval (step->otype,
+                                                 stack[depth + 1],
+                                                 stack[depth + 2]);
+            }
+            else if (step->operands == 2)
+            {
+                stack[depth] = urj_jam_exp_eval (step->otype, stack[depth],
+                                                 stack[depth + 1]);
+            }
+            else
+            {
+                stack[depth] = urj_jam_exp_eval (step->otype, stack[depth],
+                                                 NULL_EXP);
+            }
+        }
+        else
+        {
+            stack[depth] = NULL_EXP;
+            stack[depth].type = step->type;
+
+            switch (step->step_type)
+            {
+            case JAM_STEP_INTEGER:
+                stack[depth].val = step->symbol_rec->value;
+                break;
+
+            case JAM_STEP_BOOLEAN:
+                stack[depth].val = step->symbol_rec->value ? 1 : 0;
+                break;
+
+            case JAM_STEP_ARRAY:
+                stack[depth].symbol_rec = step->symbol_rec;
+                urj_jam_array_symbol_rec = step->symbol_rec;
+
+                /* the array may have been declared again since */
+                if (step->symbol_rec->heap_record != NULL)
+                {
+                    status = urj_jam_load_boolean_array_data
+                        (step->symbol_rec->heap_record);
+
+                    if (status != JAMC_SUCCESS)
+                    {
+                        urj_jam_return_code = status;
+                    }
+                }
+                break;
+
+            default:
+                stack[depth].val = step->val;
+                break;
+            }
+        }
+
+        ++depth;
+    }
+
+    urj_jam_parse_value = stack[0].val;
+    urj_jam_expr_type = stack[0].type;
+    urj_jam_expression_type = cache->expression_type;
+}
 
 
 /************************************************************************/
@@ -1326,12 +1677,39 @@ JAM_RETURN_TYPE urj_jam_evaluate_expression
 /*        return 0.                                                     */
 /*                                                                      */
 {
-    strcpy (urj_jam_parse_string, expression);
-    urj_jam_strptr = 0;
-    urj_jam_token_buffer_index = 0;
+    JAMS_EXPRESSION_CACHE *cache = NULL;
+
     urj_jam_return_code = JAMC_SUCCESS;
 
-    urj_jam_yyparse ();
+    /* a pending '#' or '$' changes how the first constant is read */
+    if ((urj_jam_expression_type == 0) && !urj_jam_checking_uses_list)
+    {
+        cache = urj_jam_find_expression (expression);
+
+        if (cache == NULL)
+        {
+            jam_record_count = 0;
+        }
+    }
+
+    if (cache != NULL)
+    {
+        urj_jam_replay_expression (cache);
+    }
+    else
+    {
+        strcpy (urj_jam_parse_string, expression);
+        urj_jam_strptr = 0;
+        urj_jam_token_buffer_index = 0;
+
+        if ((urj_jam_yyparse () == 0) && (jam_record_count > 0) &&
+            (urj_jam_return_code == JAMC_SUCCESS))
+        {
+            urj_jam_cache_expression (expression);
+        }
+
+        jam_record_count = -1;
+    }
 
     if (urj_jam_return_code == JAMC_SUCCESS)
     {
@@ -1529,10 +1907,10 @@ static const int jam_yydef[] = {
 #define YYACCEPT return(0)
 #define YYABORT return(1)
 
-static YYSTYPE jam_yyv[YYMAXDEPTH];
-static int token = -1;                 /* input token */
-static int errct = 0;                  /* error count */
-static int errfl = 0;                  /* error flag */
+static JAM_THREAD_LOCAL YYSTYPE jam_yyv[YYMAXDEPTH];
+static JAM_THREAD_LOCAL int token = -1;        /* input token */
+static JAM_THREAD_LOCAL int errct = 0;         /* error count */
+static JAM_THREAD_LOCAL int errfl = 0;         /* error flag */
 
 int
 urj_jam_yyparse (void)
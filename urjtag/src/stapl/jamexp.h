@@ -16,4 +16,6 @@
 JAM_RETURN_TYPE urj_jam_evaluate_expression
     (char *expression, int32_t *result, JAME_EXPRESSION_TYPE *result_type);
 
+void urj_jam_free_expression_cache (void);
+
 #endif /* INC_JAMEXP_H */
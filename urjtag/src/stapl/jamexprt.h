@@ -25,6 +25,24 @@
 #include <ctype.h>
 #include <string.h>
 
+/****************************************************************************/
+/*                                                                          */
+/*  The state of the interpreter is kept in variables local to the thread   */
+/*  which calls urj_jam_execute(), so that programs can be played on        */
+/*  different chains by several threads at the same time.  Messages and     */
+/*  errors still go through the global log and error state of the library,  */
+/*  see urj_stapl_run().                                                    */
+/*                                                                          */
+/****************************************************************************/
+
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#define JAM_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define JAM_THREAD_LOCAL __thread
+#else
+#error "the STAPL player needs thread-local storage (_Thread_local or __thread)"
+#endif
+
 /****************************************************************************/
 /*                                                                          */
 /*  Return codes from most JAM functions                                    */
@@ -68,8 +86,6 @@
 JAM_RETURN_TYPE urj_jam_execute
     (char *program,
      int32_t program_size,
-     char *workspace,
-     int32_t workspace_size,
      char *action,
      char **init_list,
      int reset_jtag,
@@ -91,11 +107,20 @@ int urj_jam_seek (int32_t offset);
 
 int urj_jam_jtag_io (int tms, int tdi, int read_tdo);
 
+void urj_jam_jtag_io_tms (int count, unsigned int tms);
+void urj_jam_jtag_io_run (int tms, int32_t count);
+
 void urj_jam_message (const char *message_text);
 
 void urj_jam_export_integer (const char *key, int32_t value);
 
 void urj_jam_export_boolean_array (char *key, unsigned char *data, int32_t count);
+void urj_jam_set_profile (int enable);
+double urj_jam_profile_clock (void);
+void urj_jam_export_profile
+    (const char *block,
+     int32_t line, int32_t count, double seconds, double self_seconds,
+     int64_t bits);
 
 int jam_vector_map (int signal_count, char **signals);
 
@@ -26,78 +26,147 @@
 /*                                                                          */
 /****************************************************************************/
 
-JAMS_HEAP_RECORD *urj_jam_heap = NULL;
-
-void *urj_jam_heap_top = NULL;
+JAM_THREAD_LOCAL JAMS_HEAP_RECORD *urj_jam_heap = NULL;
+
+/*
+ *  Heap records and temporary buffers come from a size-classed pool.
+ *  Blocks of 2^n bytes are put on a free list for their class when they
+ *  are released and handed out again without calling malloc(), so that
+ *  arrays of procedures and the buffers of each scan are recycled.
+ *  Larger blocks are allocated and freed directly.
+ */
+#define JAMC_POOL_MIN_SHIFT 5   /* smallest block: 32 bytes */
+#define JAMC_POOL_CLASSES 16    /* largest pooled block: 1 MByte */
+
+typedef union JAMS_POOL_BLOCK
+{
+    union JAMS_POOL_BLOCK *next_free;   /* while on a free list */
+    int size_class;             /* while in use */
+    int64_t align;
+} JAMS_POOL_BLOCK;
 
-int32_t urj_jam_heap_records = 0L;
+static JAM_THREAD_LOCAL JAMS_POOL_BLOCK
+    *urj_jam_pool_free_list[JAMC_POOL_CLASSES];
 
 /****************************************************************************/
 /*                                                                          */
 
-JAM_RETURN_TYPE
-urj_jam_init_heap (void)
+static void *
+urj_jam_pool_alloc (size_t size)
 /*                                                                          */
-/*  Description:    Initializes the heap area.  This is where all array     */
-/*                  data is stored.                                         */
+/*  Description:    Allocates a block of at least size bytes.               */
 /*                                                                          */
-/*  Returns:        JAMC_SUCCESS for success, or JAMC_OUT_OF_MEMORY if no   */
-/*                  memory was available for the heap.                      */
+/*  Returns:        pointer to memory, or NULL if memory not available      */
 /*                                                                          */
 /****************************************************************************/
 {
-    JAM_RETURN_TYPE status = JAMC_SUCCESS;
-    void **symbol_table = NULL;
-    JAMS_STACK_RECORD *stack = NULL;
-    int32_t *jtag_buffer = NULL;
+    JAMS_POOL_BLOCK *block = NULL;
+    size_t total = size + sizeof (JAMS_POOL_BLOCK);
+    int size_class = 0;
 
-    urj_jam_heap_records = 0L;
+    while ((size_class < JAMC_POOL_CLASSES) &&
+           (((size_t) 1 << (size_class + JAMC_POOL_MIN_SHIFT)) < total))
+    {
+        ++size_class;
+    }
 
-    if (urj_jam_workspace != NULL)
+    if (size_class < JAMC_POOL_CLASSES)
     {
-        symbol_table = (void **) urj_jam_workspace;
-        stack = (JAMS_STACK_RECORD *) & symbol_table[JAMC_MAX_SYMBOL_COUNT];
-        jtag_buffer = (int32_t *) & stack[JAMC_MAX_NESTING_DEPTH];
-        urj_jam_heap = (JAMS_HEAP_RECORD *)
-            (((char *) jtag_buffer) + JAMC_JTAG_BUFFER_SIZE);
-        urj_jam_heap_top = (void *) urj_jam_heap;
-
-        /*
-         *      Check that there is some memory available for the heap
-         */
-        if (((int32_t) urj_jam_heap) > (((int32_t) urj_jam_workspace_size) +
-                                    ((int32_t) urj_jam_workspace)))
+        block = urj_jam_pool_free_list[size_class];
+
+        if (block != NULL)
         {
-            status = JAMC_OUT_OF_MEMORY;
+            urj_jam_pool_free_list[size_class] = block->next_free;
+        }
+        else
+        {
+            block = malloc ((size_t) 1 << (size_class + JAMC_POOL_MIN_SHIFT));
         }
     }
     else
     {
-        /* initialize heap to empty list */
-        urj_jam_heap = NULL;
+        block = malloc (total);
     }
 
-    return status;
+    if (block == NULL)
+    {
+        return NULL;
+    }
+
+    block->size_class = size_class;
+
+    return &block[1];
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+static void
+urj_jam_pool_release (void *ptr)
+/*                                                                          */
+/*  Description:    Returns a block allocated by urj_jam_pool_alloc() to    */
+/*                  the free list of its size class.                        */
+/*                                                                          */
+/****************************************************************************/
+{
+    JAMS_POOL_BLOCK *block = (JAMS_POOL_BLOCK *) ptr - 1;
+    int size_class = block->size_class;
+
+    if (size_class < JAMC_POOL_CLASSES)
+    {
+        block->next_free = urj_jam_pool_free_list[size_class];
+        urj_jam_pool_free_list[size_class] = block;
+    }
+    else
+    {
+        free (block);
+    }
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+JAM_RETURN_TYPE
+urj_jam_init_heap (void)
+/*                                                                          */
+/*  Description:    Initializes the heap area.  This is where all array     */
+/*                  data is stored.                                         */
+/*                                                                          */
+/*  Returns:        JAMC_SUCCESS                                            */
+/*                                                                          */
+/****************************************************************************/
+{
+    int size_class;
+
+    /* initialize heap to empty list */
+    urj_jam_heap = NULL;
+
+    for (size_class = 0; size_class < JAMC_POOL_CLASSES; ++size_class)
+    {
+        urj_jam_pool_free_list[size_class] = NULL;
+    }
+
+    return JAMC_SUCCESS;
 }
 
 void
 urj_jam_free_heap (void)
 {
-    int record = 0;
-    JAMS_HEAP_RECORD *heap_ptr = NULL;
-    JAMS_HEAP_RECORD *tmp_heap_ptr = NULL;
+    JAMS_POOL_BLOCK *block = NULL;
+    int size_class;
+
+    while (urj_jam_heap != NULL)
+    {
+        urj_jam_free_heap_record (urj_jam_heap);
+    }
 
-    if ((urj_jam_heap != NULL) && (urj_jam_workspace == NULL))
+    for (size_class = 0; size_class < JAMC_POOL_CLASSES; ++size_class)
     {
-        heap_ptr = urj_jam_heap;
-        for (record = 0; record < urj_jam_heap_records; ++record)
+        while (urj_jam_pool_free_list[size_class] != NULL)
         {
-            if (heap_ptr != NULL)
-            {
-                tmp_heap_ptr = heap_ptr;
-                heap_ptr = heap_ptr->next;
-                free (tmp_heap_ptr);
-            }
+            block = urj_jam_pool_free_list[size_class];
+            urj_jam_pool_free_list[size_class] = block->next_free;
+            free (block);
         }
     }
 }
@@ -116,13 +185,16 @@ JAM_RETURN_TYPE urj_jam_add_heap_record
 /*                                                                          */
 /****************************************************************************/
 {
-    int count = 0;
-    int element = 0;
-    int32_t space_needed = 0L;
+    size_t space_needed = 0;
     BOOL cached = false;
     JAMS_HEAP_RECORD *heap_ptr = NULL;
     JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
+    if (dimension < 0L)
+    {
+        return JAMC_BOUNDS_ERROR;
+    }
+
     /*
      *      Compute space needed for array or cache buffer.  Initialized arrays
      *      will not be cached if their size is less than the cache buffer size.
@@ -130,35 +202,17 @@ JAM_RETURN_TYPE urj_jam_add_heap_record
     switch (symbol_record->type)
     {
     case JAM_INTEGER_ARRAY_WRITABLE:
-        space_needed = dimension * sizeof (int32_t);
-        break;
-
-    case JAM_BOOLEAN_ARRAY_WRITABLE:
-        space_needed = ((dimension >> 5) + ((dimension & 0x1f) ? 1 : 0)) *
-            sizeof (int32_t);
-        break;
-
     case JAM_INTEGER_ARRAY_INITIALIZED:
-        space_needed = dimension * sizeof (int32_t);
-/*      if (space_needed > JAMC_ARRAY_CACHE_SIZE)   */
-/*      {                                           */
-/*          space_needed = JAMC_ARRAY_CACHE_SIZE;   */
-/*          cached = true;                          */
-/*      }                                           */
+        space_needed = (size_t) dimension * sizeof (int32_t);
         break;
 
+    case JAM_BOOLEAN_ARRAY_WRITABLE:
     case JAM_BOOLEAN_ARRAY_INITIALIZED:
-        space_needed = ((dimension >> 5) + ((dimension & 0x1f) ? 1 : 0)) *
-            sizeof (int32_t);
-/*      if (space_needed > JAMC_ARRAY_CACHE_SIZE)   */
-/*      {                                           */
-/*          space_needed = JAMC_ARRAY_CACHE_SIZE;   */
-/*          cached = true;                          */
-/*      }                                           */
+        space_needed = (((size_t) dimension + 31) >> 5) * sizeof (int32_t);
         break;
 
     case JAM_PROCEDURE_BLOCK:
-        space_needed = ((dimension >> 2) + 1) * sizeof (int32_t);
+        space_needed = (((size_t) dimension >> 2) + 1) * sizeof (int32_t);
         break;
 
     default:
@@ -171,67 +225,36 @@ JAM_RETURN_TYPE urj_jam_add_heap_record
      */
     if (status == JAMC_SUCCESS)
     {
-        if (urj_jam_workspace != NULL)
-        {
-            heap_ptr = (JAMS_HEAP_RECORD *) urj_jam_heap_top;
+        heap_ptr = urj_jam_pool_alloc (sizeof (JAMS_HEAP_RECORD) +
+                                       space_needed);
 
-            urj_jam_heap_top = (void *) ((int32_t) heap_ptr +
-                                     (int32_t) sizeof (JAMS_HEAP_RECORD) +
-                                     space_needed);
-
-            if ((int32_t) urj_jam_heap_top > (int32_t) urj_jam_symbol_bottom)
-            {
-                status = JAMC_OUT_OF_MEMORY;
-            }
-        }
-        else
+        if (heap_ptr == NULL)
         {
-            heap_ptr = (JAMS_HEAP_RECORD *) malloc ((unsigned int)
-                                                        (sizeof
-                                                         (JAMS_HEAP_RECORD) +
-                                                         space_needed));
-
-            if (heap_ptr == NULL)
-            {
-                status = JAMC_OUT_OF_MEMORY;
-            }
-            else if (urj_jam_heap == NULL)
-            {
-                urj_jam_heap = heap_ptr;
-            }
+            status = JAMC_OUT_OF_MEMORY;
         }
     }
 
     /*
-     *      Add the new record to the heap
+     *      Add the new record to the beginning of the heap
      */
     if (status == JAMC_SUCCESS)
     {
         heap_ptr->symbol_record = symbol_record;
         heap_ptr->dimension = dimension;
         heap_ptr->cached = cached;
+        heap_ptr->deferred = false;
         heap_ptr->position = 0L;
 
-        if (urj_jam_workspace != NULL)
-        {
-            /* point next pointer to position of next block */
-            heap_ptr->next = (JAMS_HEAP_RECORD *) urj_jam_heap_top;
-        }
-        else
+        heap_ptr->prev = NULL;
+        heap_ptr->next = urj_jam_heap;
+        if (urj_jam_heap != NULL)
         {
-            /* add new heap block to beginning of list */
-            heap_ptr->next = urj_jam_heap;
-            urj_jam_heap = heap_ptr;
+            urj_jam_heap->prev = heap_ptr;
         }
+        urj_jam_heap = heap_ptr;
 
         /* initialize data area to zero */
-        count = (int) (space_needed / sizeof (int32_t));
-        for (element = 0; element < count; ++element)
-        {
-            heap_ptr->data[element] = 0L;
-        }
-
-        ++urj_jam_heap_records;
+        memset (heap_ptr->data, 0, space_needed);
 
         *heap_record = heap_ptr;
     }
@@ -242,32 +265,58 @@ JAM_RETURN_TYPE urj_jam_add_heap_record
 /****************************************************************************/
 /*                                                                          */
 
-void *
-urj_jam_get_temp_workspace (int32_t size)
+void
+urj_jam_free_heap_record (JAMS_HEAP_RECORD *heap_record)
 /*                                                                          */
-/*  Description:    Gets a pointer to the unused area of the heap for       */
-/*                  temporary use.  This area will be used for heap records */
-/*                  if urj_jam_add_heap_record() is called.                     */
+/*  Description:    Removes a heap record from the heap, e.g. when the      */
+/*                  array it belongs to is declared again.                  */
 /*                                                                          */
-/*  Returns:        pointer to memory, or NULL if memory not available      */
+/*  Returns:        Nothing                                                 */
 /*                                                                          */
 /****************************************************************************/
 {
-    void *temp_workspace = NULL;
+    /* a scan may still have to deliver its TDO into this array */
+    if (urj_jam_jtag_capture_pending (heap_record->data))
+    {
+        urj_jam_jtag_complete_captures ();
+    }
 
-    if (urj_jam_workspace != NULL)
+    if (heap_record->prev != NULL)
     {
-        if (((int32_t) urj_jam_heap_top) + size <= (int32_t) urj_jam_symbol_bottom)
-        {
-            temp_workspace = urj_jam_heap_top;
-        }
+        heap_record->prev->next = heap_record->next;
     }
     else
     {
-        temp_workspace = malloc ((unsigned int) size);
+        urj_jam_heap = heap_record->next;
+    }
+
+    if (heap_record->next != NULL)
+    {
+        heap_record->next->prev = heap_record->prev;
     }
 
-    return temp_workspace;
+    urj_jam_pool_release (heap_record);
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+void *
+urj_jam_get_temp_workspace (int32_t size)
+/*                                                                          */
+/*  Description:    Gets a buffer for temporary use, which must be freed    */
+/*                  by urj_jam_free_temp_workspace().                       */
+/*                                                                          */
+/*  Returns:        pointer to memory, or NULL if memory not available      */
+/*                                                                          */
+/****************************************************************************/
+{
+    if (size < 0L)
+    {
+        return NULL;
+    }
+
+    return urj_jam_pool_alloc ((size_t) size);
 }
 
 /****************************************************************************/
@@ -282,6 +331,8 @@ urj_jam_free_temp_workspace (void *ptr)
 /*                                                                          */
 /****************************************************************************/
 {
-    if (urj_jam_workspace == NULL)
-        free (ptr);
+    if (ptr != NULL)
+    {
+        urj_jam_pool_release (ptr);
+    }
 }
@@ -46,9 +46,11 @@ typedef enum
 typedef struct JAMS_HEAP_STRUCT
 {
     struct JAMS_HEAP_STRUCT *next;
+    struct JAMS_HEAP_STRUCT *prev;
     JAMS_SYMBOL_RECORD *symbol_record;
     JAME_BOOLEAN_REP rep;       /* data representation format */
     BOOL cached;                /* true if array data is cached */
+    BOOL deferred;              /* true until data is read from file */
     int32_t dimension;          /* number of elements in array */
     int32_t position;           /* position in file of initialization data */
     int32_t data[1];            /* first word of data (or cache buffer) */
@@ -61,9 +63,7 @@ typedef struct JAMS_HEAP_STRUCT
 /*                                                                          */
 /****************************************************************************/
 
-extern JAMS_HEAP_RECORD *urj_jam_heap;
-
-extern void *urj_jam_heap_top;
+extern JAM_THREAD_LOCAL JAMS_HEAP_RECORD *urj_jam_heap;
 
 /****************************************************************************/
 /*                                                                          */
@@ -79,6 +79,8 @@ JAM_RETURN_TYPE urj_jam_add_heap_record
     (JAMS_SYMBOL_RECORD *symbol_record,
      JAMS_HEAP_RECORD **heap_record, int32_t dimension);
 
+void urj_jam_free_heap_record (JAMS_HEAP_RECORD *heap_record);
+
 void *urj_jam_get_temp_workspace (int32_t size);
 
 void urj_jam_free_temp_workspace (void *ptr);
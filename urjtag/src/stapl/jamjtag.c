@@ -25,29 +25,59 @@
 /*
 *   Global variable to store the current JTAG state
 */
-JAME_JTAG_STATE urj_jam_jtag_state = JAM_ILLEGAL_JTAG_STATE;
+JAM_THREAD_LOCAL JAME_JTAG_STATE urj_jam_jtag_state = JAM_ILLEGAL_JTAG_STATE;
 
 /*
 *   Store current stop-state for DR and IR scan commands
 */
-JAME_JTAG_STATE urj_jam_drstop_state = IDLE;
-JAME_JTAG_STATE urj_jam_irstop_state = IDLE;
+JAM_THREAD_LOCAL JAME_JTAG_STATE urj_jam_drstop_state = IDLE;
+JAM_THREAD_LOCAL JAME_JTAG_STATE urj_jam_irstop_state = IDLE;
 
 /*
 *   Store current padding values
 */
-int urj_jam_dr_preamble = 0;
-int urj_jam_dr_postamble = 0;
-int urj_jam_ir_preamble = 0;
-int urj_jam_ir_postamble = 0;
-int urj_jam_dr_length = 0;
-int urj_jam_ir_length = 0;
-int32_t *urj_jam_dr_preamble_data = NULL;
-int32_t *urj_jam_dr_postamble_data = NULL;
-int32_t *urj_jam_ir_preamble_data = NULL;
-int32_t *urj_jam_ir_postamble_data = NULL;
-char *urj_jam_dr_buffer = NULL;
-char *urj_jam_ir_buffer = NULL;
+JAM_THREAD_LOCAL int urj_jam_dr_preamble = 0;
+JAM_THREAD_LOCAL int urj_jam_dr_postamble = 0;
+JAM_THREAD_LOCAL int urj_jam_ir_preamble = 0;
+JAM_THREAD_LOCAL int urj_jam_ir_postamble = 0;
+JAM_THREAD_LOCAL int urj_jam_dr_length = 0;
+JAM_THREAD_LOCAL int urj_jam_ir_length = 0;
+JAM_THREAD_LOCAL int32_t *urj_jam_dr_preamble_data = NULL;
+JAM_THREAD_LOCAL int32_t *urj_jam_dr_postamble_data = NULL;
+JAM_THREAD_LOCAL int32_t *urj_jam_ir_preamble_data = NULL;
+JAM_THREAD_LOCAL int32_t *urj_jam_ir_postamble_data = NULL;
+JAM_THREAD_LOCAL char *urj_jam_dr_buffer = NULL;
+JAM_THREAD_LOCAL char *urj_jam_ir_buffer = NULL;
+
+/*
+*   Number of bits shifted by IR and DR scans, for the execution profile
+*/
+JAM_THREAD_LOCAL int64_t urj_jam_scan_bit_count = 0;
+
+/*
+*   Scans which captured into an array that has not been referenced since.
+*   Their TDO stays in the cable queue, in this order, until one of the
+*   arrays is referenced or a scan has to read TDO at once.
+*/
+#define JAMC_MAX_PENDING_CAPTURES 64
+
+typedef struct JAMS_JTAG_CAPTURE
+{
+    struct JAMS_JTAG_CAPTURE *next;
+    int32_t *out_data;
+    int32_t out_index;
+    int32_t count;
+    int preamble;
+    int shift_count;
+    char buffer[1];             /* TDO of the whole scan */
+} JAMS_JTAG_CAPTURE;
+
+static JAM_THREAD_LOCAL JAMS_JTAG_CAPTURE *jam_capture_first = NULL;
+static JAM_THREAD_LOCAL JAMS_JTAG_CAPTURE *jam_capture_last = NULL;
+static JAM_THREAD_LOCAL int jam_capture_count = 0;
+
+/* set while the target of a CAPTURE is looked up, which does not read it */
+JAM_THREAD_LOCAL BOOL urj_jam_looking_up_capture = false;
 
 /*
 *   Table of JTAG state names
@@ -77,76 +107,99 @@ struct JAMS_JTAG_MAP
 };
 
 /*
-*   This structure shows, for each JTAG state, which state is reached after
-*   a single TCK clock cycle with TMS high or TMS low, respectively.  This
-*   describes all possible state transitions in the JTAG state machine.
+*   This table contains, for each pair of JTAG states, the TMS sequence which
+*   takes the JTAG state machine from the state given by the first index to
+*   the state given by the second index.  TMS for the first TCK cycle is in
+*   the least significant bit.  If both states are the same, a stable state
+*   loops for one cycle and other states are left as they are.  The whole
+*   sequence is clocked out by one call of urj_jam_jtag_io_tms().
 */
-struct JAMS_JTAG_MACHINE
+struct JAMS_JTAG_PATH
 {
-    JAME_JTAG_STATE tms_high;
-    JAME_JTAG_STATE tms_low;
-} static const jam_jtag_state_transitions[] =
+    unsigned char length;       /* number of TCK cycles */
+    unsigned char tms;          /* TMS values, first cycle in bit 0 */
+} static const jam_jtag_path[16][16] =
 {
 /* RESET     */
-    {
-    RESET, IDLE},
+    {{1, 0x01}, {1, 0x00}, {2, 0x02}, {3, 0x02},
+     {4, 0x02}, {4, 0x0A}, {5, 0x0A}, {6, 0x2A},
+     {5, 0x1A}, {3, 0x06}, {4, 0x06}, {5, 0x06},
+     {5, 0x16}, {6, 0x16}, {7, 0x56}, {6, 0x36}},
 /* IDLE      */
-    {
-    DRSELECT, IDLE},
+    {{3, 0x07}, {1, 0x00}, {1, 0x01}, {2, 0x01},
+     {3, 0x01}, {3, 0x05}, {4, 0x05}, {5, 0x15},
+     {4, 0x0D}, {2, 0x03}, {3, 0x03}, {4, 0x03},
+     {4, 0x0B}, {5, 0x0B}, {6, 0x2B}, {5, 0x1B}},
 /* DRSELECT  */
-    {
-    IRSELECT, DRCAPTURE},
+    {{2, 0x03}, {4, 0x06}, {0, 0x00}, {1, 0x00},
+     {2, 0x00}, {2, 0x02}, {3, 0x02}, {4, 0x0A},
+     {3, 0x06}, {1, 0x01}, {2, 0x01}, {3, 0x01},
+     {3, 0x05}, {4, 0x05}, {5, 0x15}, {4, 0x0D}},
 /* DRCAPTURE */
-    {
-    DREXIT1, DRSHIFT},
+    {{5, 0x1F}, {3, 0x03}, {3, 0x07}, {0, 0x00},
+     {1, 0x00}, {1, 0x01}, {2, 0x01}, {3, 0x05},
+     {2, 0x03}, {4, 0x0F}, {5, 0x0F}, {6, 0x0F},
+     {6, 0x2F}, {7, 0x2F}, {8, 0xAF}, {7, 0x6F}},
 /* DRSHIFT   */
-    {
-    DREXIT1, DRSHIFT},
+    {{5, 0x1F}, {3, 0x03}, {3, 0x07}, {4, 0x07},
+     {1, 0x00}, {1, 0x01}, {2, 0x01}, {3, 0x05},
+     {2, 0x03}, {4, 0x0F}, {5, 0x0F}, {6, 0x0F},
+     {6, 0x2F}, {7, 0x2F}, {8, 0xAF}, {7, 0x6F}},
 /* DREXIT1   */
-    {
-    DRUPDATE, DRPAUSE},
+    {{4, 0x0F}, {2, 0x01}, {2, 0x03}, {3, 0x03},
+     {3, 0x02}, {0, 0x00}, {1, 0x00}, {2, 0x02},
+     {1, 0x01}, {3, 0x07}, {4, 0x07}, {5, 0x07},
+     {5, 0x17}, {6, 0x17}, {7, 0x57}, {6, 0x37}},
 /* DRPAUSE   */
-    {
-    DREXIT2, DRPAUSE},
+    {{5, 0x1F}, {3, 0x03}, {3, 0x07}, {4, 0x07},
+     {2, 0x01}, {3, 0x05}, {1, 0x00}, {1, 0x01},
+     {2, 0x03}, {4, 0x0F}, {5, 0x0F}, {6, 0x0F},
+     {6, 0x2F}, {7, 0x2F}, {8, 0xAF}, {7, 0x6F}},
 /* DREXIT2   */
-    {
-    DRUPDATE, DRSHIFT},
+    {{4, 0x0F}, {2, 0x01}, {2, 0x03}, {3, 0x03},
+     {1, 0x00}, {2, 0x02}, {3, 0x02}, {0, 0x00},
+     {1, 0x01}, {3, 0x07}, {4, 0x07}, {5, 0x07},
+     {5, 0x17}, {6, 0x17}, {7, 0x57}, {6, 0x37}},
 /* DRUPDATE  */
-    {
-    DRSELECT, IDLE},
+    {{3, 0x07}, {1, 0x00}, {1, 0x01}, {2, 0x01},
+     {3, 0x01}, {3, 0x05}, {4, 0x05}, {5, 0x15},
+     {0, 0x00}, {2, 0x03}, {3, 0x03}, {4, 0x03},
+     {4, 0x0B}, {5, 0x0B}, {6, 0x2B}, {5, 0x1B}},
 /* IRSELECT  */
-    {
-    RESET, IRCAPTURE},
+    {{1, 0x01}, {4, 0x06}, {4, 0x0E}, {5, 0x0E},
+     {6, 0x0E}, {6, 0x2E}, {7, 0x2E}, {8, 0xAE},
+     {7, 0x6E}, {0, 0x00}, {1, 0x00}, {2, 0x00},
+     {2, 0x02}, {3, 0x02}, {4, 0x0A}, {3, 0x06}},
 /* IRCAPTURE */
-    {
-    IREXIT1, IRSHIFT},
+    {{5, 0x1F}, {3, 0x03}, {3, 0x07}, {4, 0x07},
+     {5, 0x07}, {5, 0x17}, {6, 0x17}, {7, 0x57},
+     {6, 0x37}, {4, 0x0F}, {0, 0x00}, {1, 0x00},
+     {1, 0x01}, {2, 0x01}, {3, 0x05}, {2, 0x03}},
 /* IRSHIFT   */
-    {
-    IREXIT1, IRSHIFT},
+    {{5, 0x1F}, {3, 0x03}, {3, 0x07}, {4, 0x07},
+     {5, 0x07}, {5, 0x17}, {6, 0x17}, {7, 0x57},
+     {6, 0x37}, {4, 0x0F}, {5, 0x0F}, {1, 0x00},
+     {1, 0x01}, {2, 0x01}, {3, 0x05}, {2, 0x03}},
 /* IREXIT1   */
-    {
-    IRUPDATE, IRPAUSE},
+    {{4, 0x0F}, {2, 0x01}, {2, 0x03}, {3, 0x03},
+     {4, 0x03}, {4, 0x0B}, {5, 0x0B}, {6, 0x2B},
+     {5, 0x1B}, {3, 0x07}, {4, 0x07}, {3, 0x02},
+     {0, 0x00}, {1, 0x00}, {2, 0x02}, {1, 0x01}},
 /* IRPAUSE   */
-    {
-    IREXIT2, IRPAUSE},
+    {{5, 0x1F}, {3, 0x03}, {3, 0x07}, {4, 0x07},
+     {5, 0x07}, {5, 0x17}, {6, 0x17}, {7, 0x57},
+     {6, 0x37}, {4, 0x0F}, {5, 0x0F}, {2, 0x01},
+     {3, 0x05}, {1, 0x00}, {1, 0x01}, {2, 0x03}},
 /* IREXIT2   */
-    {
-    IRUPDATE, IRSHIFT},
+    {{4, 0x0F}, {2, 0x01}, {2, 0x03}, {3, 0x03},
+     {4, 0x03}, {4, 0x0B}, {5, 0x0B}, {6, 0x2B},
+     {5, 0x1B}, {3, 0x07}, {4, 0x07}, {1, 0x00},
+     {2, 0x02}, {3, 0x02}, {0, 0x00}, {1, 0x01}},
 /* IRUPDATE  */
-    {
-    DRSELECT, IDLE}
-};
-
-/*
-*   This table contains the TMS value to be used to take the NEXT STEP on
-*   the path to the desired state.  The array index is the current state,
-*   and the bit position is the desired endstate.  To find out which state
-*   is used as the intermediate state, look up the TMS value in the
-*   urj_jam_jtag_state_transitions[] table.
-*/
-static const unsigned short jam_jtag_path_map[16] = {
-    0x0001, 0xFFFD, 0xFE01, 0xFFE7, 0xFFEF, 0xFF0F, 0xFFBF, 0xFF0F,
-    0xFEFD, 0x0001, 0xF3FF, 0xF7FF, 0x87FF, 0xDFFF, 0x87FF, 0x7FFD
+    {{3, 0x07}, {1, 0x00}, {1, 0x01}, {2, 0x01},
+     {3, 0x01}, {3, 0x05}, {4, 0x05}, {5, 0x15},
+     {4, 0x0D}, {2, 0x03}, {3, 0x03}, {4, 0x03},
+     {4, 0x0B}, {5, 0x0B}, {6, 0x2B}, {0, 0x00}}
 };
 
 /*
@@ -181,14 +234,16 @@ void urj_jam_jtag_extract_target_data (char *buffer, int32_t *target_data,
                                    int32_t start_index,
                                    int32_t preamble_count,
                                    int32_t target_count);
-int urj_jam_jtag_drscan (int start_state, int count, char *tdi, char *tdo);
-int urj_jam_jtag_irscan (int start_state, int count, char *tdi, char *tdo);
+int urj_jam_jtag_drscan (int start_state, int count, char *tdi, char *tdo,
+                     BOOL capture_later);
+int urj_jam_jtag_irscan (int start_state, int count, char *tdi, char *tdo,
+                     BOOL capture_later);
 int urj_jam_do_irscan (int32_t count, int32_t *data, int32_t start_index);
 int urj_jam_swap_ir (int32_t count, int32_t *in_data, int32_t in_index,
-                 int32_t *out_data, int32_t out_index);
+                 int32_t *out_data, int32_t out_index, BOOL capture_later);
 int urj_jam_do_drscan (int32_t count, int32_t *data, int32_t start_index);
 int urj_jam_swap_dr (int32_t count, int32_t *in_data, int32_t in_index,
-                 int32_t *out_data, int32_t out_index);
+                 int32_t *out_data, int32_t out_index, BOOL capture_later);
 void urj_jam_free_jtag_padding_buffers (int reset_jtag);
 
 /****************************************************************************/
@@ -199,11 +254,10 @@ urj_jam_init_jtag (void)
 /*                                                                          */
 /****************************************************************************/
 {
-    void **symbol_table = NULL;
-    JAMS_STACK_RECORD *stack = NULL;
-
     /* initial JTAG state is unknown */
     urj_jam_jtag_state = JAM_ILLEGAL_JTAG_STATE;
+    urj_jam_scan_bit_count = 0;
+    urj_jam_looking_up_capture = false;
 
     /* initialize global variables to default state */
     urj_jam_drstop_state = IDLE;
@@ -215,30 +269,12 @@ urj_jam_init_jtag (void)
     urj_jam_dr_length = 0;
     urj_jam_ir_length = 0;
 
-    if (urj_jam_workspace != NULL)
-    {
-        symbol_table = (void **) urj_jam_workspace;
-        stack = (JAMS_STACK_RECORD *) & symbol_table[JAMC_MAX_SYMBOL_COUNT];
-        urj_jam_dr_preamble_data = (int32_t *) & stack[JAMC_MAX_NESTING_DEPTH];
-        urj_jam_dr_postamble_data =
-            &urj_jam_dr_preamble_data[JAMC_MAX_JTAG_DR_PREAMBLE / 32];
-        urj_jam_ir_preamble_data =
-            &urj_jam_dr_postamble_data[JAMC_MAX_JTAG_DR_POSTAMBLE / 32];
-        urj_jam_ir_postamble_data =
-            &urj_jam_ir_preamble_data[JAMC_MAX_JTAG_IR_PREAMBLE / 32];
-        urj_jam_dr_buffer =
-            (char *) &urj_jam_ir_postamble_data[JAMC_MAX_JTAG_IR_POSTAMBLE / 32];
-        urj_jam_ir_buffer = &urj_jam_dr_buffer[JAMC_MAX_JTAG_DR_LENGTH / 8];
-    }
-    else
-    {
-        urj_jam_dr_preamble_data = NULL;
-        urj_jam_dr_postamble_data = NULL;
-        urj_jam_ir_preamble_data = NULL;
-        urj_jam_ir_postamble_data = NULL;
-        urj_jam_dr_buffer = NULL;
-        urj_jam_ir_buffer = NULL;
-    }
+    urj_jam_dr_preamble_data = NULL;
+    urj_jam_dr_postamble_data = NULL;
+    urj_jam_ir_preamble_data = NULL;
+    urj_jam_ir_postamble_data = NULL;
+    urj_jam_dr_buffer = NULL;
+    urj_jam_ir_buffer = NULL;
 
     return JAMC_SUCCESS;
 }
@@ -284,9 +320,14 @@ JAM_RETURN_TYPE urj_jam_set_dr_preamble
 
     if (count >= 0)
     {
-        if (urj_jam_workspace != NULL)
+        if (count > urj_jam_dr_preamble)
         {
-            if (count > JAMC_MAX_JTAG_DR_PREAMBLE)
+            alloc_longs = (count + 31) >> 5;
+            free (urj_jam_dr_preamble_data);
+            urj_jam_dr_preamble_data =
+                (int32_t *) malloc (alloc_longs * sizeof (int32_t));
+
+            if (urj_jam_dr_preamble_data == NULL)
             {
                 status = JAMC_OUT_OF_MEMORY;
             }
@@ -297,26 +338,7 @@ JAM_RETURN_TYPE urj_jam_set_dr_preamble
         }
         else
         {
-            if (count > urj_jam_dr_preamble)
-            {
-                alloc_longs = (count + 31) >> 5;
-                free (urj_jam_dr_preamble_data);
-                urj_jam_dr_preamble_data =
-                    (int32_t *) malloc (alloc_longs * sizeof (int32_t));
-
-                if (urj_jam_dr_preamble_data == NULL)
-                {
-                    status = JAMC_OUT_OF_MEMORY;
-                }
-                else
-                {
-                    urj_jam_dr_preamble = count;
-                }
-            }
-            else
-            {
-                urj_jam_dr_preamble = count;
-            }
+            urj_jam_dr_preamble = count;
         }
 
         if (status == JAMC_SUCCESS)
@@ -363,9 +385,14 @@ JAM_RETURN_TYPE urj_jam_set_ir_preamble
 
     if (count >= 0)
     {
-        if (urj_jam_workspace != NULL)
+        if (count > urj_jam_ir_preamble)
         {
-            if (count > JAMC_MAX_JTAG_IR_PREAMBLE)
+            alloc_longs = (count + 31) >> 5;
+            free (urj_jam_ir_preamble_data);
+            urj_jam_ir_preamble_data =
+                (int32_t *) malloc (alloc_longs * sizeof (int32_t));
+
+            if (urj_jam_ir_preamble_data == NULL)
             {
                 status = JAMC_OUT_OF_MEMORY;
             }
@@ -376,26 +403,7 @@ JAM_RETURN_TYPE urj_jam_set_ir_preamble
         }
         else
         {
-            if (count > urj_jam_ir_preamble)
-            {
-                alloc_longs = (count + 31) >> 5;
-                free (urj_jam_ir_preamble_data);
-                urj_jam_ir_preamble_data =
-                    (int32_t *) malloc (alloc_longs * sizeof (int32_t));
-
-                if (urj_jam_ir_preamble_data == NULL)
-                {
-                    status = JAMC_OUT_OF_MEMORY;
-                }
-                else
-                {
-                    urj_jam_ir_preamble = count;
-                }
-            }
-            else
-            {
-                urj_jam_ir_preamble = count;
-            }
+            urj_jam_ir_preamble = count;
         }
 
         if (status == JAMC_SUCCESS)
@@ -442,9 +450,14 @@ JAM_RETURN_TYPE urj_jam_set_dr_postamble
 
     if (count >= 0)
     {
-        if (urj_jam_workspace != NULL)
+        if (count > urj_jam_dr_postamble)
         {
-            if (count > JAMC_MAX_JTAG_DR_POSTAMBLE)
+            alloc_longs = (count + 31) >> 5;
+            free (urj_jam_dr_postamble_data);
+            urj_jam_dr_postamble_data =
+                (int32_t *) malloc (alloc_longs * sizeof (int32_t));
+
+            if (urj_jam_dr_postamble_data == NULL)
             {
                 status = JAMC_OUT_OF_MEMORY;
             }
@@ -455,26 +468,7 @@ JAM_RETURN_TYPE urj_jam_set_dr_postamble
         }
         else
         {
-            if (count > urj_jam_dr_postamble)
-            {
-                alloc_longs = (count + 31) >> 5;
-                free (urj_jam_dr_postamble_data);
-                urj_jam_dr_postamble_data =
-                    (int32_t *) malloc (alloc_longs * sizeof (int32_t));
-
-                if (urj_jam_dr_postamble_data == NULL)
-                {
-                    status = JAMC_OUT_OF_MEMORY;
-                }
-                else
-                {
-                    urj_jam_dr_postamble = count;
-                }
-            }
-            else
-            {
-                urj_jam_dr_postamble = count;
-            }
+            urj_jam_dr_postamble = count;
         }
 
         if (status == JAMC_SUCCESS)
@@ -521,9 +515,14 @@ JAM_RETURN_TYPE urj_jam_set_ir_postamble
 
     if (count >= 0)
     {
-        if (urj_jam_workspace != NULL)
+        if (count > urj_jam_ir_postamble)
         {
-            if (count > JAMC_MAX_JTAG_IR_POSTAMBLE)
+            alloc_longs = (count + 31) >> 5;
+            free (urj_jam_ir_postamble_data);
+            urj_jam_ir_postamble_data =
+                (int32_t *) malloc (alloc_longs * sizeof (int32_t));
+
+            if (urj_jam_ir_postamble_data == NULL)
             {
                 status = JAMC_OUT_OF_MEMORY;
             }
@@ -534,26 +533,7 @@ JAM_RETURN_TYPE urj_jam_set_ir_postamble
         }
         else
         {
-            if (count > urj_jam_ir_postamble)
-            {
-                alloc_longs = (count + 31) >> 5;
-                free (urj_jam_ir_postamble_data);
-                urj_jam_ir_postamble_data =
-                    (int32_t *) malloc (alloc_longs * sizeof (int32_t));
-
-                if (urj_jam_ir_postamble_data == NULL)
-                {
-                    status = JAMC_OUT_OF_MEMORY;
-                }
-                else
-                {
-                    urj_jam_ir_postamble = count;
-                }
-            }
-            else
-            {
-                urj_jam_ir_postamble = count;
-            }
+            urj_jam_ir_postamble = count;
         }
 
         if (status == JAMC_SUCCESS)
@@ -593,20 +573,11 @@ urj_jam_jtag_reset_idle (void)
 /*                                                                          */
 /****************************************************************************/
 {
-    int i = 0;
-
     /*
      *      Go to Test Logic Reset (no matter what the starting state may be)
+     *      with five cycles of TMS high, then step to Run Test / Idle
      */
-    for (i = 0; i < 5; ++i)
-    {
-        urj_jam_jtag_io (TMS_HIGH, TDI_LOW, IGNORE_TDO);
-    }
-
-    /*
-     *      Now step to Run Test / Idle
-     */
-    urj_jam_jtag_io (TMS_LOW, TDI_LOW, IGNORE_TDO);
+    urj_jam_jtag_io_tms (6, 0x1F);
 
     urj_jam_jtag_state = IDLE;
 }
@@ -619,8 +590,7 @@ urj_jam_goto_jtag_state (JAME_JTAG_STATE state)
 /*                                                                          */
 /****************************************************************************/
 {
-    int tms = 0;
-    int count = 0;
+    const struct JAMS_JTAG_PATH *path = NULL;
     JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
     if (urj_jam_jtag_state == JAM_ILLEGAL_JTAG_STATE)
@@ -629,56 +599,15 @@ urj_jam_goto_jtag_state (JAME_JTAG_STATE state)
         urj_jam_jtag_reset_idle ();
     }
 
-    if (urj_jam_jtag_state == state)
+    if ((state < RESET) || (state > IRUPDATE))
     {
-        /*
-         *      We are already in the desired state.  If it is a stable state,
-         *      loop here.  Otherwise do nothing (no clock cycles).
-         */
-        if ((state == IDLE) ||
-            (state == DRSHIFT) ||
-            (state == DRPAUSE) || (state == IRSHIFT) || (state == IRPAUSE))
-        {
-            urj_jam_jtag_io (TMS_LOW, TDI_LOW, IGNORE_TDO);
-        }
-        else if (state == RESET)
-        {
-            urj_jam_jtag_io (TMS_HIGH, TDI_LOW, IGNORE_TDO);
-        }
+        status = JAMC_INTERNAL_ERROR;
     }
     else
     {
-        while ((urj_jam_jtag_state != state) && (count < 9))
-        {
-            /*
-             *      Get TMS value to take a step toward desired state
-             */
-            tms = (jam_jtag_path_map[urj_jam_jtag_state] & (1 << state)) ?
-                TMS_HIGH : TMS_LOW;
-
-            /*
-             *      Take a step
-             */
-            urj_jam_jtag_io (tms, TDI_LOW, IGNORE_TDO);
-
-            if (tms)
-            {
-                urj_jam_jtag_state =
-                    jam_jtag_state_transitions[urj_jam_jtag_state].tms_high;
-            }
-            else
-            {
-                urj_jam_jtag_state =
-                    jam_jtag_state_transitions[urj_jam_jtag_state].tms_low;
-            }
-
-            ++count;
-        }
-    }
-
-    if (urj_jam_jtag_state != state)
-    {
-        status = JAMC_INTERNAL_ERROR;
+        path = &jam_jtag_path[urj_jam_jtag_state][state];
+        urj_jam_jtag_io_tms (path->length, path->tms);
+        urj_jam_jtag_state = state;
     }
 
     return status;
@@ -727,7 +656,6 @@ JAM_RETURN_TYPE urj_jam_do_wait_cycles
 /****************************************************************************/
 {
     int tms = 0;
-    int32_t count = 0L;
     JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
     if (urj_jam_jtag_state != wait_state)
@@ -743,10 +671,7 @@ JAM_RETURN_TYPE urj_jam_do_wait_cycles
          */
         tms = (wait_state == RESET) ? TMS_HIGH : TMS_LOW;
 
-        for (count = 0L; count < cycles; count++)
-        {
-            urj_jam_jtag_io (tms, TDI_LOW, IGNORE_TDO);
-        }
+        urj_jam_jtag_io_run (tms, cycles);
     }
 
     return status;
@@ -763,12 +688,14 @@ JAM_RETURN_TYPE urj_jam_do_wait_microseconds
 /*                  no JTAG operations have been performed yet, then only   */
 /*                  a delay is performed.  This permits the WAIT USECS      */
 /*                  statement to be used in VECTOR programs without causing */
-/*                  any JTAG operations.                                    */
+/*                  any JTAG operations.  Otherwise the porting layer may   */
+/*                  fill the time with TCK cycles in the stable state.      */
 /*                                                                          */
 /*  Returns:        JAMC_SUCCESS for success, else appropriate error code   */
 /*                                                                          */
 /****************************************************************************/
 {
+    int tms = -1;
     JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
     if ((urj_jam_jtag_state != JAM_ILLEGAL_JTAG_STATE) &&
@@ -779,10 +706,15 @@ JAM_RETURN_TYPE urj_jam_do_wait_microseconds
 
     if (status == JAMC_SUCCESS)
     {
+        if (urj_jam_jtag_state != JAM_ILLEGAL_JTAG_STATE)
+        {
+            tms = (wait_state == RESET) ? TMS_HIGH : TMS_LOW;
+        }
+
         /*
-         *  Flush all data and wait for specified time interval
+         *  Wait for specified time interval
          */
-        urj_jam_flush_and_delay (microseconds);
+        urj_jam_jtag_delay (microseconds, tms);
     }
 
     return status;
@@ -887,89 +819,90 @@ void urj_jam_jtag_extract_target_data
     }
 }
 
-int
-urj_jam_jtag_drscan (int start_state, int count, char *tdi, char *tdo)
+static int
+urj_jam_jtag_goto_shift (int start_state, JAME_JTAG_STATE shift_state)
+/*                                                                          */
+/*  Description:    Moves from the start state of a scan (0 = IDLE,         */
+/*                  1 = DRPAUSE, 2 = IRPAUSE) to DRSHIFT or IRSHIFT.        */
+/*                                                                          */
+/*  Returns:        1 for success, 0 for an illegal start state             */
+/*                                                                          */
+/****************************************************************************/
 {
-    int status = 1;
+    static const JAME_JTAG_STATE start_states[] = { IDLE, DRPAUSE, IRPAUSE };
+    const struct JAMS_JTAG_PATH *path = NULL;
 
-    /*
-     *      First go to DRSHIFT state
-     */
-    switch (start_state)
+    if ((start_state < 0) || (start_state >= (int) ARRAY_SIZE(start_states)))
     {
-    case 0:                    /* IDLE */
-        urj_jam_jtag_io (1, 0, 0);  /* DRSELECT */
-        urj_jam_jtag_io (0, 0, 0);  /* DRCAPTURE */
-        urj_jam_jtag_io (0, 0, 0);  /* DRSHIFT */
-        break;
+        return 0;
+    }
 
-    case 1:                    /* DRPAUSE */
-        urj_jam_jtag_io (1, 0, 0);  /* DREXIT2 */
-        urj_jam_jtag_io (0, 0, 0);  /* DRSHIFT */
-        break;
+    path = &jam_jtag_path[start_states[start_state]][shift_state];
+    urj_jam_jtag_io_tms (path->length, path->tms);
 
-    case 2:                    /* IRPAUSE */
-        urj_jam_jtag_io (1, 0, 0);  /* IREXIT2 */
-        urj_jam_jtag_io (1, 0, 0);  /* IRUPDATE */
-        urj_jam_jtag_io (1, 0, 0);  /* DRSELECT */
-        urj_jam_jtag_io (0, 0, 0);  /* DRCAPTURE */
-        urj_jam_jtag_io (0, 0, 0);  /* DRSHIFT */
-        break;
+    return 1;
+}
 
-    default:
-        status = 0;
-    }
+/****************************************************************************/
+/*                                                                          */
+
+int
+urj_jam_jtag_drscan (int start_state, int count, char *tdi, char *tdo,
+                     BOOL capture_later)
+{
+    int status = 0;
+
+    /*
+     *      First go to DRSHIFT state
+     */
+    status = urj_jam_jtag_goto_shift (start_state, DRSHIFT);
 
     if (status)
     {
-        status = urj_jam_jtag_io_transfer (count, tdi, tdo);
+        if (capture_later)
+        {
+            /* TDO is collected by urj_jam_jtag_complete_captures() */
+            status = urj_jam_jtag_io_capture (count, tdi);
+        }
+        else
+        {
+            status = urj_jam_jtag_io_transfer (count, tdi, tdo);
+        }
 
         urj_jam_jtag_io (0, 0, 0);  /* DRPAUSE */
+
+        urj_jam_scan_bit_count += count;
     }
 
     return status;
 }
 
 int
-urj_jam_jtag_irscan (int start_state, int count, char *tdi, char *tdo)
+urj_jam_jtag_irscan (int start_state, int count, char *tdi, char *tdo,
+                     BOOL capture_later)
 {
-    int status = 1;
+    int status = 0;
 
     /*
      *      First go to IRSHIFT state
      */
-    switch (start_state)
-    {
-    case 0:                    /* IDLE */
-        urj_jam_jtag_io (1, 0, 0);  /* DRSELECT */
-        urj_jam_jtag_io (1, 0, 0);  /* IRSELECT */
-        urj_jam_jtag_io (0, 0, 0);  /* IRCAPTURE */
-        urj_jam_jtag_io (0, 0, 0);  /* IRSHIFT */
-        break;
-
-    case 1:                    /* DRPAUSE */
-        urj_jam_jtag_io (1, 0, 0);  /* DREXIT2 */
-        urj_jam_jtag_io (1, 0, 0);  /* DRUPDATE */
-        urj_jam_jtag_io (1, 0, 0);  /* DRSELECT */
-        urj_jam_jtag_io (1, 0, 0);  /* IRSELECT */
-        urj_jam_jtag_io (0, 0, 0);  /* IRCAPTURE */
-        urj_jam_jtag_io (0, 0, 0);  /* IRSHIFT */
-        break;
-
-    case 2:                    /* IRPAUSE */
-        urj_jam_jtag_io (1, 0, 0);  /* IREXIT2 */
-        urj_jam_jtag_io (0, 0, 0);  /* IRSHIFT */
-        break;
-
-    default:
-        status = 0;
-    }
+    status = urj_jam_jtag_goto_shift (start_state, IRSHIFT);
 
     if (status)
     {
-        status = urj_jam_jtag_io_transfer (count, tdi, tdo);
+        if (capture_later)
+        {
+            /* TDO is collected by urj_jam_jtag_complete_captures() */
+            status = urj_jam_jtag_io_capture (count, tdi);
+        }
+        else
+        {
+            status = urj_jam_jtag_io_transfer (count, tdi, tdo);
+        }
 
         urj_jam_jtag_io (0, 0, 0);  /* IRPAUSE */
+
+        urj_jam_scan_bit_count += count;
     }
 
     return status;
@@ -1039,14 +972,7 @@ JAM_RETURN_TYPE urj_jam_do_irscan
 
     if (status == JAMC_SUCCESS)
     {
-        if (urj_jam_workspace != NULL)
-        {
-            if (shift_count > JAMC_MAX_JTAG_IR_LENGTH)
-            {
-                status = JAMC_OUT_OF_MEMORY;
-            }
-        }
-        else if (shift_count > urj_jam_ir_length)
+        if (shift_count > urj_jam_ir_length)
         {
             alloc_chars = (shift_count + 7) >> 3;
             free (urj_jam_ir_buffer);
@@ -1078,7 +1004,8 @@ JAM_RETURN_TYPE urj_jam_do_irscan
         /*
          *      Do the IRSCAN
          */
-        urj_jam_jtag_irscan (start_code, shift_count, urj_jam_ir_buffer, NULL);
+        urj_jam_jtag_irscan (start_code, shift_count, urj_jam_ir_buffer, NULL,
+                             false);
 
         /* urj_jam_jtag_irscan() always ends in IRPAUSE state */
         urj_jam_jtag_state = IRPAUSE;
@@ -1101,7 +1028,8 @@ JAM_RETURN_TYPE urj_jam_do_irscan
 JAM_RETURN_TYPE urj_jam_swap_ir
     (int32_t count,
      int32_t *in_data,
-     int32_t in_index, int32_t *out_data, int32_t out_index)
+     int32_t in_index,
+     int32_t *out_data, int32_t out_index, BOOL capture_later)
 /*                                                                          */
 /*  Description:    Shifts data into instruction register, capturing output */
 /*                  data                                                    */
@@ -1115,6 +1043,7 @@ JAM_RETURN_TYPE urj_jam_swap_ir
     int shift_count = (int) (urj_jam_ir_preamble + count + urj_jam_ir_postamble);
     JAM_RETURN_TYPE status = JAMC_SUCCESS;
     JAME_JTAG_STATE start_state = JAM_ILLEGAL_JTAG_STATE;
+    JAMS_JTAG_CAPTURE *capture = NULL;
 
     switch (urj_jam_jtag_state)
     {
@@ -1160,16 +1089,31 @@ JAM_RETURN_TYPE urj_jam_swap_ir
         }
     }
 
-    if (status == JAMC_SUCCESS)
+    /*
+     *      Scans which read TDO now must wait for those still pending, and
+     *      only so many are kept pending
+     */
+    if ((status == JAMC_SUCCESS) &&
+        ((!capture_later) ||
+         (jam_capture_count >= JAMC_MAX_PENDING_CAPTURES)))
     {
-        if (urj_jam_workspace != NULL)
+        status = urj_jam_jtag_complete_captures ();
+    }
+
+    if ((status == JAMC_SUCCESS) && capture_later)
+    {
+        capture = malloc (sizeof (JAMS_JTAG_CAPTURE) +
+                          (size_t) ((shift_count + 7) >> 3));
+
+        if (capture == NULL)
         {
-            if (shift_count > JAMC_MAX_JTAG_IR_LENGTH)
-            {
-                status = JAMC_OUT_OF_MEMORY;
-            }
+            status = JAMC_OUT_OF_MEMORY;
         }
-        else if (shift_count > urj_jam_ir_length)
+    }
+
+    if (status == JAMC_SUCCESS)
+    {
+        if (shift_count > urj_jam_ir_length)
         {
             alloc_chars = (shift_count + 7) >> 3;
             free (urj_jam_ir_buffer);
@@ -1201,8 +1145,13 @@ JAM_RETURN_TYPE urj_jam_swap_ir
         /*
          *      Do the IRSCAN
          */
-        urj_jam_jtag_irscan
-            (start_code, shift_count, urj_jam_ir_buffer, urj_jam_ir_buffer);
+        if (!urj_jam_jtag_irscan
+            (start_code, shift_count, urj_jam_ir_buffer, urj_jam_ir_buffer,
+             capture_later) && capture_later)
+        {
+            /* the scan was not queued, there is no TDO to collect */
+            status = JAMC_OUT_OF_MEMORY;
+        }
 
         /* urj_jam_jtag_irscan() always ends in IRPAUSE state */
         urj_jam_jtag_state = IRPAUSE;
@@ -1216,7 +1165,30 @@ JAM_RETURN_TYPE urj_jam_swap_ir
         }
     }
 
-    if (status == JAMC_SUCCESS)
+    if ((status == JAMC_SUCCESS) && capture_later)
+    {
+        /*
+         *      The returned data is extracted when the array is referenced
+         */
+        capture->out_data = out_data;
+        capture->out_index = out_index;
+        capture->count = count;
+        capture->preamble = urj_jam_ir_preamble;
+        capture->shift_count = shift_count;
+        capture->next = NULL;
+
+        if (jam_capture_last != NULL)
+        {
+            jam_capture_last->next = capture;
+        }
+        else
+        {
+            jam_capture_first = capture;
+        }
+        jam_capture_last = capture;
+        ++jam_capture_count;
+    }
+    else if (status == JAMC_SUCCESS)
     {
         /*
          *      Now extract the returned data from the buffer
@@ -1224,6 +1196,10 @@ JAM_RETURN_TYPE urj_jam_swap_ir
         urj_jam_jtag_extract_target_data
             (urj_jam_ir_buffer, out_data, out_index, urj_jam_ir_preamble, count);
     }
+    else
+    {
+        free (capture);
+    }
 
     return status;
 }
@@ -1292,14 +1268,7 @@ JAM_RETURN_TYPE urj_jam_do_drscan
 
     if (status == JAMC_SUCCESS)
     {
-        if (urj_jam_workspace != NULL)
-        {
-            if (shift_count > JAMC_MAX_JTAG_DR_LENGTH)
-            {
-                status = JAMC_OUT_OF_MEMORY;
-            }
-        }
-        else if (shift_count > urj_jam_dr_length)
+        if (shift_count > urj_jam_dr_length)
         {
             alloc_chars = (shift_count + 7) >> 3;
             free (urj_jam_dr_buffer);
@@ -1331,7 +1300,8 @@ JAM_RETURN_TYPE urj_jam_do_drscan
         /*
          *      Do the DRSCAN
          */
-        urj_jam_jtag_drscan (start_code, shift_count, urj_jam_dr_buffer, NULL);
+        urj_jam_jtag_drscan (start_code, shift_count, urj_jam_dr_buffer, NULL,
+                             false);
 
         /* urj_jam_jtag_drscan() always ends in DRPAUSE state */
         urj_jam_jtag_state = DRPAUSE;
@@ -1354,7 +1324,8 @@ JAM_RETURN_TYPE urj_jam_do_drscan
 JAM_RETURN_TYPE urj_jam_swap_dr
     (int32_t count,
      int32_t *in_data,
-     int32_t in_index, int32_t *out_data, int32_t out_index)
+     int32_t in_index,
+     int32_t *out_data, int32_t out_index, BOOL capture_later)
 /*                                                                          */
 /*  Description:    Shifts data into data register, capturing output data   */
 /*                                                                          */
@@ -1367,6 +1338,7 @@ JAM_RETURN_TYPE urj_jam_swap_dr
     int shift_count = (int) (urj_jam_dr_preamble + count + urj_jam_dr_postamble);
     JAM_RETURN_TYPE status = JAMC_SUCCESS;
     JAME_JTAG_STATE start_state = JAM_ILLEGAL_JTAG_STATE;
+    JAMS_JTAG_CAPTURE *capture = NULL;
 
     switch (urj_jam_jtag_state)
     {
@@ -1412,16 +1384,31 @@ JAM_RETURN_TYPE urj_jam_swap_dr
         }
     }
 
-    if (status == JAMC_SUCCESS)
+    /*
+     *      Scans which read TDO now must wait for those still pending, and
+     *      only so many are kept pending
+     */
+    if ((status == JAMC_SUCCESS) &&
+        ((!capture_later) ||
+         (jam_capture_count >= JAMC_MAX_PENDING_CAPTURES)))
+    {
+        status = urj_jam_jtag_complete_captures ();
+    }
+
+    if ((status == JAMC_SUCCESS) && capture_later)
     {
-        if (urj_jam_workspace != NULL)
+        capture = malloc (sizeof (JAMS_JTAG_CAPTURE) +
+                          (size_t) ((shift_count + 7) >> 3));
+
+        if (capture == NULL)
         {
-            if (shift_count > JAMC_MAX_JTAG_DR_LENGTH)
-            {
-                status = JAMC_OUT_OF_MEMORY;
-            }
+            status = JAMC_OUT_OF_MEMORY;
         }
-        else if (shift_count > urj_jam_dr_length)
+    }
+
+    if (status == JAMC_SUCCESS)
+    {
+        if (shift_count > urj_jam_dr_length)
         {
             alloc_chars = (shift_count + 7) >> 3;
             free (urj_jam_dr_buffer);
@@ -1453,8 +1440,13 @@ JAM_RETURN_TYPE urj_jam_swap_dr
         /*
          *      Do the DRSCAN
          */
-        urj_jam_jtag_drscan
-            (start_code, shift_count, urj_jam_dr_buffer, urj_jam_dr_buffer);
+        if (!urj_jam_jtag_drscan
+            (start_code, shift_count, urj_jam_dr_buffer, urj_jam_dr_buffer,
+             capture_later) && capture_later)
+        {
+            /* the scan was not queued, there is no TDO to collect */
+            status = JAMC_OUT_OF_MEMORY;
+        }
 
         /* urj_jam_jtag_drscan() always ends in DRPAUSE state */
         urj_jam_jtag_state = DRPAUSE;
@@ -1468,7 +1460,30 @@ JAM_RETURN_TYPE urj_jam_swap_dr
         }
     }
 
-    if (status == JAMC_SUCCESS)
+    if ((status == JAMC_SUCCESS) && capture_later)
+    {
+        /*
+         *      The returned data is extracted when the array is referenced
+         */
+        capture->out_data = out_data;
+        capture->out_index = out_index;
+        capture->count = count;
+        capture->preamble = urj_jam_dr_preamble;
+        capture->shift_count = shift_count;
+        capture->next = NULL;
+
+        if (jam_capture_last != NULL)
+        {
+            jam_capture_last->next = capture;
+        }
+        else
+        {
+            jam_capture_first = capture;
+        }
+        jam_capture_last = capture;
+        ++jam_capture_count;
+    }
+    else if (status == JAMC_SUCCESS)
     {
         /*
          *      Now extract the returned data from the buffer
@@ -1476,6 +1491,10 @@ JAM_RETURN_TYPE urj_jam_swap_dr
         urj_jam_jtag_extract_target_data
             (urj_jam_dr_buffer, out_data, out_index, urj_jam_dr_preamble, count);
     }
+    else
+    {
+        free (capture);
+    }
 
     return status;
 }
@@ -1483,6 +1502,103 @@ JAM_RETURN_TYPE urj_jam_swap_dr
 /****************************************************************************/
 /*                                                                          */
 
+JAM_RETURN_TYPE
+urj_jam_jtag_complete_captures (void)
+/*                                                                          */
+/*  Description:    Gets the TDO data of all pending captures from the      */
+/*                  cable, in the order the scans were done, and extracts   */
+/*                  it into the capture arrays.                             */
+/*                                                                          */
+/*  Returns:        JAMC_SUCCESS for success, else appropriate error code   */
+/*                                                                          */
+/****************************************************************************/
+{
+    JAMS_JTAG_CAPTURE *capture = NULL;
+    JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+    while (jam_capture_first != NULL)
+    {
+        capture = jam_capture_first;
+        jam_capture_first = capture->next;
+
+        if (urj_jam_jtag_io_collect (capture->shift_count, capture->buffer))
+        {
+            urj_jam_jtag_extract_target_data
+                (capture->buffer, capture->out_data, capture->out_index,
+                 capture->preamble, capture->count);
+        }
+        else
+        {
+            status = JAMC_OUT_OF_MEMORY;
+        }
+
+        free (capture);
+    }
+
+    jam_capture_last = NULL;
+    jam_capture_count = 0;
+
+    return status;
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+BOOL
+urj_jam_jtag_capture_pending (int32_t *data)
+/*                                                                          */
+/*  Description:    Checks for a pending capture into the given array data. */
+/*                                                                          */
+/*  Returns:        true if the array still waits for TDO data              */
+/*                                                                          */
+/****************************************************************************/
+{
+    JAMS_JTAG_CAPTURE *capture = NULL;
+
+    for (capture = jam_capture_first; capture != NULL;
+         capture = capture->next)
+    {
+        if (capture->out_data == data)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/****************************************************************************/
+/*                                                                          */
+
+JAM_RETURN_TYPE
+urj_jam_jtag_reference_array (int32_t *data)
+/*                                                                          */
+/*  Description:    Called when the Boolean array with the given data is    */
+/*                  referenced.  Completes the pending captures if one of   */
+/*                  them is into this array, unless the array is only       */
+/*                  looked up as the target of another capture.             */
+/*                                                                          */
+/*  Returns:        JAMC_SUCCESS for success, else appropriate error code   */
+/*                                                                          */
+/****************************************************************************/
+{
+    if (urj_jam_looking_up_capture)
+    {
+        urj_jam_looking_up_capture = false;
+        return JAMC_SUCCESS;
+    }
+
+    if (urj_jam_jtag_capture_pending (data))
+    {
+        return urj_jam_jtag_complete_captures ();
+    }
+
+    return JAMC_SUCCESS;
+}
+
+/****************************************************************************/
+/*                                                                          */
+
 void
 urj_jam_free_jtag_padding_buffers (int reset_jtag)
 /*                                                                          */
@@ -1492,6 +1608,11 @@ urj_jam_free_jtag_padding_buffers (int reset_jtag)
 /*                                                                          */
 /****************************************************************************/
 {
+    /*
+     *      Take the data of pending captures off the cable queue
+     */
+    urj_jam_jtag_complete_captures ();
+
     /*
      *      If the JTAG interface was used, reset it to TLR
      */
@@ -1500,42 +1621,39 @@ urj_jam_free_jtag_padding_buffers (int reset_jtag)
         urj_jam_jtag_reset_idle ();
     }
 
-    if (urj_jam_workspace == NULL)
+    if (urj_jam_dr_preamble_data != NULL)
     {
-        if (urj_jam_dr_preamble_data != NULL)
-        {
-            free (urj_jam_dr_preamble_data);
-            urj_jam_dr_preamble_data = NULL;
-        }
+        free (urj_jam_dr_preamble_data);
+        urj_jam_dr_preamble_data = NULL;
+    }
 
-        if (urj_jam_dr_postamble_data != NULL)
-        {
-            free (urj_jam_dr_postamble_data);
-            urj_jam_dr_postamble_data = NULL;
-        }
+    if (urj_jam_dr_postamble_data != NULL)
+    {
+        free (urj_jam_dr_postamble_data);
+        urj_jam_dr_postamble_data = NULL;
+    }
 
-        if (urj_jam_dr_buffer != NULL)
-        {
-            free (urj_jam_dr_buffer);
-            urj_jam_dr_buffer = NULL;
-        }
+    if (urj_jam_dr_buffer != NULL)
+    {
+        free (urj_jam_dr_buffer);
+        urj_jam_dr_buffer = NULL;
+    }
 
-        if (urj_jam_ir_preamble_data != NULL)
-        {
-            free (urj_jam_ir_preamble_data);
-            urj_jam_ir_preamble_data = NULL;
-        }
+    if (urj_jam_ir_preamble_data != NULL)
+    {
+        free (urj_jam_ir_preamble_data);
+        urj_jam_ir_preamble_data = NULL;
+    }
 
-        if (urj_jam_ir_postamble_data != NULL)
-        {
-            free (urj_jam_ir_postamble_data);
-            urj_jam_ir_postamble_data = NULL;
-        }
+    if (urj_jam_ir_postamble_data != NULL)
+    {
+        free (urj_jam_ir_postamble_data);
+        urj_jam_ir_postamble_data = NULL;
+    }
 
-        if (urj_jam_ir_buffer != NULL)
-        {
-            free (urj_jam_ir_buffer);
-            urj_jam_ir_buffer = NULL;
-        }
+    if (urj_jam_ir_buffer != NULL)
+    {
+        free (urj_jam_ir_buffer);
+        urj_jam_ir_buffer = NULL;
     }
 }
@@ -49,7 +49,12 @@ typedef enum
 } JAME_JTAG_STATE;
 
 extern int urj_jam_jtag_io_transfer (int count, char *tdi, char *tdo);
-extern void urj_jam_flush_and_delay (int32_t microseconds);
+extern int urj_jam_jtag_io_capture (int count, char *tdi);
+extern int urj_jam_jtag_io_collect (int count, char *tdo);
+extern void urj_jam_jtag_delay (int32_t microseconds, int tms);
+
+extern JAM_THREAD_LOCAL int64_t urj_jam_scan_bit_count;
+extern JAM_THREAD_LOCAL BOOL urj_jam_looking_up_capture;
 
 /****************************************************************************/
 /*                                                                          */
@@ -91,7 +96,8 @@ JAM_RETURN_TYPE urj_jam_do_irscan
 JAM_RETURN_TYPE urj_jam_swap_ir
     (int32_t count,
      int32_t *in_data,
-     int32_t in_index, int32_t *out_data, int32_t out_index);
+     int32_t in_index,
+     int32_t *out_data, int32_t out_index, BOOL capture_later);
 
 JAM_RETURN_TYPE urj_jam_do_drscan
     (int32_t count, int32_t *data, int32_t start_index);
@@ -99,7 +105,14 @@ JAM_RETURN_TYPE urj_jam_do_drscan
 JAM_RETURN_TYPE urj_jam_swap_dr
     (int32_t count,
      int32_t *in_data,
-     int32_t in_index, int32_t *out_data, int32_t out_index);
+     int32_t in_index,
+     int32_t *out_data, int32_t out_index, BOOL capture_later);
+
+JAM_RETURN_TYPE urj_jam_jtag_complete_captures (void);
+
+BOOL urj_jam_jtag_capture_pending (int32_t *data);
+
+JAM_RETURN_TYPE urj_jam_jtag_reference_array (int32_t *data);
 
 void urj_jam_free_jtag_padding_buffers (int reset_jtag);
 
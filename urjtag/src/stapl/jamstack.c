@@ -16,7 +16,7 @@
 #include "jamsym.h"
 #include "jamstack.h"
 #include <stdint.h>
-JAMS_STACK_RECORD *urj_jam_stack = 0;
+JAM_THREAD_LOCAL JAMS_STACK_RECORD *urj_jam_stack = 0;
 
 /****************************************************************************/
 /*                                                                          */
@@ -24,41 +24,21 @@ JAMS_STACK_RECORD *urj_jam_stack = 0;
 JAM_RETURN_TYPE
 urj_jam_init_stack (void)
 /*                                                                          */
-/*  Description:    Initialize the stack.  The stack is located after the   */
-/*                  symbol table in the workspace buffer.                   */
+/*  Description:    Initialize the stack.                                   */
 /*                                                                          */
 /*  Returns:        JAMC_SUCCESS for success, else appropriate error code   */
 /*                                                                          */
 /****************************************************************************/
 {
     int index = 0;
-    int size = 0;
     JAM_RETURN_TYPE return_code = JAMC_SUCCESS;
-    void **symbol_table = NULL;
 
-    if (urj_jam_workspace != NULL)
-    {
-        symbol_table = (void **) urj_jam_workspace;
-        urj_jam_stack =
-            (JAMS_STACK_RECORD *) & symbol_table[JAMC_MAX_SYMBOL_COUNT];
-
-        size = (JAMC_MAX_SYMBOL_COUNT * sizeof (void *)) +
-            (JAMC_MAX_NESTING_DEPTH * sizeof (JAMS_STACK_RECORD));
+    urj_jam_stack =
+        malloc (JAMC_MAX_NESTING_DEPTH * sizeof (JAMS_STACK_RECORD));
 
-        if (urj_jam_workspace_size < size)
-        {
-            return_code = JAMC_OUT_OF_MEMORY;
-        }
-    }
-    else
+    if (urj_jam_stack == NULL)
     {
-        urj_jam_stack =
-            malloc (JAMC_MAX_NESTING_DEPTH * sizeof (JAMS_STACK_RECORD));
-
-        if (urj_jam_stack == NULL)
-        {
-            return_code = JAMC_OUT_OF_MEMORY;
-        }
+        return_code = JAMC_OUT_OF_MEMORY;
     }
 
     if (return_code == JAMC_SUCCESS)
@@ -81,7 +61,7 @@ urj_jam_init_stack (void)
 void
 urj_jam_free_stack (void)
 {
-    if ((urj_jam_stack != NULL) && (urj_jam_workspace == NULL))
+    if (urj_jam_stack != NULL)
     {
         free (urj_jam_stack);
     }
@@ -20,6 +20,7 @@
 #include "jamdefs.h"
 #include "jamsym.h"
 #include "jamheap.h"
+#include "jamarray.h"
 #include "jamutil.h"
 
 /****************************************************************************/
@@ -28,9 +29,7 @@
 /*                                                                          */
 /****************************************************************************/
 
-JAMS_SYMBOL_RECORD **urj_jam_symbol_table = NULL;
-
-void *urj_jam_symbol_bottom = NULL;
+JAM_THREAD_LOCAL JAMS_SYMBOL_RECORD **urj_jam_symbol_table = NULL;
 
 int urj_jam_init_symbol_table (void);
 void urj_jam_free_symbol_table (void);
@@ -48,40 +47,23 @@ int urj_jam_set_symbol_value (JAME_SYMBOL_TYPE type, char *name, int32_t value);
 JAM_RETURN_TYPE
 urj_jam_init_symbol_table (void)
 /*                                                                          */
-/*  Description:    Initializes the symbol table.  The symbol table is      */
-/*                  located at the beginning of the workspace buffer.       */
+/*  Description:    Initializes the symbol table.                           */
 /*                                                                          */
 /*  Returns:        JAMC_SUCCESS for success, or JAMC_OUT_OF_MEMORY if the  */
-/*                  size of the workspace buffer is too small to hold the   */
-/*                  desired number of symbol records.                       */
+/*                  table could not be allocated.                           */
 /*                                                                          */
 /****************************************************************************/
 {
     int index = 0;
     JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
-    if (urj_jam_workspace != NULL)
-    {
-        urj_jam_symbol_table = (JAMS_SYMBOL_RECORD **) urj_jam_workspace;
-
-        urj_jam_symbol_bottom = (void *) (((int32_t) urj_jam_workspace) +
-                                      ((int32_t) urj_jam_workspace_size));
+    urj_jam_symbol_table =
+        (JAMS_SYMBOL_RECORD **)
+        malloc ((JAMC_MAX_SYMBOL_COUNT * sizeof (void *)));
 
-        if (urj_jam_workspace_size < (JAMC_MAX_SYMBOL_COUNT * sizeof (void *)))
-        {
-            status = JAMC_OUT_OF_MEMORY;
-        }
-    }
-    else
+    if (urj_jam_symbol_table == NULL)
     {
-        urj_jam_symbol_table =
-            (JAMS_SYMBOL_RECORD **)
-            malloc ((JAMC_MAX_SYMBOL_COUNT * sizeof (void *)));
-
-        if (urj_jam_symbol_table == NULL)
-        {
-            status = JAMC_OUT_OF_MEMORY;
-        }
+        status = JAMC_OUT_OF_MEMORY;
     }
 
     if (status == JAMC_SUCCESS)
@@ -102,7 +84,7 @@ urj_jam_free_symbol_table (void)
     JAMS_SYMBOL_RECORD *symbol_record = NULL;
     JAMS_SYMBOL_RECORD *next = NULL;
 
-    if ((urj_jam_symbol_table != NULL) && (urj_jam_workspace == NULL))
+    if (urj_jam_symbol_table != NULL)
     {
         for (hash = 0; hash < JAMC_MAX_SYMBOL_COUNT; ++hash)
         {
@@ -332,18 +314,19 @@ JAM_RETURN_TYPE urj_jam_add_symbol
                  */
                 identical_redeclaration = true;
 
-                if (urj_jam_version != 2)
+                if ((urj_jam_version != 2) ||
+                    ((type != JAM_PROCEDURE_BLOCK) &&
+                     (type != JAM_DATA_BLOCK) &&
+                     (urj_jam_current_block != NULL) &&
+                     (urj_jam_current_block->type == JAM_PROCEDURE_BLOCK)))
                 {
                     symbol_record->value = value;
-                }
-                else
-                {
-                    if ((type != JAM_PROCEDURE_BLOCK) &&
-                        (type != JAM_DATA_BLOCK) &&
-                        (urj_jam_current_block != NULL) &&
-                        (urj_jam_current_block->type == JAM_PROCEDURE_BLOCK))
+
+                    /* an array declared again gets new data */
+                    if (symbol_record->heap_record != NULL)
                     {
-                        symbol_record->value = value;
+                        urj_jam_free_heap_record (symbol_record->heap_record);
+                        symbol_record->heap_record = NULL;
                     }
                 }
             }
@@ -381,27 +364,12 @@ JAM_RETURN_TYPE urj_jam_add_symbol
         /*
          *      Add the symbol
          */
-        if (urj_jam_workspace != NULL)
-        {
-            urj_jam_symbol_bottom = (void *)
-                (((int32_t) urj_jam_symbol_bottom) - sizeof (JAMS_SYMBOL_RECORD));
+        symbol_record = (JAMS_SYMBOL_RECORD *)
+            malloc (sizeof (JAMS_SYMBOL_RECORD));
 
-            symbol_record = (JAMS_SYMBOL_RECORD *) urj_jam_symbol_bottom;
-
-            if ((int32_t) urj_jam_heap_top > (int32_t) urj_jam_symbol_bottom)
-            {
-                status = JAMC_OUT_OF_MEMORY;
-            }
-        }
-        else
+        if (symbol_record == NULL)
         {
-            symbol_record = (JAMS_SYMBOL_RECORD *)
-                malloc (sizeof (JAMS_SYMBOL_RECORD));
-
-            if (symbol_record == NULL)
-            {
-                status = JAMC_OUT_OF_MEMORY;
-            }
+            status = JAMC_OUT_OF_MEMORY;
         }
 
         if (status == JAMC_SUCCESS)
@@ -409,6 +377,7 @@ JAM_RETURN_TYPE urj_jam_add_symbol
             symbol_record->type = type;
             symbol_record->value = value;
             symbol_record->position = position;
+            symbol_record->heap_record = NULL;
             symbol_record->parent = urj_jam_current_block;
             symbol_record->next = NULL;
 
@@ -534,7 +503,7 @@ JAM_RETURN_TYPE urj_jam_get_symbol_record
             if ((urj_jam_current_block != NULL) &&
                 (urj_jam_current_block->type == JAM_PROCEDURE_BLOCK))
             {
-                heap_record = (JAMS_HEAP_RECORD *) urj_jam_current_block->value;
+                heap_record = urj_jam_current_block->heap_record;
 
                 if (heap_record != NULL)
                 {
@@ -594,6 +563,14 @@ JAM_RETURN_TYPE urj_jam_get_symbol_record
             *symbol_record = tmp_symbol_record;
         }
     }
+
+    if ((status == JAMC_SUCCESS) && (tmp_symbol_record->heap_record != NULL))
+    {
+        /* array data is uncompressed when the array is first referenced */
+        status = urj_jam_load_boolean_array_data
+            (tmp_symbol_record->heap_record);
+    }
+
     return status;
 }
 
@@ -44,6 +44,7 @@ typedef struct JAMS_SYMBOL_STRUCT
     JAME_SYMBOL_TYPE type;
     int32_t value;
     int32_t position;
+    struct JAMS_HEAP_STRUCT *heap_record;   /* data of arrays and USES list */
     struct JAMS_SYMBOL_STRUCT *parent;
     struct JAMS_SYMBOL_STRUCT *next;
 } JAMS_SYMBOL_RECORD;
@@ -54,15 +55,13 @@ typedef struct JAMS_SYMBOL_STRUCT
 /*                                                                          */
 /****************************************************************************/
 
-extern JAMS_SYMBOL_RECORD **urj_jam_symbol_table;
+extern JAM_THREAD_LOCAL JAMS_SYMBOL_RECORD **urj_jam_symbol_table;
 
-extern void *urj_jam_symbol_bottom;
+extern JAM_THREAD_LOCAL JAMS_SYMBOL_RECORD *urj_jam_current_block;
 
-extern JAMS_SYMBOL_RECORD *urj_jam_current_block;
+extern JAM_THREAD_LOCAL int urj_jam_version;
 
-extern int urj_jam_version;
-
-extern BOOL urj_jam_checking_uses_list;
+extern JAM_THREAD_LOCAL BOOL urj_jam_checking_uses_list;
 
 /****************************************************************************/
 /*                                                                          */
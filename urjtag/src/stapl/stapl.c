@@ -22,38 +22,116 @@
  *
  */
 
+#include <sysdep.h>
+
+#include <inttypes.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <time.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
 
 #include "jamexprt.h"
 #include "jamutil.h"
 #include <urjtag/chain.h>
 #include <urjtag/cable.h>
+#include <urjtag/fclock.h>
+#include <urjtag/stapl.h>
 
 /***********************************************************************
 *   Global variables
 ***********************************************************************/
 /* UrJTAG */
-static urj_cable_t *current_cable;
-static urj_chain_t *current_chain;
+static JAM_THREAD_LOCAL urj_cable_t *current_cable;
+static JAM_THREAD_LOCAL urj_chain_t *current_chain;
 
 /* file buffer for JAM input file */
-static char *file_buffer = NULL;
-static int32_t file_pointer = 0L;
-static int32_t file_length = 0L;
+static JAM_THREAD_LOCAL char *file_buffer = NULL;
+static JAM_THREAD_LOCAL int32_t file_pointer = 0L;
+static JAM_THREAD_LOCAL int32_t file_length = 0L;
+/* file_buffer is mapped instead of read */
+static JAM_THREAD_LOCAL bool file_mapped = false;
+/* execution profile records go here, NULL for none */
+static JAM_THREAD_LOCAL FILE *profile_file = NULL;
+/* end of the WAIT time still to pass before the next TCK, 0 for none */
+static JAM_THREAD_LOCAL long double wait_deadline = 0.0;
+
+/* WAIT USEC for up to this many TCK cycles is queued as clocks */
+#define STAPL_MAX_WAIT_CLOCKS 65536
+
+/* CRC check of the file, done by a helper thread while the program runs */
+struct stapl_crc
+{
+    char *program;
+    int32_t program_size;
+    unsigned short expected_crc;
+    unsigned short actual_crc;
+    JAM_RETURN_TYPE result;
+};
 
 int urj_jam_getc (void);
 int urj_jam_seek (int32_t offset);
 int urj_jam_jtag_io (int tms, int tdi, int read_tdo);
+void urj_jam_jtag_io_tms (int count, unsigned int tms);
+void urj_jam_jtag_io_run (int tms, int32_t count);
 int urj_jam_jtag_io_transfer (int count, char *tdi, char *tdo);
+int urj_jam_jtag_io_capture (int count, char *tdi);
+int urj_jam_jtag_io_collect (int count, char *tdo);
 void urj_jam_message (const char *message_text);
 void urj_jam_export_integer (const char *key, int32_t value);
 void urj_jam_export_boolean_array (char *key, unsigned char *data, int32_t count);
-void urj_jam_flush_and_delay (int32_t microseconds);
-int urj_stapl_run (urj_chain_t *chain, char *STAPL_file_name,
-                   char *STAPL_action);
+double urj_jam_profile_clock (void);
+void urj_jam_export_profile (const char *block, int32_t line, int32_t count,
+                             double seconds, double self_seconds,
+                             int64_t bits);
+void urj_jam_jtag_delay (int32_t microseconds, int tms);
+
+static void *
+urj_stapl_check_crc (void *data)
+{
+    struct stapl_crc *crc = data;
+
+    crc->result = urj_jam_check_crc (crc->program, crc->program_size,
+                                     &crc->expected_crc, &crc->actual_crc);
+
+    return NULL;
+}
+
+static void
+urj_stapl_report_crc (const struct stapl_crc *crc)
+{
+    switch (crc->result)
+    {
+    case JAMC_SUCCESS:
+        urj_log (URJ_LOG_LEVEL_DETAIL,
+                 "CRC matched: CRC value = %04X\n", crc->actual_crc);
+        break;
+
+    case JAMC_CRC_ERROR:
+        urj_log (URJ_LOG_LEVEL_ERROR,
+                 "CRC mismatch: expected %04X, actual %04X\n",
+                 crc->expected_crc, crc->actual_crc);
+        break;
+
+    case JAMC_UNEXPECTED_END:
+        urj_log
+            (URJ_LOG_LEVEL_DETAIL,
+             "Expected CRC not found, actual CRC value = %04X\n",
+             crc->actual_crc);
+        break;
+
+    default:
+        urj_log (URJ_LOG_LEVEL_ERROR,
+                 "CRC function returned error code %d\n", crc->result);
+        break;
+    }
+}
 
 int
 urj_jam_getc (void)
@@ -82,12 +160,30 @@ urj_jam_seek (int32_t offset)
     return return_code;
 }
 
+// Let the time of pending WAITs pass before the TAP is clocked again
+static void
+urj_stapl_wait_deadline (void)
+{
+    long double now;
+
+    if (wait_deadline == 0.0)
+        return;
+
+    now = urj_lib_fmonotime ();
+    if (now < wait_deadline)
+        usleep ((useconds_t) ((wait_deadline - now) * 1e6L + 1.0L));
+
+    wait_deadline = 0.0;
+}
+
 // Bitwise JTAG communication via UrJTAG
 int
 urj_jam_jtag_io (int tms, int tdi, int read_tdo)
 {
     int tdo = 0;
 
+    urj_stapl_wait_deadline ();
+
     if (read_tdo)
     {
         urj_tap_cable_defer_get_tdo (current_cable);
@@ -100,76 +196,153 @@ urj_jam_jtag_io (int tms, int tdi, int read_tdo)
     return tdo;
 }
 
-// Vector-based JTAG communication via UrJTAG
+// TMS sequence (first bit in the LSB) with TDI low, one clock run per
+// group of equal TMS values
+void
+urj_jam_jtag_io_tms (int count, unsigned int tms)
+{
+    int n;
+
+    urj_stapl_wait_deadline ();
+
+    while (count > 0)
+    {
+        for (n = 1; n < count && ((tms >> n) & 1) == (tms & 1); n++)
+            ;
+
+        urj_tap_chain_defer_clock (current_chain, tms & 1, 0, n);
+
+        tms >>= n;
+        count -= n;
+    }
+}
+
+// Run of TCK cycles with constant TMS and TDI low
+void
+urj_jam_jtag_io_run (int tms, int32_t count)
+{
+    urj_stapl_wait_deadline ();
+
+    if (count > 0)
+        urj_tap_chain_defer_clock (current_chain, tms ? 1 : 0, 0, count);
+}
+
+// Vector-based JTAG communication via UrJTAG. The scan is queued with TDO
+// requested, its data is fetched by urj_jam_jtag_io_collect() later, in the
+// same order as the scans were queued
 int
-urj_jam_jtag_io_transfer (int count, char *tdi, char *tdo)
+urj_jam_jtag_io_capture (int count, char *tdi)
 {
     int i = 0;
-    int status = 1;
     char *temp_in;
-    char *temp_out;
+    char tdo_requested = 0;     /* non-NULL out, the cable keeps the data */
 
-    // if no data are requested, only schedule tdo transmit
-    if (tdo == NULL)
+    if (count <= 0)
+        return 1;
+
+    urj_stapl_wait_deadline ();
+
+    temp_in = malloc (count);
+    if (temp_in == NULL)
+        return 0;
+
+    // decode bytes into bits to use them in UrJTAG interface
+    for (i = 0; i < count; i++)
     {
-        for (i = 0; i < count; i++)
-            urj_jam_jtag_io ((i == count - 1),
-                             tdi[i >> 3] & (1 << (i & 7)),
-                             (tdo != NULL));
+        temp_in[i] = tdi[i >> 3] & (1 << (i & 7));
     }
-    else
-    {
-        temp_in = malloc (count);
-        temp_out = malloc (count);
-        if ((temp_in == NULL) || (temp_out == NULL))
-            status = 0;
 
-        if (status != 0)
-        {
-            // decode bytes into bits to use them in UrJTAG interface
-            for (i = 0; i < count; i++)
-            {
-                temp_in[i] = tdi[i >> 3] & (1 << (i & 7));
-            }
+    /* loop in the SHIFT-DR(IR) state, TMS set to 0 */
+    urj_tap_cable_defer_transfer (current_cable, count - 1, temp_in,
+                                  &tdo_requested);
 
-            /* loop in the SHIFT-DR(IR) state, TMS set to 0 */
-            urj_tap_cable_defer_transfer (current_cable, count - 1,
-                                          temp_in, temp_out);
+    // get the last bit in register and change TMS to 1
+    urj_tap_cable_defer_get_tdo (current_cable);
+    urj_tap_chain_defer_clock (current_chain, 1, temp_in[count - 1], 1);
 
+    free (temp_in);
 
-            // get the last bit in register and change TMS to 1
-            urj_tap_cable_defer_get_tdo (current_cable);
-            urj_tap_chain_defer_clock (current_chain, 1, temp_in[count - 1],
-                                       1);
+    return 1;
+}
+
+// TDO of the oldest scan queued by urj_jam_jtag_io_capture(), the cable
+// queue is flushed as far as needed for it
+int
+urj_jam_jtag_io_collect (int count, char *tdo)
+{
+    int i = 0;
+    char *temp_out;
 
-            urj_tap_cable_flush (current_cable, URJ_TAP_CABLE_COMPLETELY);
+    if (count <= 0)
+        return 1;
 
-            urj_tap_cable_transfer_late (current_cable, temp_out);
-            temp_out[count - 1] = urj_tap_cable_get_tdo_late (current_cable);
+    temp_out = malloc (count);
+    if (temp_out == NULL)
+    {
+        /* take the results off the queue anyway */
+        urj_tap_cable_transfer_late (current_cable, NULL);
+        urj_tap_cable_get_tdo_late (current_cable);
+        return 0;
+    }
 
+    urj_tap_cable_transfer_late (current_cable, temp_out);
+    temp_out[count - 1] = urj_tap_cable_get_tdo_late (current_cable);
 
-            // code bits back into bytes for Jam STAPL Player
-            for (i = 0; i < count; i++)
-            {
-                if (temp_out[i])
-                {
-                    tdo[i >> 3] |= (1 << (i & 7));
-                }
-                else
-                {
-                    tdo[i >> 3] &= ~(unsigned int) (1 << (i & 7));
-                }
-            }
-            free (temp_in);
-            free (temp_out);
+    // code bits back into bytes for Jam STAPL Player
+    for (i = 0; i < count; i++)
+    {
+        if (temp_out[i])
+        {
+            tdo[i >> 3] |= (1 << (i & 7));
         }
         else
         {
-            return status;
+            tdo[i >> 3] &= ~(unsigned int) (1 << (i & 7));
         }
     }
 
-    return status;
+    free (temp_out);
+
+    return 1;
+}
+
+int
+urj_jam_jtag_io_transfer (int count, char *tdi, char *tdo)
+{
+    int i = 0;
+    char *temp_in;
+
+    if (count <= 0)
+        return 1;
+
+    if (tdo != NULL)
+        return urj_jam_jtag_io_capture (count, tdi) &&
+            urj_jam_jtag_io_collect (count, tdo);
+
+    urj_stapl_wait_deadline ();
+
+    temp_in = malloc (count);
+    if (temp_in == NULL)
+        return 0;
+
+    // decode bytes into bits to use them in UrJTAG interface
+    for (i = 0; i < count; i++)
+    {
+        temp_in[i] = tdi[i >> 3] & (1 << (i & 7));
+    }
+
+    /* loop in the SHIFT-DR(IR) state, TMS set to 0; without TDO requested
+       the whole scan stays in the cable queue */
+    if (count > 1)
+        urj_tap_cable_defer_transfer (current_cable, count - 1,
+                                      temp_in, NULL);
+
+    // change TMS to 1 with the last bit
+    urj_tap_chain_defer_clock (current_chain, 1, temp_in[count - 1], 1);
+
+    free (temp_in);
+
+    return 1;
 }
 
 void
@@ -185,6 +358,29 @@ urj_jam_export_integer (const char *key, int32_t value)
              value);
 }
 
+double
+urj_jam_profile_clock (void)
+{
+    return (double) urj_lib_fmonotime ();
+}
+
+void
+urj_jam_export_profile (const char *block, int32_t line, int32_t count,
+                        double seconds, double self_seconds, int64_t bits)
+{
+    if (profile_file == NULL)
+        return;
+
+    if (line == 0)
+        fprintf (profile_file, "{\"procedure\":{\"name\":\"%s\",\"count\":%d,"
+                 "\"time_us\":%.0f,\"self_time_us\":%.0f,\"bits\":%" PRId64
+                 "}}\n", block, count, seconds * 1e6, self_seconds * 1e6, bits);
+    else
+        fprintf (profile_file, "{\"line\":{\"number\":%d,\"procedure\":\"%s\","
+                 "\"count\":%d,\"time_us\":%.0f,\"bits\":%" PRId64 "}}\n",
+                 line, block, count, seconds * 1e6, bits);
+}
+
 #define HEX_LINE_CHARS 72
 #define HEX_LINE_BITS (HEX_LINE_CHARS * 4)
 
@@ -265,11 +461,34 @@ urj_jam_export_boolean_array (char *key, unsigned char *data, int32_t count)
     }
 }
 
+// Stay in the current stable state for at least the given time. With a
+// known TCK frequency short waits become clocks in the state, which stay
+// in the cable queue. Otherwise the queue is sent and the time is added to
+// a deadline which is only waited for when the TAP is clocked again, so
+// that consecutive WAITs sleep once. A negative tms means that the TAP
+// must not be clocked.
 void
-urj_jam_flush_and_delay (int32_t microseconds)
+urj_jam_jtag_delay (int32_t microseconds, int tms)
 {
+    uint32_t frequency = urj_tap_cable_get_frequency (current_cable);
+    double clocks = (double) microseconds * frequency / 1e6;
+    long double now;
+
+    if (microseconds <= 0)
+        return;
+
+    if (tms >= 0 && frequency > 0 && clocks <= STAPL_MAX_WAIT_CLOCKS)
+    {
+        urj_jam_jtag_io_run (tms, (int32_t) ceil (clocks));
+        return;
+    }
+
     urj_tap_cable_flush (current_cable, URJ_TAP_CABLE_COMPLETELY);
-    usleep (microseconds);
+
+    now = urj_lib_fmonotime ();
+    if (wait_deadline < now)
+        wait_deadline = now;
+    wait_deadline += microseconds / 1e6L;
 }
 
 static const char * const error_text[] = {
@@ -340,7 +559,8 @@ static const char * const exit_text_vd[] = {
  *
  **********************************************************************/
 /* *********************************************************************
- * urj_stapl_run (chain, STAPL_file_name, STAPL_action);
+ * urj_stapl_run_profile (chain, STAPL_file_name, STAPL_action,
+ *                        PROFILE_FILE);
  *
  * Main entry point for the 'stapl' command. Calls the stapl parser.
  *
@@ -354,22 +574,27 @@ static const char * const exit_text_vd[] = {
  *   stop_on_mismatch : 1 = stop upon tdo mismatch
  *                      0 = continue upon mismatch
  *   ref_freq         : reference frequency for RUNTEST
+ *   PROFILE_FILE     : file handle for the execution profile, NULL for
+ *                      none
  *
  * Return value:
  *   URJ_STATUS_OK, URJ_STATUS_FAIL
  * ********************************************************************/
 int
-urj_stapl_run (urj_chain_t *chain, char *STAPL_file_name, char *STAPL_action)
+urj_stapl_run_profile (urj_chain_t *chain, char *STAPL_file_name,
+                       char *STAPL_action, FILE *PROFILE_FILE)
 {
 
     bool help = false;
     char *filename = NULL;
     int32_t offset = 0L;
     int32_t error_line = 0L;
-    JAM_RETURN_TYPE crc_result = JAMC_SUCCESS;
     JAM_RETURN_TYPE exec_result = JAMC_SUCCESS;
-    unsigned short expected_crc = 0;
-    unsigned short actual_crc = 0;
+    struct stapl_crc crc = { NULL, 0L, 0, 0, JAMC_SUCCESS };
+#ifdef HAVE_PTHREAD
+    pthread_t crc_thread;
+#endif
+    bool crc_pending = false;
     char key[33] = { 0 };
     char value[257] = { 0 };
     int exit_status = 0;
@@ -378,14 +603,13 @@ urj_stapl_run (urj_chain_t *chain, char *STAPL_file_name, char *STAPL_action)
     time_t start_time = 0;
     time_t end_time = 0;
     int time_delta = 0;
-    char *workspace = NULL;
     char *action = NULL;
     char *init_list[10];
     FILE *fp = NULL;
     struct stat sbuf;
-    int32_t workspace_size = 0;
     const char *exit_string = NULL;
     int reset_jtag = 1;
+    int result = URJ_STATUS_OK;
 
     init_list[0] = NULL;
 
@@ -425,15 +649,6 @@ urj_stapl_run (urj_chain_t *chain, char *STAPL_file_name, char *STAPL_action)
     {
         exit_status = 1;
     }
-    else if ((workspace_size > 0) &&
-             ((workspace =
-               (char *) malloc ((size_t) workspace_size)) == NULL))
-    {
-        urj_log (URJ_LOG_LEVEL_ERROR,
-                 "Error: can't allocate memory (%d Kbytes)\n",
-                 (int) (workspace_size / 1024L));
-        exit_status = 1;
-    }
     else if (access (filename, 0) != 0)
     {
         urj_log (URJ_LOG_LEVEL_ERROR, "Error: can't access file \"%s\"\n",
@@ -455,10 +670,25 @@ urj_stapl_run (urj_chain_t *chain, char *STAPL_file_name, char *STAPL_action)
         else
         {
             /*
-             *  Read entire file into a buffer
+             *  Map the file, or read entire file into a buffer
              */
+            file_buffer = NULL;
+            file_mapped = false;
 
-            file_buffer = (char *) malloc ((size_t) file_length);
+#if defined HAVE_MMAP && defined HAVE_SYS_MMAN_H
+            if (file_length > 0)
+            {
+                file_buffer = mmap (NULL, (size_t) file_length, PROT_READ,
+                                    MAP_PRIVATE, fileno (fp), 0);
+                if (file_buffer == MAP_FAILED)
+                    file_buffer = NULL;
+                else
+                    file_mapped = true;
+            }
+#endif
+
+            if (file_buffer == NULL)
+                file_buffer = (char *) malloc ((size_t) file_length);
 
             if (file_buffer == NULL)
             {
@@ -467,7 +697,7 @@ urj_stapl_run (urj_chain_t *chain, char *STAPL_file_name, char *STAPL_action)
                          (int) (file_length / 1024L));
                 exit_status = 1;
             }
-            else
+            else if (!file_mapped)
             {
                 if (fread (file_buffer, 1, (size_t) file_length, fp) !=
                     (size_t) file_length)
@@ -484,35 +714,20 @@ urj_stapl_run (urj_chain_t *chain, char *STAPL_file_name, char *STAPL_action)
         if (exit_status == 0)
         {
             /*
-             *  Check CRC
+             *  Check CRC.  The whole file is read for it, so it is done by
+             *  a helper thread while the program starts, and reported when
+             *  the program has finished.
              */
-            crc_result = urj_jam_check_crc (file_buffer, file_length,
-                                        &expected_crc, &actual_crc);
-
-            switch (crc_result)
+            crc.program = file_buffer;
+            crc.program_size = file_length;
+#ifdef HAVE_PTHREAD
+            crc_pending = (pthread_create (&crc_thread, NULL,
+                                           urj_stapl_check_crc, &crc) == 0);
+#endif
+            if (!crc_pending)
             {
-            case JAMC_SUCCESS:
-                urj_log (URJ_LOG_LEVEL_DETAIL,
-                         "CRC matched: CRC value = %04X\n", actual_crc);
-                break;
-
-            case JAMC_CRC_ERROR:
-                urj_log (URJ_LOG_LEVEL_ERROR,
-                         "CRC mismatch: expected %04X, actual %04X\n",
-                         expected_crc, actual_crc);
-                break;
-
-            case JAMC_UNEXPECTED_END:
-                urj_log
-                    (URJ_LOG_LEVEL_DETAIL,
-                     "Expected CRC not found, actual CRC value = %04X\n",
-                     actual_crc);
-                break;
-
-            default:
-                urj_log (URJ_LOG_LEVEL_ERROR,
-                         "CRC function returned error code %d\n", crc_result);
-                break;
+                urj_stapl_check_crc (&crc);
+                urj_stapl_report_crc (&crc);
             }
 
             /*
@@ -528,22 +743,46 @@ urj_stapl_run (urj_chain_t *chain, char *STAPL_file_name, char *STAPL_action)
             // Execute the JAM program
             time (&start_time);
 
-            exec_result = urj_jam_execute (file_buffer, file_length,
-                                       workspace, workspace_size, action,
+            profile_file = PROFILE_FILE;
+            urj_jam_set_profile (PROFILE_FILE != NULL);
+            wait_deadline = 0.0;
+
+            exec_result = urj_jam_execute (file_buffer, file_length, action,
                                        init_list, reset_jtag, &error_line,
                                        &exit_code, &format_version);
 
+            /* a final WAIT still has to pass */
+            urj_stapl_wait_deadline ();
+
+            urj_jam_set_profile (0);
+            profile_file = NULL;
+
             time (&end_time);
 
+#ifdef HAVE_PTHREAD
+            if (crc_pending)
+            {
+                pthread_join (crc_thread, NULL);
+                urj_stapl_report_crc (&crc);
+            }
+#endif
+
             if (exec_result == JAMC_SUCCESS)
             {
+                /* codes beyond the table are "Unknown exit code" */
                 if (format_version == 2)
                 {
-                    exit_string = exit_text_v2[exit_code];
+                    exit_string = exit_text_v2[
+                        ((exit_code < 0) ||
+                         (exit_code >= (int) ARRAY_SIZE(exit_text_v2)))
+                        ? (int) ARRAY_SIZE(exit_text_v2) - 1 : exit_code];
                 }
                 else
                 {
-                    exit_string = exit_text_vd[exit_code];
+                    exit_string = exit_text_vd[
+                        ((exit_code < 0) ||
+                         (exit_code >= (int) ARRAY_SIZE(exit_text_vd)))
+                        ? (int) ARRAY_SIZE(exit_text_vd) - 1 : exit_code];
                 }
 
                 urj_log (URJ_LOG_LEVEL_NORMAL, "Exit code = %d... %s\n",
@@ -588,12 +827,52 @@ urj_stapl_run (urj_chain_t *chain, char *STAPL_file_name, char *STAPL_action)
         }
     }
 
-    if (workspace != NULL)
-        free (workspace);
     if (file_buffer != NULL)
-        free (file_buffer);
+    {
+#if defined HAVE_MMAP && defined HAVE_SYS_MMAN_H
+        if (file_mapped)
+            munmap (file_buffer, (size_t) file_length);
+        else
+#endif
+            free (file_buffer);
+        file_buffer = NULL;
+    }
 
     urj_log (URJ_LOG_LEVEL_NORMAL, "STAPL execution finished \n");
 
-    return URJ_STATUS_OK;
+    /* a device that failed must not pass, e.g. in a gang programmer */
+    if (exit_status != 0)
+    {
+        urj_error_set (URJ_ERROR_STAPL, "%s: cannot load file '%s'",
+                       "stapl", filename ? filename : "");
+        result = URJ_STATUS_FAIL;
+    }
+    else if (exec_result != JAMC_SUCCESS)
+    {
+        urj_error_set (URJ_ERROR_STAPL, "%s: error on line %d: %s", "stapl",
+                       error_line, exec_result < ARRAY_SIZE(error_text)
+                       ? error_text[exec_result] : "unknown error");
+        result = URJ_STATUS_FAIL;
+    }
+    else if (exit_code != 0)
+    {
+        urj_error_set (URJ_ERROR_STAPL, "%s: exit code %d: %s", "stapl",
+                       exit_code, exit_string);
+        result = URJ_STATUS_FAIL;
+    }
+    else if ((crc.result != JAMC_SUCCESS) &&
+             (crc.result != JAMC_UNEXPECTED_END))
+    {
+        urj_error_set (URJ_ERROR_STAPL, "%s: CRC check of '%s' failed",
+                       "stapl", filename);
+        result = URJ_STATUS_FAIL;
+    }
+
+    return result;
+}
+
+int
+urj_stapl_run (urj_chain_t *chain, char *STAPL_file_name, char *STAPL_action)
+{
+    return urj_stapl_run_profile (chain, STAPL_file_name, STAPL_action, NULL);
 }
@@ -32,18 +32,16 @@
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <inttypes.h>
 #include <math.h>
-#include <signal.h>
 #include <unistd.h>
 #include <sys/types.h>
-#ifndef SA_ONESHOT
-#define SA_ONESHOT SA_RESETHAND
-#endif
 
 #include <urjtag/error.h>
 #include <urjtag/cable.h>
 #include <urjtag/part.h>
 #include <urjtag/tap_state.h>
+#include <urjtag/tap.h>
 #include <urjtag/tap_register.h>
 #include <urjtag/part_instruction.h>
 #include <urjtag/data_register.h>
@@ -67,6 +65,27 @@
 /* define for debug messages */
 #undef DEBUG
 
+/* Upper limits for SIR/SDR commands whose TDO check is deferred.
+   Each of them occupies two entries of the cable's result queue. */
+#define URJ_SVF_PENDING_TDO_MAX         32
+#define URJ_SVF_PENDING_TDO_MAX_BITS    (1L << 20)
+
+/* Number of chunks a RUNTEST with maximum time is initially divided into.
+   The elapsed time is checked after each chunk. */
+#define URJ_SVF_MAXTIME_CHUNKS          16
+
+struct svf_pending_tdo
+{
+    urj_tap_register_t *out;    /* captured bits of the whole chain */
+    int offset;                 /* position of the part's register in out */
+    int len;                    /* length of the part's register */
+    const uint8_t *tdo;         /* packed expected values, LSB first */
+    const uint8_t *mask;
+    int owned;                  /* tdo and mask have to be free'd */
+    YYLTYPE loc;
+    int have_loc;
+};
+
 
 int urj_svf_parse (urj_svf_parser_priv_t *priv_data, urj_chain_t *chain);
 
@@ -76,16 +95,36 @@ int urj_svf_parse (urj_svf_parser_priv_t *priv_data, urj_chain_t *chain);
  *
  * Puts TAP controller into reset state by clocking 5 times with TMS = 1.
  */
-static void
-urj_svf_force_reset_state (urj_chain_t *chain)
+void
+urj_svf_force_reset_state (urj_chain_t *chain, urj_svf_parser_priv_t *priv)
 {
-    urj_tap_chain_clock (chain, 1, 0, 5);
+    if (priv->compile)
+        urj_svf_compile_reset (priv->compile);
+    else
+        urj_tap_chain_clock (chain, 1, 0, 5);
     urj_tap_state_reset (chain);
 }
 
 
 /*
- * urj_svf_goto_state(state)
+ * urj_svf_clock(chain, priv, tms, n)
+ *
+ * Clocks the chain n times with the given TMS value and TDI = 0, or records
+ * this in the compiled output when compiling.
+ */
+void
+urj_svf_clock (urj_chain_t *chain, urj_svf_parser_priv_t *priv, int tms,
+               uint32_t n)
+{
+    if (priv->compile)
+        urj_svf_compile_clock (chain, priv->compile, tms, n);
+    else
+        CHAIN_CLOCK (chain, tms, 0, n);
+}
+
+
+/*
+ * urj_svf_goto_state(chain, priv, state)
  *
  * Moves from any TAP state to the specified state.
  * The state traversal is done according to the SVF specification.
@@ -96,8 +135,9 @@ urj_svf_force_reset_state (urj_chain_t *chain)
  * Parameter:
  *   state : new TAP controller state
  */
-static void
-urj_svf_goto_state (urj_chain_t *chain, int new_state)
+void
+urj_svf_goto_state (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+                    int new_state)
 {
     int current_state;
 
@@ -111,14 +151,22 @@ urj_svf_goto_state (urj_chain_t *chain, int new_state)
     if (current_state == new_state)
         return;
 
+    /* the compiled file may be played from any state, so the path from an
+       unknown state is left to the player */
+    if (priv->compile && current_state == URJ_TAP_STATE_UNKNOWN_STATE)
+    {
+        urj_svf_compile_goto (chain, priv->compile, new_state);
+        return;
+    }
+
     switch (current_state)
     {
     case URJ_TAP_STATE_TEST_LOGIC_RESET:
-        CHAIN_CLOCK (chain, 0, 0, 1);
+        urj_svf_clock (chain, priv, 0, 1);
         break;
 
     case URJ_TAP_STATE_RUN_TEST_IDLE:
-        CHAIN_CLOCK (chain, 1, 0, 1);
+        urj_svf_clock (chain, priv, 1, 1);
         break;
 
     case URJ_TAP_STATE_SELECT_DR_SCAN:
@@ -129,95 +177,95 @@ urj_svf_goto_state (urj_chain_t *chain, int new_state)
             || (current_state & URJ_TAP_STATE_IR
                 && new_state & URJ_TAP_STATE_DR))
             /* progress in select-idle/reset loop */
-            CHAIN_CLOCK (chain, 1, 0, 1);
+            urj_svf_clock (chain, priv, 1, 1);
         else
             /* enter DR/IR branch */
-            CHAIN_CLOCK (chain, 0, 0, 1);
+            urj_svf_clock (chain, priv, 0, 1);
         break;
 
     case URJ_TAP_STATE_CAPTURE_DR:
         if (new_state == URJ_TAP_STATE_SHIFT_DR)
             /* enter URJ_TAP_STATE_SHIFT_DR state */
-            CHAIN_CLOCK (chain, 0, 0, 1);
+            urj_svf_clock (chain, priv, 0, 1);
         else
             /* bypass URJ_TAP_STATE_SHIFT_DR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
+            urj_svf_clock (chain, priv, 1, 1);
         break;
 
     case URJ_TAP_STATE_CAPTURE_IR:
         if (new_state == URJ_TAP_STATE_SHIFT_IR)
             /* enter URJ_TAP_STATE_SHIFT_IR state */
-            CHAIN_CLOCK (chain, 0, 0, 1);
+            urj_svf_clock (chain, priv, 0, 1);
         else
             /* bypass URJ_TAP_STATE_SHIFT_IR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
+            urj_svf_clock (chain, priv, 1, 1);
         break;
 
     case URJ_TAP_STATE_SHIFT_DR:
     case URJ_TAP_STATE_SHIFT_IR:
         /* progress to URJ_TAP_STATE_EXIT1_DR/IR */
-        CHAIN_CLOCK (chain, 1, 0, 1);
+        urj_svf_clock (chain, priv, 1, 1);
         break;
 
     case URJ_TAP_STATE_EXIT1_DR:
         if (new_state == URJ_TAP_STATE_PAUSE_DR)
             /* enter URJ_TAP_STATE_PAUSE_DR state */
-            CHAIN_CLOCK (chain, 0, 0, 1);
+            urj_svf_clock (chain, priv, 0, 1);
         else
             /* bypass URJ_TAP_STATE_PAUSE_DR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
+            urj_svf_clock (chain, priv, 1, 1);
         break;
 
     case URJ_TAP_STATE_EXIT1_IR:
         if (new_state == URJ_TAP_STATE_PAUSE_IR)
             /* enter URJ_TAP_STATE_PAUSE_IR state */
-            CHAIN_CLOCK (chain, 0, 0, 1);
+            urj_svf_clock (chain, priv, 0, 1);
         else
             /* bypass URJ_TAP_STATE_PAUSE_IR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
+            urj_svf_clock (chain, priv, 1, 1);
         break;
 
     case URJ_TAP_STATE_PAUSE_DR:
     case URJ_TAP_STATE_PAUSE_IR:
         /* progress to URJ_TAP_STATE_EXIT2_DR/IR */
-        CHAIN_CLOCK (chain, 1, 0, 1);
+        urj_svf_clock (chain, priv, 1, 1);
         break;
 
     case URJ_TAP_STATE_EXIT2_DR:
         if (new_state == URJ_TAP_STATE_SHIFT_DR)
             /* enter URJ_TAP_STATE_SHIFT_DR state */
-            CHAIN_CLOCK (chain, 0, 0, 1);
+            urj_svf_clock (chain, priv, 0, 1);
         else
             /* progress to URJ_TAP_STATE_UPDATE_DR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
+            urj_svf_clock (chain, priv, 1, 1);
         break;
 
     case URJ_TAP_STATE_EXIT2_IR:
         if (new_state == URJ_TAP_STATE_SHIFT_IR)
             /* enter URJ_TAP_STATE_SHIFT_IR state */
-            CHAIN_CLOCK (chain, 0, 0, 1);
+            urj_svf_clock (chain, priv, 0, 1);
         else
             /* progress to URJ_TAP_STATE_UPDATE_IR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
+            urj_svf_clock (chain, priv, 1, 1);
         break;
 
     case URJ_TAP_STATE_UPDATE_DR:
     case URJ_TAP_STATE_UPDATE_IR:
         if (new_state == URJ_TAP_STATE_RUN_TEST_IDLE)
             /* enter URJ_TAP_STATE_RUN_TEST_IDLE */
-            CHAIN_CLOCK (chain, 0, 0, 1);
+            urj_svf_clock (chain, priv, 0, 1);
         else
             /* progress to Select_DR/IR */
-            CHAIN_CLOCK (chain, 1, 0, 1);
+            urj_svf_clock (chain, priv, 1, 1);
         break;
 
     default:
-        urj_svf_force_reset_state (chain);
+        urj_svf_force_reset_state (chain, priv);
         break;
     }
 
     /* continue state changes */
-    urj_svf_goto_state (chain, new_state);
+    urj_svf_goto_state (chain, priv, new_state);
 }
 
 
@@ -300,486 +348,1179 @@ urj_svf_map_state (int state)
 
 
 /*
- * urj_svf_hex2dec(nibble)
- *
- * Converts a hexadecimal nibble (4 bits) to its decimal value.
- *
- * Parameter:
- *   nibble : hexadecimal character
+ * urj_svf_nibble[]
  *
- * Return value:
- *   decimal value of nibble or 0 if nibble is not a hexadecimal character
+ * Maps a hexadecimal character to its value. All other characters map to 0.
  */
-static int
-urj_svf_hex2dec (char nibble)
-{
-    int lower;
+static const unsigned char urj_svf_nibble[256] = {
+    ['0'] = 0, ['1'] = 1, ['2'] = 2, ['3'] = 3, ['4'] = 4,
+    ['5'] = 5, ['6'] = 6, ['7'] = 7, ['8'] = 8, ['9'] = 9,
+    ['a'] = 10, ['b'] = 11, ['c'] = 12, ['d'] = 13, ['e'] = 14, ['f'] = 15,
+    ['A'] = 10, ['B'] = 11, ['C'] = 12, ['D'] = 13, ['E'] = 14, ['F'] = 15,
+};
 
-    if (nibble >= '0' && nibble <= '9')
-        return ((int) (nibble - '0'));
-
-    lower = tolower ((int) nibble);
-    if (lower >= 'a' && lower <= 'f')
-        return (lower - (int) 'a' + 10);
-
-    return 0;
-}
+#define URJ_SVF_NIBBLE(c) (urj_svf_nibble[(unsigned char) (c)])
 
 
 /*
- * urj_svf_build_bit_string(hex_string, len)
- *
- * Converts the hexadecimal string hex_string into a string of single bits
- * with len elements (bits).
- * If hex_string contains less nibbles than fit into len bits, the resulting
- * bit string is padded with 0 bits.
+ * urj_svf_alloc_value(nibbles)
  *
- * Note:
- * The memory for the resulting bit string is calloc'ed and must be
- * free'd when the bit string is not used anymore.
- *
- * Example:
- *   hex string : 1a
- *   len        : 16
- *   bit string : 0000000000011010
- *
- * Parameter:
- *   hex_string : hex string to be converted
- *   len        : number of bits in resulting bit string
+ * Allocates a value for the given number of hexadecimal digits, cleared
+ * to 0. The data is part of the same block, free() releases both.
  *
  * Return value:
- *   pointer to new bit string
+ *   pointer to the value
  *   NULL upon error
  */
-static char *
-urj_svf_build_bit_string (char *hex_string, int len)
+static struct hexa_value *
+urj_svf_alloc_value (size_t nibbles)
 {
-    char *bit_string, *bit_string_pos;
-    int nibble;
-    char *hex_string_pos;
-    int hex_string_idx;
+    size_t bytes = (nibbles + 1) / 2;
+    struct hexa_value *value;
 
-    if (!(bit_string = calloc (len + 1, sizeof (char))))
+    if (!(value = calloc (1, sizeof *value + bytes)))
     {
         urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd,%zd) fails",
-                       (size_t) (len + 1), sizeof (char));
+                       (size_t) 1, sizeof *value + bytes);
         return NULL;
     }
+    value->bits = (int) nibbles * 4;
+    value->data = (uint8_t *) (value + 1);
 
-    /* copy reduced hexadecimal string to full bit string */
-    hex_string_idx = strlen (hex_string);
-    hex_string_pos = &(hex_string[hex_string_idx]);
-    nibble = 3;
-    bit_string_pos = &(bit_string[len]);
-    do
-    {
-        bit_string_pos--;
-        if (nibble == 3)
-        {
-            nibble = 0;
-            hex_string_pos--;
-            hex_string_idx--;
-        }
-        else
-            nibble++;
-
-        *bit_string_pos =
-            urj_svf_hex2dec (hex_string_idx >= 0 ? *hex_string_pos : '0')
-            & (1 << nibble) ? '1' : '0';
-    }
-    while (bit_string_pos != bit_string);
+    return value;
+}
 
-    bit_string[len] = '\0';
 
-    return bit_string;
+/*
+ * urj_svf_hexa_free(frag)
+ *
+ * Releases the pieces of a hexadecimal value that has not been decoded.
+ */
+void
+urj_svf_hexa_free (struct hexa_frag *frag)
+{
+    size_t i;
+
+    if (frag->owned)
+        for (i = 0; i < frag->num; i++)
+            free ((char *) frag->pieces[i].ptr);
+    free (frag->pieces);
+    frag->pieces = NULL;
+    frag->num = frag->alloc = 0;
 }
 
 
 /*
- * urj_svf_copy_hex_to_register(hex_string, reg)
- *
- * Copies the contents of the hexadecimal string hex_string into the given
- * tap register.
+ * urj_svf_hexa_decode(frag)
  *
- * Parameter:
- *   hex_string : hex string to be entered in reg
- *   reg        : tap register to hold the converted hex string
+ * Decodes the pieces of a hexadecimal value as returned by the scanner.
+ * The nibbles are stored straight into the packed result, starting with
+ * the least significant one at the end of the last piece. White space
+ * between the digits is skipped. The pieces are released in any case.
  *
  * Return value:
- *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ *   pointer to the value, to be free'd by the caller
+ *   NULL upon error
  */
-static int
-urj_svf_copy_hex_to_register (char *hex_string, urj_tap_register_t *reg)
+struct hexa_value *
+urj_svf_hexa_decode (struct hexa_frag *frag)
 {
-    char *bit_string;
+    struct hexa_value *value;
+    size_t chars = 0, pos = 0, i;
 
-    if (!(bit_string = urj_svf_build_bit_string (hex_string, reg->len)))
-        return URJ_STATUS_FAIL;
+    /* white space makes this an upper bound of the digits */
+    for (i = 0; i < frag->num; i++)
+        chars += frag->pieces[i].len;
+
+    if ((value = urj_svf_alloc_value (chars)) != NULL)
+    {
+        for (i = frag->num; i-- > 0;)
+        {
+            const char *start = frag->pieces[i].ptr;
+            const char *hex_pos = start + frag->pieces[i].len;
+
+            while (hex_pos > start)
+            {
+                unsigned char c = *--hex_pos;
 
-    urj_tap_register_init (reg, bit_string);
+                if (isxdigit (c))
+                {
+                    value->data[pos / 2] |= URJ_SVF_NIBBLE (c) << (pos % 2 * 4);
+                    pos++;
+                }
+            }
+        }
+        value->bits = (int) pos * 4;
+    }
 
-    /* free memory as we do not need the intermediate bit_string anymore */
-    free (bit_string);
+    urj_svf_hexa_free (frag);
 
-    return URJ_STATUS_OK;
+    return value;
 }
 
 
 /*
- * urj_svf_compare_tdo(tdo, mask, reg)
+ * urj_svf_value_to_packed(value, len)
  *
- * Compares the captured device output in tap register reg with the expected
- * hex_string tdo (specified in SVF command SDR/SDI.
+ * Converts value into len bits packed into bytes, least significant bit
+ * first. Missing nibbles are taken as 0, surplus ones are ignored.
  *
- * Comparison honours the "care" bits in mask ('1') while matching the contents
- * of reg with tdo.
+ * Note:
+ * The memory for the result is malloc'ed and must be free'd by the caller.
  *
  * Parameter:
- *   tdo  : reference hex string
- *   mask : hex string for masking tdo
- *   reg  : hex string to be compared vs. tdo
+ *   value : value of TDI, TDO, MASK or SMASK
+ *   len   : number of bits
  *
  * Return value:
- *   URJ_STATUS_OK   : tdo matches reg at all positions where mask is '1'
- *   URJ_STATUS_FAIL : tdo and reg do not match or error occurred
+ *   pointer to (len + 7) / 8 bytes
+ *   NULL upon error
  */
-static int
-urj_svf_compare_tdo (urj_svf_parser_priv_t *priv, char *tdo, char *mask,
-                     urj_tap_register_t *reg, YYLTYPE *loc)
+uint8_t *
+urj_svf_value_to_packed (const struct hexa_value *value, int len)
 {
-    char *tdo_bit, *mask_bit;
-    int pos, mismatch, result = URJ_STATUS_OK;
+    size_t bytes = (len + 7) / 8;
+    size_t have = (value->bits + 7) / 8;
+    uint8_t *packed;
 
-    if (!(tdo_bit = urj_svf_build_bit_string (tdo, reg->len)))
-        return URJ_STATUS_FAIL;
-    if (!(mask_bit = urj_svf_build_bit_string (mask, reg->len)))
+    if (!(packed = malloc (bytes > 0 ? bytes : 1)))
     {
-        free (tdo_bit);
-        return URJ_STATUS_FAIL;
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails", bytes);
+        return NULL;
     }
 
-    /* retrieve string representation */
-    urj_tap_register_get_string (reg);
-
-    mismatch = -1;
-    for (pos = 0; pos < reg->len; pos++)
-        if ((tdo_bit[pos] != reg->string[pos]) && (mask_bit[pos] == '1'))
-            mismatch = pos;
-
-    if (mismatch >= 0)
+    /* the bits above value->bits are 0 already */
+    if (have >= bytes)
+        memcpy (packed, value->data, bytes);
+    else
     {
-        urj_log (URJ_LOG_LEVEL_NORMAL,
-                 _("Error %s: mismatch at position %d for TDO\n"), "svf",
-                mismatch);
-        if (loc != NULL)
-        {
-            urj_log (URJ_LOG_LEVEL_NORMAL,
-                " in input file between line %d col %d and line %d col %d\n",
-                loc->first_line + 1, loc->first_column + 1,
-                loc->last_line + 1, loc->last_column + 1);
-        }
+        memcpy (packed, value->data, have);
+        memset (packed + have, 0, bytes - have);
+    }
+    if (len % 8)
+        packed[bytes - 1] &= (1 << (len % 8)) - 1;
 
-        urj_log (URJ_LOG_LEVEL_DEBUG, "Expected : %s\n", tdo_bit);
-        urj_log (URJ_LOG_LEVEL_DEBUG, "Mask     : %s\n", mask_bit);
-        urj_log (URJ_LOG_LEVEL_DEBUG, "TDO data : %s\n", reg->string);
+    return packed;
+}
 
-        if (priv->svf_stop_on_mismatch)
-            result = URJ_STATUS_FAIL;
-    }
 
-    free (mask_bit);
-    free (tdo_bit);
+/*
+ * urj_svf_unpack(packed, bits, len)
+ *
+ * Stores len packed bits (LSB first) one per char at bits.
+ */
+static void
+urj_svf_unpack (const uint8_t *packed, char *bits, int len)
+{
+    int i;
 
-    return result;
+    for (i = 0; i < len; i++)
+        bits[i] = (packed[i / 8] >> (i % 8)) & 1;
 }
 
 
 /*
- * urj_svf_remember_param(rem, new)
- *
- * Assigns the contents of the string new to the string rem.
- * By doing so, the responsability to free the memory occupied by new
- * is transferred to the code that handles *rem.
- * Nothing happens when new is NULL. In this case the current value of
- * rem has to be "remembered".
+ * urj_svf_pack_at(packed, offset, src, len)
  *
- * Parameter:
- *   rem : hex string pointer pointing to the "remembered" string
- *   new : hex string that has to be rememberd
- *         memory of the string is free'd
+ * Ors len packed bits from src into packed, starting at bit offset.
  */
 static void
-urj_svf_remember_param (char **rem, char *new)
+urj_svf_pack_at (uint8_t *packed, int offset, const uint8_t *src, int len)
 {
-    if (new)
-    {
-        if (*rem)
-            free (*rem);
+    int i;
 
-        *rem = new;
-    }
+    for (i = 0; i < len; i++, offset++)
+        packed[offset / 8] |= ((src[i / 8] >> (i % 8)) & 1) << (offset % 8);
 }
 
 
 /*
- * urj_svf_all_care(string, number)
- *
- * Allocates a hex string of given length (number gives number of bits)
- * and sets it to all 'F'.
- * The allocated memory of the string has to be free'd by the caller.
- *
- * Parameter:
- *   string : is updated with the pointer to the allocated hex string
- *   number : number of required bits
+ * urj_svf_packed_to_register(packed, reg)
  *
- * Return value:
- *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ * Loads the packed bits (LSB first) into the tap register reg.
  */
-static int
-urj_svf_all_care (char **string, double number)
+void
+urj_svf_packed_to_register (const uint8_t *packed, urj_tap_register_t *reg)
 {
-    char *ptr;
-    int num;
-
-    num = (int) number;
-    num = num % 4 == 0 ? num / 4 : num / 4 + 1;
+    urj_svf_unpack (packed, reg->data, reg->len);
+}
 
-    /* build string with all cares */
-    if (!(ptr = calloc (num + 1, sizeof (char))))
-    {
-        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("calloc(%zd,%zd) fails"),
-                       (size_t) (num + 1), sizeof (char));
-        return URJ_STATUS_FAIL;
-    }
-    memset (ptr, 'F', num);
-    ptr[num] = '\0';
 
-    urj_svf_remember_param (string, ptr);
-    /* responsability for free'ing ptr is now at the code that
-       operates on *string */
+/*
+ * urj_svf_value_to_bits(value, bits, len)
+ *
+ * Stores the len least significant bits of value one per char at bits.
+ * Missing nibbles are taken as 0.
+ */
+static void
+urj_svf_value_to_bits (const struct hexa_value *value, char *bits, int len)
+{
+    int have = value->bits < len ? value->bits : len;
 
-    return URJ_STATUS_OK;
+    urj_svf_unpack (value->data, bits, have);
+    memset (bits + have, 0, len - have);
 }
 
 
-/* ***************************************************************************
- * urj_svf_endxr(ir_dr, state)
- *
- * Register end states for shifting IR and DR.
+/*
+ * urj_svf_register_to_packed(reg, packed)
  *
- * Parameter:
- *   ir_dr : selects ENDIR or ENDDR
- *   state : required end state (SVF parser encoding)
- * ***************************************************************************/
+ * Stores the bits of the tap register reg into (reg->len + 7) / 8 bytes at
+ * packed, LSB first.
+ */
 void
-urj_svf_endxr (urj_svf_parser_priv_t *priv, enum generic_irdr_coding ir_dr,
-               int state)
+urj_svf_register_to_packed (const urj_tap_register_t *reg, uint8_t *packed)
 {
-    switch (ir_dr)
-    {
-    case generic_ir:
-        priv->endir = urj_svf_map_state (state);
-        break;
-    case generic_dr:
-        priv->enddr = urj_svf_map_state (state);
-        break;
-    }
+    int i;
+
+    memset (packed, 0, (reg->len + 7) / 8);
+    for (i = 0; i < reg->len; i++)
+        packed[i / 8] |= (reg->data[i] & 1) << (i % 8);
 }
 
 
-/* ***************************************************************************
- * urj_svf_frequency(chain, freq)
- *
- * Implements the FREQUENCY command.
+/*
+ * urj_svf_packed_string(packed, len)
  *
- * Parameter:
- *   freq : frequency in HZ
- * ***************************************************************************/
-void
-urj_svf_frequency (urj_chain_t *chain, double freq)
+ * Builds the '0'/'1' string representation (MSB first) of len packed bits
+ * for diagnostic messages. The result must be free'd by the caller.
+ */
+static char *
+urj_svf_packed_string (const uint8_t *packed, int len)
 {
-    urj_tap_cable_set_frequency (chain->cable, freq);
+    char *string;
+    int i;
+
+    if (!(string = malloc (len + 1)))
+        return NULL;
+
+    for (i = 0; i < len; i++)
+        string[len - 1 - i] = (packed[i / 8] >> (i % 8)) & 1 ? '1' : '0';
+    string[len] = '\0';
+
+    return string;
 }
 
 
-/* ***************************************************************************
- * urj_svf_hxr(ir_dr, params)
- *
- * Handles HIR, HDR.
- *
- * Note:
- * Functionality not implemented.
+/*
+ * urj_svf_match_tdo(tdo, mask, data, len)
  *
- * Parameter:
- *   ir_dr  : selects HIR or HDR
- *   params : paramter set for TXR, HXR and SXR
+ * Compares the captured device output of len bits in data with the expected
+ * values tdo where mask is set. This is done as a masked XOR 64 bits at a
+ * time; the mismatch position is only determined when a difference was
+ * found.
  *
  * Return value:
- *   URJ_STATUS_OK, URJ_STATUS_FAIL
- * ***************************************************************************/
+ *   position of the first mismatching bit counted from the MSB, or -1
+ */
 int
-urj_svf_hxr (enum generic_irdr_coding ir_dr, struct ths_params *params)
+urj_svf_match_tdo (const uint8_t *tdo, const uint8_t *mask, const char *data,
+                   int len)
 {
-    if (params->number != 0.0)
-        urj_warning ( _("command %s not implemented\n"),
-                     ir_dr == generic_ir ? "HIR" : "HDR");
+    int word, words = (len + 63) / 64;
+    int mismatch = -1;
 
-    return URJ_STATUS_OK;
-}
+    for (word = 0; word < words && mismatch < 0; word++)
+    {
+        const char *bit = data + word * 64;
+        int bits = len - word * 64;
+        uint64_t value = 0, expected = 0, care = 0, diff;
+        int i;
+
+        if (bits > 64)
+            bits = 64;
+        for (i = 0; i < bits; i++)
+            value |= (uint64_t) (bit[i] & 1) << i;
+        for (i = 0; i < (bits + 7) / 8; i++)
+        {
+            expected |= (uint64_t) tdo[word * 8 + i] << (8 * i);
+            care |= (uint64_t) mask[word * 8 + i] << (8 * i);
+        }
 
-#ifdef HAVE_SIGACTION_SA_ONESHOT
-static int max_time_reached;
-static void
-sigalrm_handler (int signal)
-{
-    max_time_reached = 1;
+        diff = (value ^ expected) & care;
+        if (bits < 64)
+            diff &= ((uint64_t) 1 << bits) - 1;
+
+        if (diff)
+        {
+            /* report the lowest differing bit, counted from the MSB */
+            for (i = 0; !(diff & 1); i++)
+                diff >>= 1;
+            mismatch = len - 1 - (word * 64 + i);
+        }
+    }
+
+    return mismatch;
 }
-#endif
 
 
-/* ***************************************************************************
- * urj_svf_runtest(params)
+/*
+ * urj_svf_compare_tdo(tdo, mask, data, len)
  *
- * Implements the RUNTEST command.
+ * Compares the captured device output of len bits in data with the expected
+ * values tdo (specified in SVF command SDR/SDI.
+ *
+ * Comparison honours the "care" bits in mask while matching the contents
+ * of data with tdo, see urj_svf_match_tdo(). Mismatches are reported.
  *
  * Parameter:
- *   params : paramter set for RUNTEST
+ *   tdo  : packed reference bits, see urj_svf_hex_to_packed()
+ *   mask : packed mask bits for tdo
+ *   data : captured bits to be compared vs. tdo, one per char, LSB first
+ *   len  : number of captured bits
+ *   loc  : location of the SIR/SDR command in the input file or NULL
  *
  * Return value:
- *   URJ_STATUS_OK, URJ_STATUS_FAIL
- * ***************************************************************************/
+ *   URJ_STATUS_OK   : tdo matches data at all positions where mask is '1'
+ *   URJ_STATUS_FAIL : tdo and data do not match or error occurred
+ */
 int
-urj_svf_runtest (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
-                 struct runtest *params)
+urj_svf_compare_tdo (urj_svf_parser_priv_t *priv, const uint8_t *tdo,
+                     const uint8_t *mask, const char *data, int len,
+                     YYLTYPE *loc)
 {
-    uint32_t run_count, frequency;
+    int mismatch;
 
-    /* check for restrictions */
-    if (params->run_count > 0 && params->run_clk != TCK)
-    {
-        urj_error_set (URJ_ERROR_INVALID,
-                       _("Error %s: only TCK is supported for RUNTEST"),
-                       "svf");
-        return URJ_STATUS_FAIL;
-    }
-    if (params->max_time > 0.0 && params->max_time < params->min_time)
-    {
-        urj_error_set (URJ_ERROR_OUT_OF_BOUNDS,
-                _("Error %s: maximum time must be larger or equal to minimum time"),
-                "svf");
-        return URJ_STATUS_FAIL;
-    }
-    if (params->max_time > 0.0)
-        if (!priv->issued_runtest_maxtime)
-        {
-            urj_warning ("%s%s",
-                         _("maximum time for RUNTEST not guaranteed.\n"),
-                         _(" This message is only displayed once.\n"));
-            priv->issued_runtest_maxtime = 1;
-        }
+    /* the simulated device output has no relation to the expected one */
+    if (priv->dry_run)
+        return URJ_STATUS_OK;
 
-    /* update default values for run_state and end_state */
-    if (params->run_state != 0)
-    {
-        priv->runtest_run_state = urj_svf_map_state (params->run_state);
+    mismatch = urj_svf_match_tdo (tdo, mask, data, len);
+    if (mismatch < 0)
+        return URJ_STATUS_OK;
 
-        if (params->end_state == 0)
-            priv->runtest_end_state = urj_svf_map_state (params->run_state);
-    }
-    if (params->end_state != 0)
-        priv->runtest_end_state = urj_svf_map_state (params->end_state);
+    /* remembered also if execution continues */
+    priv->mismatch_occurred = 1;
 
-    /* compute run_count */
-    run_count = params->run_count;
-    if (params->min_time > 0.0)
+    urj_log (URJ_LOG_LEVEL_NORMAL,
+             _("Error %s: mismatch at position %d for TDO\n"), priv->name,
+            mismatch);
+    if (loc != NULL)
     {
-        frequency =
-            priv->ref_freq >
-            0 ? priv->ref_freq : urj_tap_cable_get_frequency (chain->cable);
-        if (frequency > 0)
-        {
-            uint32_t min_time_run_count = ceil (params->min_time * frequency);
-            if (min_time_run_count > run_count)
-            {
-                run_count = min_time_run_count;
-            }
-        }
-        else
-        {
-            urj_error_set (URJ_ERROR_OUT_OF_BOUNDS,
-                           _("Error %s: Maximum cable clock frequency required for RUNTEST"),
-                           "svf");
-            urj_log (URJ_LOG_LEVEL_ERROR,
-                     _("  Set the cable frequency with 'FREQUENCY <Hz>'.\n"));
-            return URJ_STATUS_FAIL;
-        }
+        urj_log (URJ_LOG_LEVEL_NORMAL,
+            " in input file between line %d col %d and line %d col %d\n",
+            loc->first_line + 1, loc->first_column + 1,
+            loc->last_line + 1, loc->last_column + 1);
     }
 
-    urj_svf_goto_state (chain, priv->runtest_run_state);
-
-#ifndef HAVE_SIGACTION_SA_ONESHOT
-    if (params->max_time > 0.0)
+    if (urj_log_state.level <= URJ_LOG_LEVEL_DEBUG)
     {
-        double maxt = urj_lib_frealtime () + params->max_time;
+        char *tdo_bit, *mask_bit, *data_bit;
+        int i;
 
-        while (run_count-- > 0 && urj_lib_frealtime () < maxt)
+        tdo_bit = urj_svf_packed_string (tdo, len);
+        mask_bit = urj_svf_packed_string (mask, len);
+        data_bit = malloc (len + 1);
+        if (tdo_bit && mask_bit && data_bit)
         {
-            urj_tap_chain_clock (chain, 0, 0, 1);
+            for (i = 0; i < len; i++)
+                data_bit[len - 1 - i] = (data[i] & 1) ? '1' : '0';
+            data_bit[len] = '\0';
+
+            urj_log (URJ_LOG_LEVEL_DEBUG, "Expected : %s\n", tdo_bit);
+            urj_log (URJ_LOG_LEVEL_DEBUG, "Mask     : %s\n", mask_bit);
+            urj_log (URJ_LOG_LEVEL_DEBUG, "TDO data : %s\n", data_bit);
         }
+        free (data_bit);
+        free (mask_bit);
+        free (tdo_bit);
     }
-    else
-        CHAIN_CLOCK (chain, 0, 0, run_count);
 
-    urj_svf_goto_state (chain, priv->runtest_end_state);
+    return priv->svf_stop_on_mismatch ? URJ_STATUS_FAIL : URJ_STATUS_OK;
+}
+
 
-#else
-    /* set up the timer for max_time */
-    if (params->max_time > 0.0)
+/* state of 'svf ... profile=FILE' and 'svf ... dry_run' */
+struct svf_profile
+{
+    FILE *file;                 /* NULL if only the dry run is reported */
+    urj_cable_t *cable;
+    int old_io_timing;
+    struct
     {
-        struct sigaction sa;
-        unsigned max_time;
+        unsigned long count;
+        uint64_t bits;
+        long double time;
+        long double io_time;
+        uint64_t clocks;
+        unsigned long round_trips;
+    } entry[URJ_SVF_PROFILE_NUM];
+    int current;                /* type the time is counted for */
+    long double start;
+    long double mark;           /* time and cable counters at the last */
+    double io_mark;             /* change of the current type */
+    uint64_t clocks_mark;
+    unsigned long round_trips_mark;
+    int percent;                /* last progress reported */
+    /* dry run: predict the time on a cable with frequency and latency */
+    int dry_run;
+    uint32_t frequency;
+    double latency;
+};
+
+static const char * const urj_svf_profile_name[URJ_SVF_PROFILE_NUM] = {
+    "parse", "SIR", "SDR", "RUNTEST", "STATE", "verify",
+};
 
-        sa.sa_handler = sigalrm_handler;
-        sa.sa_flags = SA_ONESHOT;
-        sigemptyset (&sa.sa_mask);
-        if (sigaction (SIGALRM, &sa, NULL) != 0)
-        {
-            perror ("sigaction");
-            exit (EXIT_FAILURE);
+
+static void
+urj_svf_profile_switch (struct svf_profile *p, int type)
+{
+    long double now = urj_lib_fmonotime ();
+
+    p->entry[p->current].time += now - p->mark;
+    p->entry[p->current].io_time += p->cable->io_time - p->io_mark;
+    p->entry[p->current].clocks += p->cable->io_clocks - p->clocks_mark;
+    p->entry[p->current].round_trips +=
+        p->cable->io_round_trips - p->round_trips_mark;
+    p->mark = now;
+    p->io_mark = p->cable->io_time;
+    p->clocks_mark = p->cable->io_clocks;
+    p->round_trips_mark = p->cable->io_round_trips;
+    p->current = type;
+}
+
+
+/*
+ * urj_svf_profile_enter(priv, type)
+ *
+ * Starts counting the time for a command of the given type. The time is
+ * exclusive: a command type entered inside another one, like verification
+ * within SDR, stops the time of the outer one.
+ *
+ * Return value:
+ *   the type to be passed to urj_svf_profile_leave()
+ */
+int
+urj_svf_profile_enter (urj_svf_parser_priv_t *priv, int type)
+{
+    struct svf_profile *p = priv->profile;
+    int prev;
+
+    if (p == NULL)
+        return URJ_SVF_PROFILE_PARSE;
+
+    prev = p->current;
+    urj_svf_profile_switch (p, type);
+
+    return prev;
+}
+
+
+/*
+ * urj_svf_profile_leave(priv, prev, bits)
+ *
+ * Counts a command of the type entered last with the given number of bits
+ * and continues with the time for type prev.
+ */
+void
+urj_svf_profile_leave (urj_svf_parser_priv_t *priv, int prev, uint64_t bits)
+{
+    struct svf_profile *p = priv->profile;
+
+    if (p == NULL)
+        return;
+
+    p->entry[p->current].count++;
+    p->entry[p->current].bits += bits;
+    urj_svf_profile_switch (p, prev);
+}
+
+
+/*
+ * urj_svf_profile_progress(p, pos, total)
+ *
+ * Writes a progress record whenever another percent of the input has been
+ * processed. Times are integers to be independent of the locale.
+ */
+void
+urj_svf_profile_progress (struct svf_profile *p, long pos, long total)
+{
+    long double elapsed;
+    int percent;
+
+    if (p == NULL || p->file == NULL || total <= 0)
+        return;
+
+    percent = (long double) pos * 100 / total;
+    if (percent <= p->percent)
+        return;
+    p->percent = percent;
+
+    elapsed = urj_lib_fmonotime () - p->start;
+    fprintf (p->file, "{\"progress\":{\"percent\":%d,\"position\":%ld,"
+             "\"total\":%ld,\"elapsed_ms\":%.0Lf,\"eta_ms\":%.0Lf}}\n",
+             percent, pos, total, elapsed * 1000,
+             elapsed * 1000 * (100 - percent) / percent);
+    fflush (p->file);
+}
+
+
+static struct svf_profile *
+urj_svf_profile_start (urj_chain_t *chain, FILE *file)
+{
+    struct svf_profile *p = calloc (1, sizeof *p);
+
+    if (p == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd) fails",
+                       sizeof *p);
+        return NULL;
+    }
+
+    p->file = file;
+    p->cable = chain->cable;
+    p->old_io_timing = chain->cable->io_timing;
+    chain->cable->io_timing = 1;
+    p->current = URJ_SVF_PROFILE_PARSE;
+    p->start = p->mark = urj_lib_fmonotime ();
+    p->io_mark = chain->cable->io_time;
+    p->clocks_mark = chain->cable->io_clocks;
+    p->round_trips_mark = chain->cable->io_round_trips;
+
+    return p;
+}
+
+
+/*
+ * urj_svf_profile_predict(p, clocks, round_trips)
+ *
+ * Returns the seconds the cable of a dry run would need for the given
+ * number of TCK cycles and round trips.
+ */
+static long double
+urj_svf_profile_predict (const struct svf_profile *p, uint64_t clocks,
+                         unsigned long round_trips)
+{
+    long double t = (long double) round_trips * p->latency;
+
+    if (p->frequency > 0)
+        t += (long double) clocks / p->frequency;
+
+    return t;
+}
+
+
+/*
+ * urj_svf_profile_report(p)
+ *
+ * Logs TCK cycles, round trips and the predicted time per command type
+ * of a dry run.
+ */
+static void
+urj_svf_profile_report (const struct svf_profile *p)
+{
+    uint64_t clocks = 0;
+    unsigned long count = 0, round_trips = 0;
+    int i;
+
+    if (p->frequency > 0)
+        urj_log (URJ_LOG_LEVEL_NORMAL,
+                 _("Dry run, predicted for %lu Hz and %.0f us per round trip:\n"),
+                 (unsigned long) p->frequency, p->latency * 1e6);
+    else
+        urj_log (URJ_LOG_LEVEL_NORMAL,
+                 _("Dry run, predicted for unknown frequency and %.0f us per round trip:\n"),
+                 p->latency * 1e6);
+    urj_log (URJ_LOG_LEVEL_NORMAL, "  %-8s %10s %14s %12s %14s\n",
+             _("command"), _("count"), _("TCK"), _("round trips"),
+             _("seconds"));
+    for (i = 0; i < URJ_SVF_PROFILE_NUM; i++)
+    {
+        urj_log (URJ_LOG_LEVEL_NORMAL,
+                 "  %-8s %10lu %14" PRIu64 " %12lu %14.6Lf\n",
+                 urj_svf_profile_name[i], p->entry[i].count,
+                 p->entry[i].clocks, p->entry[i].round_trips,
+                 urj_svf_profile_predict (p, p->entry[i].clocks,
+                                          p->entry[i].round_trips));
+        count += p->entry[i].count;
+        clocks += p->entry[i].clocks;
+        round_trips += p->entry[i].round_trips;
+    }
+    urj_log (URJ_LOG_LEVEL_NORMAL,
+             "  %-8s %10lu %14" PRIu64 " %12lu %14.6Lf\n",
+             _("total"), count, clocks, round_trips,
+             urj_svf_profile_predict (p, clocks, round_trips));
+}
+
+
+/*
+ * urj_svf_profile_finish(priv, result)
+ *
+ * Writes the profile record with count, bits, time, cable I/O time, TCK
+ * cycles, round trips and throughput per command type, reports a dry run
+ * and ends profiling.
+ */
+static void
+urj_svf_profile_finish (urj_svf_parser_priv_t *priv, int result)
+{
+    struct svf_profile *p = priv->profile;
+    long double total, io_total = 0;
+    uint64_t clocks = 0;
+    unsigned long round_trips = 0;
+    int i;
+
+    if (p == NULL)
+        return;
+
+    urj_svf_profile_switch (p, p->current);
+    total = p->mark - p->start;
+    for (i = 0; i < URJ_SVF_PROFILE_NUM; i++)
+    {
+        io_total += p->entry[i].io_time;
+        clocks += p->entry[i].clocks;
+        round_trips += p->entry[i].round_trips;
+    }
+
+    if (p->file != NULL)
+    {
+        fprintf (p->file, "{\"profile\":{\"result\":\"%s\",\"mismatch\":%s,"
+                 "\"time_us\":%.0Lf,\"io_time_us\":%.0Lf,\"tck\":%" PRIu64
+                 ",\"round_trips\":%lu,",
+                 result == URJ_STATUS_OK ? "ok" : "error",
+                 priv->mismatch_occurred ? "true" : "false",
+                 total * 1e6, io_total * 1e6, clocks, round_trips);
+        if (p->dry_run)
+            fprintf (p->file, "\"dry_run\":{\"frequency\":%lu,"
+                     "\"latency_us\":%.0f,\"predicted_us\":%.0Lf},",
+                     (unsigned long) p->frequency, p->latency * 1e6,
+                     urj_svf_profile_predict (p, clocks, round_trips) * 1e6);
+        fprintf (p->file, "\"commands\":{");
+        for (i = 0; i < URJ_SVF_PROFILE_NUM; i++)
+            fprintf (p->file, "%s\"%s\":{\"count\":%lu,\"bits\":%" PRIu64
+                     ",\"time_us\":%.0Lf,\"io_time_us\":%.0Lf,"
+                     "\"tck\":%" PRIu64 ",\"round_trips\":%lu,"
+                     "\"bits_per_second\":%.0Lf}",
+                     i > 0 ? "," : "", urj_svf_profile_name[i],
+                     p->entry[i].count, p->entry[i].bits,
+                     p->entry[i].time * 1e6, p->entry[i].io_time * 1e6,
+                     p->entry[i].clocks, p->entry[i].round_trips,
+                     p->entry[i].time > 0
+                     ? p->entry[i].bits / p->entry[i].time : 0);
+        fprintf (p->file, "}}}\n");
+        fflush (p->file);
+    }
+
+    if (p->dry_run)
+        urj_svf_profile_report (p);
+
+    p->cable->io_timing = p->old_io_timing;
+    free (p);
+    priv->profile = NULL;
+}
+
+
+/*
+ * urj_svf_check_pending_tdo(chain, priv)
+ *
+ * Fetches the captured device output of all SIR/SDR commands with deferred
+ * TDO verification from the cable and compares it with the expected values.
+ * Mismatches are reported with the location of the originating command.
+ *
+ * Return value:
+ *   URJ_STATUS_OK   : all pending scans matched or mismatches are tolerated
+ *   URJ_STATUS_FAIL : at least one mismatch occurred that stops execution
+ */
+int
+urj_svf_check_pending_tdo (urj_chain_t *chain, urj_svf_parser_priv_t *priv)
+{
+    int i, result = URJ_STATUS_OK;
+    int prev;
+
+    if (priv->num_pending_tdo == 0)
+        return URJ_STATUS_OK;
+
+    prev = urj_svf_profile_enter (priv, URJ_SVF_PROFILE_VERIFY);
+
+    for (i = 0; i < priv->num_pending_tdo; i++)
+    {
+        struct svf_pending_tdo *p = &priv->pending_tdo[i];
+
+        urj_tap_shift_register_output (chain, p->out, p->out,
+                                       URJ_CHAIN_EXITMODE_EXIT1);
+        if (urj_svf_compare_tdo (priv, p->tdo, p->mask,
+                                 p->out->data + p->offset, p->len,
+                                 p->have_loc ? &p->loc : NULL)
+            != URJ_STATUS_OK)
+            result = URJ_STATUS_FAIL;
+
+        urj_tap_register_free (p->out);
+        if (p->owned)
+        {
+            free ((uint8_t *) p->tdo);
+            free ((uint8_t *) p->mask);
         }
+    }
+
+    urj_svf_profile_leave (priv, prev, priv->pending_tdo_bits);
+
+    priv->num_pending_tdo = 0;
+    priv->pending_tdo_bits = 0;
+
+    if (result != URJ_STATUS_OK)
+        priv->mismatch_occurred = 1;
+
+    return result;
+}
+
+
+/*
+ * urj_svf_pending_tdo_due(priv)
+ *
+ * Tells whether the deferred TDO checks have to be done before the next
+ * command, i.e. when execution stops at the command that mismatched or
+ * the queue is full.
+ */
+int
+urj_svf_pending_tdo_due (const urj_svf_parser_priv_t *priv)
+{
+    return priv->num_pending_tdo > 0
+        && (priv->svf_stop_on_mismatch
+            || priv->num_pending_tdo >= URJ_SVF_PENDING_TDO_MAX
+            || priv->pending_tdo_bits >= URJ_SVF_PENDING_TDO_MAX_BITS);
+}
+
+
+/*
+ * urj_svf_part_offset(chain, ir_dr)
+ *
+ * Returns the position of the active part's instruction or data register
+ * in a scan of the whole chain.
+ */
+static int
+urj_svf_part_offset (urj_chain_t *chain, enum generic_irdr_coding ir_dr)
+{
+    urj_parts_t *ps = chain->parts;
+    int i, offset = 0;
+
+    for (i = 0; i < chain->active_part && i < ps->len; i++)
+        if (ir_dr == generic_ir)
+            offset += ps->parts[i]->active_instruction->value->len;
+        else
+            offset += ps->parts[i]->active_instruction->data_register->in->len;
+
+    return offset;
+}
+
+
+/*
+ * urj_svf_remember_param(rem, new)
+ *
+ * Assigns the contents of the string new to the string rem.
+ * By doing so, the responsability to free the memory occupied by new
+ * is transferred to the code that handles *rem.
+ * Nothing happens when new is NULL. In this case the current value of
+ * rem has to be "remembered".
+ *
+ * Parameter:
+ *   rem : value pointer pointing to the "remembered" value
+ *   new : value that has to be rememberd
+ *         memory of the value is free'd
+ */
+static void
+urj_svf_remember_param (struct hexa_value **rem, struct hexa_value *new)
+{
+    if (new)
+    {
+        if (*rem)
+            free (*rem);
+
+        *rem = new;
+    }
+}
+
+
+/*
+ * urj_svf_all_care(value, number)
+ *
+ * Allocates a value of given length (number gives number of bits)
+ * and sets it to all 'F'.
+ * The allocated memory of the value has to be free'd by the caller.
+ *
+ * Parameter:
+ *   value  : is updated with the pointer to the allocated value
+ *   number : number of required bits
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ */
+static int
+urj_svf_all_care (struct hexa_value **value, double number)
+{
+    struct hexa_value *ptr;
+    int num;
+
+    num = (int) number;
+    num = num % 4 == 0 ? num / 4 : num / 4 + 1;
+
+    /* build value with all cares */
+    if (!(ptr = urj_svf_alloc_value (num)))
+        return URJ_STATUS_FAIL;
+    memset (ptr->data, 0xff, num / 2);
+    if (num % 2)
+        ptr->data[num / 2] = 0x0f;
+
+    urj_svf_remember_param (value, ptr);
+    /* responsability for free'ing ptr is now at the code that
+       operates on *value */
+
+    return URJ_STATUS_OK;
+}
+
+
+/* ***************************************************************************
+ * urj_svf_endxr(ir_dr, state)
+ *
+ * Register end states for shifting IR and DR.
+ *
+ * Parameter:
+ *   ir_dr : selects ENDIR or ENDDR
+ *   state : required end state (SVF parser encoding)
+ * ***************************************************************************/
+void
+urj_svf_endxr (urj_svf_parser_priv_t *priv, enum generic_irdr_coding ir_dr,
+               int state)
+{
+    switch (ir_dr)
+    {
+    case generic_ir:
+        priv->endir = urj_svf_map_state (state);
+        break;
+    case generic_dr:
+        priv->enddr = urj_svf_map_state (state);
+        break;
+    }
+}
+
+
+/* ***************************************************************************
+ * urj_svf_frequency(chain, freq)
+ *
+ * Implements the FREQUENCY command.
+ *
+ * Parameter:
+ *   freq : frequency in HZ
+ * ***************************************************************************/
+void
+urj_svf_frequency (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+                   double freq)
+{
+    if (priv->compile)
+        urj_svf_compile_frequency (priv->compile, freq);
+    else
+        urj_tap_cable_set_frequency (chain->cable, freq);
+}
+
+
+/*
+ * urj_svf_set_padding(pad, cmd, params)
+ *
+ * Stores the parameters of HIR, HDR, TIR or TDR in pad. TDI and MASK are
+ * remembered as long as the length does not change, TDO applies to all
+ * following scans until the command is given again.
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ */
+static int
+urj_svf_set_padding (struct svf_padding *pad, const char *cmd,
+                     struct ths_params *params)
+{
+    int len = (int) params->number;
+    uint8_t *tdi = NULL, *tdo = NULL, *mask = NULL;
+    int failed = 0;
+
+    if (len != pad->len && len > 0 && !params->tdi)
+    {
+        urj_log (URJ_LOG_LEVEL_ERROR,
+                 _("Error %s: first %s command after length change must have a TDI value.\n"),
+                 "svf", cmd);
+        return URJ_STATUS_FAIL;
+    }
+
+    if (params->tdi && !(tdi = urj_svf_value_to_packed (params->tdi, len)))
+        failed = 1;
+    if (params->tdo && !(tdo = urj_svf_value_to_packed (params->tdo, len)))
+        failed = 1;
+    if (params->mask)
+    {
+        if (!(mask = urj_svf_value_to_packed (params->mask, len)))
+            failed = 1;
+    }
+    else if (len != pad->len)
+    {
+        /* all bits care */
+        size_t bytes = (len + 7) / 8;
+
+        if ((mask = malloc (bytes > 0 ? bytes : 1)) != NULL)
+        {
+            memset (mask, 0xff, bytes);
+            if (len % 8)
+                mask[bytes - 1] &= (1 << (len % 8)) - 1;
+        }
+        else
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
+                           bytes);
+            failed = 1;
+        }
+    }
+
+    if (failed)
+    {
+        free (tdi);
+        free (tdo);
+        free (mask);
+        return URJ_STATUS_FAIL;
+    }
+
+    if (tdi)
+    {
+        free (pad->tdi);
+        pad->tdi = tdi;
+    }
+    if (mask)
+    {
+        free (pad->mask);
+        pad->mask = mask;
+    }
+    free (pad->tdo);
+    pad->tdo = tdo;
+    pad->len = len;
+
+    return URJ_STATUS_OK;
+}
+
+
+/*
+ * urj_svf_free_padding(pad)
+ */
+static void
+urj_svf_free_padding (struct svf_padding *pad)
+{
+    free (pad->tdi);
+    free (pad->tdo);
+    free (pad->mask);
+    memset (pad, 0, sizeof *pad);
+}
+
+
+/* ***************************************************************************
+ * urj_svf_hxr(ir_dr, params)
+ *
+ * Implements the HIR and HDR commands. The header is shifted before the
+ * SIR/SDR data, i.e. it ends up in the devices next to TDO.
+ *
+ * Once a header or trailer is set, SIR/SDR are shifted as one scan of the
+ * whole chain instead of through the active part, see urj_svf_sxr().
+ *
+ * Parameter:
+ *   ir_dr  : selects HIR or HDR
+ *   params : paramter set for TXR, HXR and SXR
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ * ***************************************************************************/
+int
+urj_svf_hxr (urj_svf_parser_priv_t *priv, enum generic_irdr_coding ir_dr,
+             struct ths_params *params)
+{
+    return urj_svf_set_padding (&priv->header[ir_dr],
+                                ir_dr == generic_ir ? "HIR" : "HDR", params);
+}
+
+/*
+ * urj_svf_clock_max_time(chain, priv, run_count, max_time)
+ *
+ * Clocks the chain with TMS = 0 until either run_count clocks have been
+ * issued or max_time seconds have elapsed.
+ *
+ * The clocks are queued in chunks and the elapsed time is checked between
+ * the chunks only. The first chunk is derived from the cable frequency,
+ * the following ones from the clock rate measured so far, sized to take
+ * a fraction of the remaining time. Thus max_time can be exceeded by a
+ * small part of itself at most, unless the cable slows down suddenly.
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ */
+int
+urj_svf_clock_max_time (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+                        uint32_t run_count, double max_time)
+{
+    long double start, now, deadline, next;
+    uint32_t frequency, chunk, done = 0;
+
+    if (priv->compile)
+        return urj_svf_compile_timed (chain, priv->compile, run_count,
+                                      max_time);
+
+    /* the time limit refers to the device, so catch up with verification
+       before running the clock under real-time constraints */
+    if (priv->num_pending_tdo > 0)
+        if (urj_svf_check_pending_tdo (chain, priv) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+    if (!priv->issued_runtest_maxtime)
+    {
+        urj_warning ("%s%s",
+                     _("maximum time for RUNTEST not guaranteed.\n"),
+                     _(" This message is only displayed once.\n"));
+        priv->issued_runtest_maxtime = 1;
+    }
+
+    /* preceding state transitions must not count against max_time */
+    urj_tap_cable_flush (chain->cable, URJ_TAP_CABLE_COMPLETELY);
+
+    frequency = urj_tap_cable_get_frequency (chain->cable);
+    next = frequency * max_time / URJ_SVF_MAXTIME_CHUNKS;
+
+    start = urj_lib_fmonotime ();
+    deadline = start + max_time;
+
+    while (run_count > 0)
+    {
+        if (next < 1.0)
+            chunk = 1;
+        else if (next > run_count)
+            chunk = run_count;
+        else
+            chunk = next;
+
+        if (urj_tap_chain_defer_clock (chain, 0, 0, chunk) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        urj_tap_cable_flush (chain->cable, URJ_TAP_CABLE_COMPLETELY);
+        run_count -= chunk;
+        done += chunk;
+
+        now = urj_lib_fmonotime ();
+        if (now >= deadline)
+            break;
+
+        /* clocks achievable in half of the remaining time at the
+           measured rate, limited to let the chunks grow gradually */
+        next = 2.0 * chunk;
+        if (now > start)
+        {
+            long double fit = done / (now - start) * (deadline - now) / 2;
+
+            if (fit < next)
+                next = fit;
+        }
+    }
+
+    return URJ_STATUS_OK;
+}
+
+
+/*
+ * urj_svf_runtest_count(chain, priv, run_count, min_time, count)
+ *
+ * Computes the number of clocks for a RUNTEST with run_count clocks and at
+ * least min_time seconds, based on ref_freq or the cable frequency.
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ */
+int
+urj_svf_runtest_count (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+                       uint32_t run_count, double min_time, uint32_t *count)
+{
+    uint32_t frequency;
+
+    if (min_time > 0.0)
+    {
+        if (priv->ref_freq > 0)
+            frequency = priv->ref_freq;
+        else if (priv->compile)
+            frequency = urj_svf_compile_get_frequency (priv->compile);
+        else
+            frequency = urj_tap_cable_get_frequency (chain->cable);
+        if (frequency > 0)
+        {
+            uint32_t min_time_run_count = ceil (min_time * frequency);
+            if (min_time_run_count > run_count)
+            {
+                run_count = min_time_run_count;
+            }
+        }
+        else
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_BOUNDS,
+                           _("Error %s: Maximum cable clock frequency required for RUNTEST"),
+                           "svf");
+            urj_log (URJ_LOG_LEVEL_ERROR,
+                     _("  Set the cable frequency with 'FREQUENCY <Hz>'.\n"));
+            return URJ_STATUS_FAIL;
+        }
+    }
+
+    *count = run_count;
+
+    return URJ_STATUS_OK;
+}
+
+
+/* ***************************************************************************
+ * urj_svf_runtest(params)
+ *
+ * Implements the RUNTEST command.
+ *
+ * Parameter:
+ *   params : paramter set for RUNTEST
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ * ***************************************************************************/
+int
+urj_svf_runtest (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+                 struct runtest *params)
+{
+    uint32_t run_count;
+
+    /* check for restrictions */
+    if (params->run_count > 0 && params->run_clk != TCK)
+    {
+        urj_error_set (URJ_ERROR_INVALID,
+                       _("Error %s: only TCK is supported for RUNTEST"),
+                       "svf");
+        return URJ_STATUS_FAIL;
+    }
+    if (params->max_time > 0.0 && params->max_time < params->min_time)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_BOUNDS,
+                _("Error %s: maximum time must be larger or equal to minimum time"),
+                "svf");
+        return URJ_STATUS_FAIL;
+    }
+    /* update default values for run_state and end_state */
+    if (params->run_state != 0)
+    {
+        priv->runtest_run_state = urj_svf_map_state (params->run_state);
 
-        max_time = floor (params->max_time / 1000000);
-        if (max_time == 0)
-        {
-            max_time = 1;
-        }
-        ualarm (max_time, 0);
+        if (params->end_state == 0)
+            priv->runtest_end_state = urj_svf_map_state (params->run_state);
     }
+    if (params->end_state != 0)
+        priv->runtest_end_state = urj_svf_map_state (params->end_state);
 
-    if (params->max_time > 0.0)
-        while (run_count-- > 0 && !max_time_reached)
-        {
-            urj_tap_chain_clock (chain, 0, 0, 1);
-        }
-    else
-        CHAIN_CLOCK (chain, 0, 0, run_count);
+    /* compute run_count */
+    if (urj_svf_runtest_count (chain, priv, params->run_count,
+                               params->min_time, &run_count) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
 
-    urj_svf_goto_state (chain, priv->runtest_end_state);
+    urj_svf_goto_state (chain, priv, priv->runtest_run_state);
 
-    /* stop the timer */
     if (params->max_time > 0.0)
     {
-        struct sigaction sa;
-        sa.sa_handler = SIG_IGN;
-        sa.sa_flags = 0;
-        sigemptyset (&sa.sa_mask);
-        if (sigaction (SIGALRM, &sa, NULL) != 0)
-        {
-            perror ("sigaction");
-            exit (EXIT_FAILURE);
-        }
+        if (urj_svf_clock_max_time (chain, priv, run_count, params->max_time)
+            != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
     }
-#endif
+    else
+        urj_svf_clock (chain, priv, 0, run_count);
+
+    urj_svf_goto_state (chain, priv, priv->runtest_end_state);
 
     return URJ_STATUS_OK;
 }
@@ -808,11 +1549,287 @@ urj_svf_state (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
     priv->svf_state_executed = 1;
 
     for (i = 0; i < path_states->num_states; i++)
-        urj_svf_goto_state (chain,
+        urj_svf_goto_state (chain, priv,
                             urj_svf_map_state (path_states->states[i]));
 
     if (stable_state)
-        urj_svf_goto_state (chain, urj_svf_map_state (stable_state));
+        urj_svf_goto_state (chain, priv, urj_svf_map_state (stable_state));
+
+    return URJ_STATUS_OK;
+}
+
+
+/*
+ * urj_svf_setup_register(priv, ir_dr, len, loc)
+ *
+ * Prepares the SIR instruction or the SDR register for a scan of len bits.
+ * The length of SIR is fixed by the part, SDR is resized as required.
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ */
+int
+urj_svf_setup_register (urj_svf_parser_priv_t *priv,
+                        enum generic_irdr_coding ir_dr, int len, YYLTYPE *loc)
+{
+    switch (ir_dr)
+    {
+    case generic_ir:
+        /* is SIR large enough? */
+        if (priv->ir->value->len != len)
+        {
+            urj_log (URJ_LOG_LEVEL_ERROR,
+                     _("Error %s: SIR command length inconsistent.\n"), "svf");
+            if (loc != NULL)
+            {
+                urj_log (URJ_LOG_LEVEL_ERROR,
+                     _(" in input file between line %d col %d and line %d col %d\n"),
+                     loc->first_line + 1, loc->first_column + 1,
+                     loc->last_line + 1, loc->last_column + 1);
+            }
+            return URJ_STATUS_FAIL;
+        }
+        break;
+
+    case generic_dr:
+        /* check data register SDR */
+        if (priv->dr->in->len != len)
+        {
+            /* length does not match, so install proper registers */
+            urj_tap_register_free (priv->dr->in);
+            priv->dr->in = NULL;
+            urj_tap_register_free (priv->dr->out);
+            priv->dr->out = NULL;
+
+            if (!(priv->dr->in = urj_tap_register_alloc (len)))
+                // retain error state
+                return URJ_STATUS_FAIL;
+            if (!(priv->dr->out = urj_tap_register_alloc (len)))
+                // retain error state
+                return URJ_STATUS_FAIL;
+        }
+        break;
+
+    }
+
+    return URJ_STATUS_OK;
+}
+
+
+/*
+ * urj_svf_setup_raw(priv, len)
+ *
+ * Prepares the registers for a scan of the whole chain with len bits.
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ */
+int
+urj_svf_setup_raw (urj_svf_parser_priv_t *priv, int len)
+{
+    if (priv->raw_in && priv->raw_in->len == len)
+        return URJ_STATUS_OK;
+
+    urj_tap_register_free (priv->raw_in);
+    urj_tap_register_free (priv->raw_out);
+    priv->raw_out = NULL;
+
+    if (!(priv->raw_in = urj_tap_register_alloc (len)))
+        // retain error state
+        return URJ_STATUS_FAIL;
+    if (!(priv->raw_out = urj_tap_register_alloc (len)))
+    {
+        urj_tap_register_free (priv->raw_in);
+        priv->raw_in = NULL;
+        // retain error state
+        return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+
+/*
+ * urj_svf_shift(chain, priv, ir_dr, raw, tdo, mask, owned, loc)
+ *
+ * Shifts the prepared SIR instruction or SDR register from the Shift-IR/DR
+ * state to Exit1-IR/DR and verifies the device output against tdo/mask
+ * (packed, see urj_svf_value_to_packed()) if tdo is not NULL. Verification is
+ * deferred when enabled, or the scan is recorded when compiling.
+ *
+ * Parameter:
+ *   raw   : shift priv->raw_in through the whole chain instead of the
+ *           parts' registers, see urj_svf_setup_raw()
+ *   owned : tdo and mask are malloc'ed and have to be free'd once checked
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ */
+int
+urj_svf_shift (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+               enum generic_irdr_coding ir_dr, int raw, const uint8_t *tdo,
+               const uint8_t *mask, int owned, YYLTYPE *loc)
+{
+    urj_tap_register_t *in, *out;
+    int result = URJ_STATUS_OK;
+
+    if (raw)
+    {
+        in = priv->raw_in;
+        out = priv->raw_out;
+    }
+    else
+    {
+        in = ir_dr == generic_ir ? priv->ir->value : priv->dr->in;
+        out = ir_dr == generic_ir ? priv->ir->out : priv->dr->out;
+    }
+
+    if (priv->compile)
+    {
+        result = urj_svf_compile_shift (priv->compile, ir_dr, raw, in, tdo,
+                                        mask, loc);
+        /* the scan leaves the Shift state via Exit1 */
+        urj_tap_state_clock (chain, 1);
+    }
+    else if (tdo && priv->pending_tdo)
+    {
+        /* queue scans with TDO check if deferred verification is enabled */
+        struct svf_pending_tdo *p;
+
+        if (priv->num_pending_tdo >= URJ_SVF_PENDING_TDO_MAX
+            || priv->pending_tdo_bits >= URJ_SVF_PENDING_TDO_MAX_BITS)
+            result = urj_svf_check_pending_tdo (chain, priv);
+
+        p = &priv->pending_tdo[priv->num_pending_tdo];
+        if (raw)
+        {
+            p->out = urj_tap_register_alloc (in->len);
+            if (p->out != NULL)
+                urj_tap_defer_shift_register (chain, in, p->out,
+                                              URJ_CHAIN_EXITMODE_EXIT1);
+        }
+        else if (ir_dr == generic_ir)
+            p->out = urj_tap_chain_defer_shift_instructions_mode (chain, 0,
+                                                URJ_CHAIN_EXITMODE_EXIT1);
+        else
+            p->out = urj_tap_chain_defer_shift_data_registers_mode (chain, 0,
+                                                URJ_CHAIN_EXITMODE_EXIT1);
+
+        if (p->out != NULL)
+        {
+            p->offset = raw ? 0 : urj_svf_part_offset (chain, ir_dr);
+            p->len = in->len;
+            p->tdo = tdo;
+            p->mask = mask;
+            p->owned = owned;
+            p->have_loc = loc != NULL;
+            if (loc != NULL)
+                p->loc = *loc;
+
+            priv->num_pending_tdo++;
+            priv->pending_tdo_bits += p->out->len;
+
+            /* tdo and mask are free'd once checked */
+            owned = 0;
+        }
+        else
+            result = URJ_STATUS_FAIL;
+    }
+    else
+    {
+        if (raw)
+            urj_tap_shift_register (chain, in, tdo ? out : NULL,
+                                    URJ_CHAIN_EXITMODE_EXIT1);
+        else if (ir_dr == generic_ir)
+            urj_tap_chain_shift_instructions_mode (chain, tdo ? 1 : 0, 0,
+                                                   URJ_CHAIN_EXITMODE_EXIT1);
+        else
+            urj_tap_chain_shift_data_registers_mode (chain, tdo ? 1 : 0, 0,
+                                                     URJ_CHAIN_EXITMODE_EXIT1);
+
+        if (tdo && urj_svf_compare_tdo (priv, tdo, mask, out->data, out->len,
+                                        loc) != URJ_STATUS_OK)
+        {
+            /* log mismatches */
+            priv->mismatch_occurred = 1;
+            result = URJ_STATUS_FAIL;
+        }
+    }
+
+    if (owned)
+    {
+        free ((uint8_t *) tdo);
+        free ((uint8_t *) mask);
+    }
+
+    return result;
+}
+
+
+/*
+ * urj_svf_build_raw(priv, ir_dr, tdi, len, tdo, mask)
+ *
+ * Assembles header, the len bits of the value tdi and trailer in
+ * priv->raw_in. Expected values of all three are merged into *tdo and *mask
+ * if any of them is checked; bits without TDO are don't care.
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ */
+static int
+urj_svf_build_raw (urj_svf_parser_priv_t *priv, enum generic_irdr_coding ir_dr,
+                   const struct hexa_value *tdi, int len, uint8_t **tdo,
+                   uint8_t **mask)
+{
+    const struct svf_padding *h = &priv->header[ir_dr];
+    const struct svf_padding *t = &priv->trailer[ir_dr];
+    int total = h->len + len + t->len;
+    uint8_t *raw_tdo, *raw_mask;
+    size_t bytes;
+
+    if (urj_svf_setup_raw (priv, total) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    /* the header is shifted first */
+    urj_svf_unpack (h->tdi, priv->raw_in->data, h->len);
+    urj_svf_value_to_bits (tdi, priv->raw_in->data + h->len, len);
+    urj_svf_unpack (t->tdi, priv->raw_in->data + h->len + len, t->len);
+
+    if (!*tdo && !h->tdo && !t->tdo)
+        return URJ_STATUS_OK;
+
+    bytes = (total + 7) / 8;
+    raw_tdo = calloc (bytes > 0 ? bytes : 1, 1);
+    raw_mask = calloc (bytes > 0 ? bytes : 1, 1);
+    if (raw_tdo == NULL || raw_mask == NULL)
+    {
+        free (raw_tdo);
+        free (raw_mask);
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd,%zd) fails",
+                       bytes, (size_t) 1);
+        return URJ_STATUS_FAIL;
+    }
+
+    if (h->tdo)
+    {
+        urj_svf_pack_at (raw_tdo, 0, h->tdo, h->len);
+        urj_svf_pack_at (raw_mask, 0, h->mask, h->len);
+    }
+    if (*tdo)
+    {
+        urj_svf_pack_at (raw_tdo, h->len, *tdo, len);
+        urj_svf_pack_at (raw_mask, h->len, *mask, len);
+    }
+    if (t->tdo)
+    {
+        urj_svf_pack_at (raw_tdo, h->len + len, t->tdo, t->len);
+        urj_svf_pack_at (raw_mask, h->len + len, t->mask, t->len);
+    }
+
+    free (*tdo);
+    free (*mask);
+    *tdo = raw_tdo;
+    *mask = raw_mask;
 
     return URJ_STATUS_OK;
 }
@@ -836,7 +1853,8 @@ urj_svf_sxr (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
              YYLTYPE *loc)
 {
     urj_svf_sxr_t *sxr_params;
-    int len, result = URJ_STATUS_OK;
+    uint8_t *tdo = NULL, *mask = NULL;
+    int len, raw, end_state, result = URJ_STATUS_OK;
 
     sxr_params = (ir_dr == generic_ir) ?
                      &(priv->sir_params) : &(priv->sdr_params);
@@ -882,7 +1900,7 @@ urj_svf_sxr (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
         sxr_params->no_tdi = 0;
     }
 
-    /* take over responsability for free'ing parameter strings */
+    /* take over responsability for free'ing parameter values */
     params->tdi = NULL;
     params->mask = NULL;
     params->smask = NULL;
@@ -896,88 +1914,57 @@ urj_svf_sxr (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
      * handle tap registers
      */
     len = (int) sxr_params->params.number;
-    switch (ir_dr)
+    raw = priv->dry_run
+        || priv->header[ir_dr].len > 0 || priv->trailer[ir_dr].len > 0;
+
+    /* convert expected values, they are handed over to urj_svf_shift() */
+    if (sxr_params->params.tdo)
     {
-    case generic_ir:
-        /* is SIR large enough? */
-        if (priv->ir->value->len != len)
+        tdo = urj_svf_value_to_packed (sxr_params->params.tdo, len);
+        mask = urj_svf_value_to_packed (sxr_params->params.mask, len);
+        if (tdo == NULL || mask == NULL)
         {
-            urj_log (URJ_LOG_LEVEL_ERROR,
-                     _("Error %s: SIR command length inconsistent.\n"), "svf");
-            if (loc != NULL)
-            {
-                urj_log (URJ_LOG_LEVEL_ERROR,
-                     _(" in input file between line %d col %d and line %d col %d\n"),
-                     loc->first_line + 1, loc->first_column + 1,
-                     loc->last_line + 1, loc->last_column + 1);
-            }
+            free (tdo);
+            free (mask);
             return URJ_STATUS_FAIL;
         }
-        break;
+    }
 
-    case generic_dr:
-        /* check data register SDR */
-        if (priv->dr->in->len != len)
+    if (raw)
+        /* header, data and trailer make up one scan of the whole chain */
+        result = urj_svf_build_raw (priv, ir_dr, sxr_params->params.tdi, len,
+                                    &tdo, &mask);
+    else
+    {
+        result = urj_svf_setup_register (priv, ir_dr, len, loc);
+
+        /* fill register with value of TDI parameter */
+        if (result == URJ_STATUS_OK)
         {
-            /* length does not match, so install proper registers */
-            urj_tap_register_free (priv->dr->in);
-            priv->dr->in = NULL;
-            urj_tap_register_free (priv->dr->out);
-            priv->dr->out = NULL;
+            urj_tap_register_t *reg = ir_dr == generic_ir
+                ? priv->ir->value : priv->dr->in;
 
-            if (!(priv->dr->in = urj_tap_register_alloc (len)))
-                // retain error state
-                return URJ_STATUS_FAIL;
-            if (!(priv->dr->out = urj_tap_register_alloc (len)))
-                // retain error state
-                return URJ_STATUS_FAIL;
+            urj_svf_value_to_bits (sxr_params->params.tdi, reg->data,
+                                   reg->len);
         }
-        break;
-
     }
-
-    /* fill register with value of TDI parameter */
-    if (urj_svf_copy_hex_to_register (sxr_params->params.tdi,
-                                      ir_dr == generic_ir ? priv->ir->value
-                                                          : priv->dr->in)
-        != URJ_STATUS_OK)
-        return URJ_STATUS_FAIL;
-
-
-    /* shift selected instruction/register */
-    switch (ir_dr)
+    if (result != URJ_STATUS_OK)
     {
-    case generic_ir:
-        urj_svf_goto_state (chain, URJ_TAP_STATE_SHIFT_IR);
-        urj_tap_chain_shift_instructions_mode (chain,
-                                               sxr_params->params.tdo ? 1 : 0,
-                                               0, URJ_CHAIN_EXITMODE_EXIT1);
-        urj_svf_goto_state (chain, priv->endir);
-
-        if (sxr_params->params.tdo)
-            result = urj_svf_compare_tdo (priv, sxr_params->params.tdo,
-                                          sxr_params->params.mask,
-                                          priv->ir->out, loc);
-        break;
-
-    case generic_dr:
-        urj_svf_goto_state (chain, URJ_TAP_STATE_SHIFT_DR);
-        urj_tap_chain_shift_data_registers_mode (chain,
-                                                 sxr_params->params.
-                                                 tdo ? 1 : 0, 0,
-                                                 URJ_CHAIN_EXITMODE_EXIT1);
-        urj_svf_goto_state (chain, priv->enddr);
-
-        if (sxr_params->params.tdo)
-            result = urj_svf_compare_tdo (priv, sxr_params->params.tdo,
-                                          sxr_params->params.mask,
-                                          priv->dr->out, loc);
-        break;
+        free (tdo);
+        free (mask);
+        return URJ_STATUS_FAIL;
     }
 
-    /* log mismatches */
-    if (result != URJ_STATUS_OK)
-        priv->mismatch_occurred = 1;
+    /* shift selected instruction/register */
+    urj_svf_goto_state (chain, priv, ir_dr == generic_ir
+                        ? URJ_TAP_STATE_SHIFT_IR : URJ_TAP_STATE_SHIFT_DR);
+    result = urj_svf_shift (chain, priv, ir_dr, raw, tdo, mask, 1, loc);
+    end_state = ir_dr == generic_ir ? priv->endir : priv->enddr;
+    /* the player completes a failed scan with this move only */
+    if (priv->compile)
+        urj_svf_compile_goto (chain, priv->compile, end_state);
+    else
+        urj_svf_goto_state (chain, priv, end_state);
 
     return result;
 }
@@ -1051,80 +2038,50 @@ urj_svf_trst (urj_chain_t *chain, urj_svf_parser_priv_t *priv, int trst_mode)
     if (trst_cable < 0)
         urj_warning (_("unimplemented mode '%s' for TRST\n"),
                      unimplemented_mode);
+    else if (priv->compile)
+        urj_svf_compile_trst (priv->compile, trst_cable);
     else
-        urj_tap_cable_set_signal (chain->cable, URJ_POD_CS_TRST,
-                                  trst_cable ? URJ_POD_CS_TRST : 0);
-
-    return URJ_STATUS_OK;
-}
-
-
-/* ***************************************************************************
- * urj_svf_txr(ir_dr, params)
- *
- * Handles TIR, TDR.
- *
- * Note:
- * Functionality not implemented.
- *
- * Parameter:
- *   ir_dr  : selects TIR or TDR
- *   params : paramter set for TXR, HXR and SXR
- *
- * Return value:
- *   URJ_STATUS_OK, URJ_STATUS_FAIL
- * ***************************************************************************/
-int
-urj_svf_txr (enum generic_irdr_coding ir_dr, struct ths_params *params)
-{
-    if (params->number != 0.0)
-        urj_warning (_("command %s not implemented\n"),
-                     ir_dr == generic_ir ? "TIR" : "TDR");
+        urj_tap_chain_set_trst (chain, trst_cable);
 
     return URJ_STATUS_OK;
 }
 
 
 /* ***************************************************************************
- * urj_svf_run(chain, SVF_FILE, stop_on_mismatch, ref_freq)
- *
- * Main entry point for the 'svf' command. Calls the svf parser.
- *
- * Checks the jtag-environment (availability of SIR instruction and SDR
- * register). Initializes all svf-global variables and performs clean-up
- * afterwards.
- *
- * Parameter:
- *   chain            : pointer to global chain
- *   SVF_FILE         : file handle of SVF file
- *   stop_on_mismatch : 1 = stop upon tdo mismatch
- *                      0 = continue upon mismatch
- *   ref_freq         : reference frequency for RUNTEST
+ * urj_svf_txr(ir_dr, params)
+ *
+ * Implements the TIR and TDR commands. The trailer is shifted after the
+ * SIR/SDR data, i.e. it ends up in the devices next to TDI.
+ *
+ * Parameter:
+ *   ir_dr  : selects TIR or TDR
+ *   params : paramter set for TXR, HXR and SXR
  *
  * Return value:
  *   URJ_STATUS_OK, URJ_STATUS_FAIL
  * ***************************************************************************/
 int
-urj_svf_run (urj_chain_t *chain, FILE *SVF_FILE, int stop_on_mismatch,
-             uint32_t ref_freq)
+urj_svf_txr (urj_svf_parser_priv_t *priv, enum generic_irdr_coding ir_dr,
+             struct ths_params *params)
 {
-    const urj_svf_sxr_t sxr_default = { {0.0, NULL, NULL, NULL, NULL},
-    1, 1
-    };
-    urj_svf_parser_priv_t priv;
-    int c = ~EOF;
-    int num_lines;
-    uint32_t old_frequency;
+    return urj_svf_set_padding (&priv->trailer[ir_dr],
+                                ir_dr == generic_ir ? "TIR" : "TDR", params);
+}
 
-    if (chain == NULL || chain->cable == NULL)
-        return  URJ_STATUS_FAIL;
 
-    old_frequency = urj_tap_cable_get_frequency (chain->cable);
+/*
+ * urj_svf_count_lines(SVF_FILE)
+ *
+ * Gets the number of lines in the svf file so we can give user some
+ * feedback on long files or slow cables.
+ */
+static int
+urj_svf_count_lines (FILE *SVF_FILE)
+{
+    int c = ~EOF;
+    int num_lines = 0;
 
-    /* get number of lines in svf file so we can give user some feedback on long
-       files or slow cables */
     rewind (SVF_FILE);
-    num_lines = 0;
     while (EOF != c)
     {
         c = fgetc (SVF_FILE);
@@ -1136,6 +2093,27 @@ urj_svf_run (urj_chain_t *chain, FILE *SVF_FILE, int stop_on_mismatch,
         /* avoid those annoying divide/0 crashes */
         num_lines++;
 
+    return num_lines;
+}
+
+
+/*
+ * urj_svf_init(chain, priv, stop_on_mismatch, ref_freq)
+ *
+ * Checks the jtag-environment (availability of SIR instruction and SDR
+ * register) and initializes the parser's private data for a new run.
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ */
+static int
+urj_svf_init (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+              int stop_on_mismatch, uint32_t ref_freq)
+{
+    const urj_svf_sxr_t sxr_default = { {0.0, NULL, NULL, NULL, NULL},
+    1, 1
+    };
+
     /* initialize
        - part
        - instruction register
@@ -1152,17 +2130,17 @@ urj_svf_run (urj_chain_t *chain, FILE *SVF_FILE, int stop_on_mismatch,
                        _("%s: chain without any parts"), "svf");
         return URJ_STATUS_FAIL;
     }
-    priv.part = chain->parts->parts[chain->active_part];
-    // @@@@ RFHH is priv.part allowed to be NULL? if not, we should use
+    priv->part = chain->parts->parts[chain->active_part];
+    // @@@@ RFHH is priv->part allowed to be NULL? if not, we should use
     // urj_tap_chain_active_part()
 
     /* setup register SDR if not already existing */
-    if (!(priv.dr = urj_part_find_data_register (priv.part, "SDR")))
+    if (!(priv->dr = urj_part_find_data_register (priv->part, "SDR")))
     {
-        if (urj_part_data_register_define(priv.part, "SDR", 32) != URJ_STATUS_OK)
+        if (urj_part_data_register_define(priv->part, "SDR", 32) != URJ_STATUS_OK)
             return URJ_STATUS_FAIL;
 
-        if (!(priv.dr = urj_part_find_data_register (priv.part, "SDR")))
+        if (!(priv->dr = urj_part_find_data_register (priv->part, "SDR")))
         {
             urj_error_set (URJ_ERROR_NOTFOUND,
                            _("%s: could not establish SDR register"),
@@ -1172,11 +2150,11 @@ urj_svf_run (urj_chain_t *chain, FILE *SVF_FILE, int stop_on_mismatch,
     }
 
     /* setup instruction SIR if not already existing */
-    if (!(priv.ir = urj_part_find_instruction (priv.part, "SIR")))
+    if (!(priv->ir = urj_part_find_instruction (priv->part, "SIR")))
     {
         int len;
 
-        len = priv.part->instruction_length;
+        len = priv->part->instruction_length;
         if (len > 0)
         {
             char *instruction_string;
@@ -1192,7 +2170,7 @@ urj_svf_run (urj_chain_t *chain, FILE *SVF_FILE, int stop_on_mismatch,
             memset (instruction_string, '1', len);
             instruction_string[len] = '\0';
 
-            sir = urj_part_instruction_define (priv.part, "SIR",
+            sir = urj_part_instruction_define (priv->part, "SIR",
                                                instruction_string, "SDR");
 
             free (instruction_string);
@@ -1202,7 +2180,7 @@ urj_svf_run (urj_chain_t *chain, FILE *SVF_FILE, int stop_on_mismatch,
                 return URJ_STATUS_FAIL;
         }
 
-        if (!(priv.ir = urj_part_find_instruction (priv.part, "SIR")))
+        if (!(priv->ir = urj_part_find_instruction (priv->part, "SIR")))
         {
             urj_error_set (URJ_ERROR_NOTFOUND,
                            _("%s: could not establish SIR instruction"),
@@ -1212,60 +2190,461 @@ urj_svf_run (urj_chain_t *chain, FILE *SVF_FILE, int stop_on_mismatch,
     }
 
     /* initialize variables for new parser run */
-    priv.svf_stop_on_mismatch = stop_on_mismatch;
+    priv->svf_stop_on_mismatch = stop_on_mismatch;
 
-    priv.sir_params = priv.sdr_params = sxr_default;
+    priv->sir_params = priv->sdr_params = sxr_default;
 
-    priv.endir = priv.enddr = URJ_TAP_STATE_RUN_TEST_IDLE;
+    priv->endir = priv->enddr = URJ_TAP_STATE_RUN_TEST_IDLE;
 
-    priv.runtest_run_state = priv.runtest_end_state =
+    priv->runtest_run_state = priv->runtest_end_state =
         URJ_TAP_STATE_RUN_TEST_IDLE;
 
-    priv.svf_trst_absent = 0;
-    priv.svf_state_executed = 0;
+    priv->svf_trst_absent = 0;
+    priv->svf_state_executed = 0;
 
-    priv.mismatch_occurred = 0;
+    priv->mismatch_occurred = 0;
 
     /* set back flags for issued warnings */
-    priv.issued_runtest_maxtime = 0;
+    priv->issued_runtest_maxtime = 0;
 
-    priv.ref_freq = ref_freq;
+    priv->ref_freq = ref_freq;
+    strcpy (priv->name, "svf");
+
+    /* defer TDO verification unless execution has to stop at the very
+       command that mismatched */
+    priv->pending_tdo = stop_on_mismatch ? NULL
+        : calloc (URJ_SVF_PENDING_TDO_MAX, sizeof (struct svf_pending_tdo));
+    priv->compile = NULL;
+    priv->profile = NULL;
+    priv->dry_run = 0;
+    priv->num_pending_tdo = 0;
+    priv->pending_tdo_bits = 0;
+
+    memset (priv->header, 0, sizeof priv->header);
+    memset (priv->trailer, 0, sizeof priv->trailer);
+    priv->raw_in = priv->raw_out = NULL;
 
     /* select SIR instruction */
-    urj_part_set_instruction (priv.part, "SIR");
+    urj_part_set_instruction (priv->part, "SIR");
+
+    return URJ_STATUS_OK;
+}
+
+
+/*
+ * urj_svf_done(chain, priv, report)
+ *
+ * Completes outstanding TDO verification, reports the overall result if
+ * report is set and frees the parser's private data.
+ */
+static void
+urj_svf_done (urj_chain_t *chain, urj_svf_parser_priv_t *priv, int report)
+{
+    int i;
+
+    /* verify what is still outstanding */
+    urj_svf_check_pending_tdo (chain, priv);
+    free (priv->pending_tdo);
+    priv->pending_tdo = NULL;
 
-    if (urj_svf_bison_init (&priv, SVF_FILE, num_lines))
+    if (report)
     {
-        urj_svf_parse (&priv, chain);
-        urj_svf_bison_deinit (&priv);
+        if (priv->mismatch_occurred > 0)
+            urj_log (URJ_LOG_LEVEL_DETAIL,
+                     _("Mismatches occurred between scanned device output and expected TDO values.\n"));
+        else
+            urj_log (URJ_LOG_LEVEL_DETAIL,
+                     _("Scanned device output matched expected TDO values.\n"));
     }
 
-    if (priv.mismatch_occurred > 0)
-        urj_log (URJ_LOG_LEVEL_DETAIL,
-                 _("Mismatches occurred between scanned device output and expected TDO values.\n"));
-    else
-        urj_log (URJ_LOG_LEVEL_DETAIL,
-                 _("Scanned device output matched expected TDO values.\n"));
-
     /* clean up */
+    for (i = 0; i < 2; i++)
+    {
+        urj_svf_free_padding (&priv->header[i]);
+        urj_svf_free_padding (&priv->trailer[i]);
+    }
+    urj_tap_register_free (priv->raw_in);
+    urj_tap_register_free (priv->raw_out);
+    priv->raw_in = priv->raw_out = NULL;
+
     /* SIR */
-    if (priv.sir_params.params.tdi)
-        free (priv.sir_params.params.tdi);
-    if (priv.sir_params.params.mask)
-        free (priv.sir_params.params.mask);
-    if (priv.sir_params.params.smask)
-        free (priv.sir_params.params.smask);
+    if (priv->sir_params.params.tdi)
+        free (priv->sir_params.params.tdi);
+    if (priv->sir_params.params.mask)
+        free (priv->sir_params.params.mask);
+    if (priv->sir_params.params.smask)
+        free (priv->sir_params.params.smask);
     /* SDR */
-    if (priv.sdr_params.params.tdi)
-        free (priv.sdr_params.params.tdi);
-    if (priv.sdr_params.params.mask)
-        free (priv.sdr_params.params.mask);
-    if (priv.sdr_params.params.smask)
-        free (priv.sdr_params.params.smask);
+    if (priv->sdr_params.params.tdi)
+        free (priv->sdr_params.params.tdi);
+    if (priv->sdr_params.params.mask)
+        free (priv->sdr_params.params.mask);
+    if (priv->sdr_params.params.smask)
+        free (priv->sdr_params.params.smask);
+}
+
+
+/* ***************************************************************************
+ * urj_svf_run(chain, SVF_FILE, stop_on_mismatch, ref_freq)
+ *
+ * Main entry point for the 'svf' command. Calls the svf parser, or the
+ * player if SVF_FILE has been created by urj_svf_compile().
+ *
+ * Checks the jtag-environment (availability of SIR instruction and SDR
+ * register). Initializes all svf-global variables and performs clean-up
+ * afterwards.
+ *
+ * Parameter:
+ *   chain            : pointer to global chain
+ *   SVF_FILE         : file handle of SVF file
+ *   stop_on_mismatch : 1 = stop upon tdo mismatch
+ *                      0 = continue upon mismatch
+ *   ref_freq         : reference frequency for RUNTEST
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ * ***************************************************************************/
+int
+urj_svf_run (urj_chain_t *chain, FILE *SVF_FILE, int stop_on_mismatch,
+             uint32_t ref_freq)
+{
+    return urj_svf_run_profile (chain, SVF_FILE, stop_on_mismatch, ref_freq,
+                                NULL);
+}
+
+
+/*
+ * urj_svf_execute(chain, SVF_FILE, stop_on_mismatch, ref_freq, PROFILE_FILE,
+ *                 dry_run, latency)
+ *
+ * Runs or plays SVF_FILE, profiling if PROFILE_FILE is given or for a dry
+ * run, see urj_svf_run_profile() and urj_svf_dry_run().
+ */
+static int
+urj_svf_execute (urj_chain_t *chain, FILE *SVF_FILE, int stop_on_mismatch,
+                 uint32_t ref_freq, FILE *PROFILE_FILE, int dry_run,
+                 double latency)
+{
+    urj_svf_parser_priv_t priv;
+    uint32_t old_frequency;
+    int result = URJ_STATUS_OK;
+
+    if (chain == NULL || chain->cable == NULL)
+        return  URJ_STATUS_FAIL;
+
+    old_frequency = urj_tap_cable_get_frequency (chain->cable);
+
+    if (urj_svf_init (chain, &priv, stop_on_mismatch, ref_freq)
+        != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    priv.dry_run = dry_run;
+
+    if ((PROFILE_FILE != NULL || dry_run)
+        && (priv.profile = urj_svf_profile_start (chain, PROFILE_FILE))
+           == NULL)
+    {
+        urj_svf_done (chain, &priv, 0);
+        return URJ_STATUS_FAIL;
+    }
+    if (dry_run)
+    {
+        priv.profile->dry_run = 1;
+        priv.profile->latency = latency;
+    }
+
+    if (urj_svf_is_compiled (SVF_FILE))
+        result = urj_svf_play (chain, &priv, SVF_FILE);
+    else
+    {
+        if (urj_svf_bison_init (&priv, SVF_FILE,
+                                urj_svf_count_lines (SVF_FILE)))
+        {
+            if (urj_svf_parse (&priv, chain) != 0)
+                result = URJ_STATUS_FAIL;
+            urj_svf_bison_deinit (&priv);
+        }
+        else
+            result = URJ_STATUS_FAIL;
+    }
+
+    urj_svf_done (chain, &priv, !dry_run);
+
+    /* predict for the frequency the file set unless given explicitly */
+    if (priv.profile != NULL)
+        priv.profile->frequency = ref_freq > 0 ? ref_freq
+            : urj_tap_cable_get_frequency (chain->cable);
 
     /* restore previous frequency setting, required by SVF spec */
     if (old_frequency != urj_tap_cable_get_frequency (chain->cable))
         urj_tap_cable_set_frequency (chain->cable, old_frequency);
 
-    return URJ_STATUS_OK;
+    urj_svf_profile_finish (&priv, result);
+
+    return result;
+}
+
+
+/* ***************************************************************************
+ * urj_svf_run_profile(chain, SVF_FILE, stop_on_mismatch, ref_freq,
+ *                     PROFILE_FILE)
+ *
+ * Like urj_svf_run(), additionally writes progress and profile records in
+ * JSON to PROFILE_FILE unless it is NULL.
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ * ***************************************************************************/
+int
+urj_svf_run_profile (urj_chain_t *chain, FILE *SVF_FILE,
+                     int stop_on_mismatch, uint32_t ref_freq,
+                     FILE *PROFILE_FILE)
+{
+    return urj_svf_execute (chain, SVF_FILE, stop_on_mismatch, ref_freq,
+                            PROFILE_FILE, 0, 0.0);
+}
+
+
+/* ***************************************************************************
+ * urj_svf_dry_run(chain, SVF_FILE, ref_freq, latency, PROFILE_FILE)
+ *
+ * Executes SVF_FILE without verifying TDO, typically on the jim cable, and
+ * reports the TCK cycles and round trips per command type together with
+ * the time a cable running at ref_freq would need.
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ * ***************************************************************************/
+int
+urj_svf_dry_run (urj_chain_t *chain, FILE *SVF_FILE, uint32_t ref_freq,
+                 double latency, FILE *PROFILE_FILE)
+{
+    return urj_svf_execute (chain, SVF_FILE, 0, ref_freq, PROFILE_FILE, 1,
+                            latency);
+}
+
+
+/* ***************************************************************************
+ * urj_svf_run_xsvf(chain, XSVF_FILE, stop_on_mismatch, ref_freq)
+ *
+ * Main entry point for the 'xsvf' command. Executes the binary XSVF commands
+ * from XSVF_FILE with the same engine as the SVF player.
+ *
+ * Parameter:
+ *   chain            : pointer to global chain
+ *   XSVF_FILE        : file handle of XSVF file
+ *   stop_on_mismatch : 1 = stop upon tdo mismatch
+ *                      0 = continue upon mismatch
+ *   ref_freq         : reference frequency for XRUNTEST and XWAIT
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ * ***************************************************************************/
+int
+urj_svf_run_xsvf (urj_chain_t *chain, FILE *XSVF_FILE, int stop_on_mismatch,
+                  uint32_t ref_freq)
+{
+    urj_svf_parser_priv_t priv;
+    int result;
+
+    if (chain == NULL || chain->cable == NULL)
+        return  URJ_STATUS_FAIL;
+
+    if (urj_svf_init (chain, &priv, stop_on_mismatch, ref_freq)
+        != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    result = urj_svf_xsvf_play (chain, &priv, XSVF_FILE);
+
+    urj_svf_done (chain, &priv, 1);
+
+    return result;
+}
+
+
+/* ***************************************************************************
+ * urj_svf_run_gang(chains, num_chains, SVF_FILE, stop_on_mismatch, ref_freq,
+ *                  results)
+ *
+ * Executes one SVF file on several chains with identical boards. The file
+ * is translated once with urj_svf_compile() on the first chain, unless it
+ * is compiled already, and the vectors are played on all chains in
+ * lockstep. Each chain keeps its own state and TDO verification, which is
+ * deferred until the transfers of all cables are under way.
+ *
+ * Parameter:
+ *   chains           : chains to program, each with its own cable
+ *   num_chains       : number of chains
+ *   SVF_FILE         : file handle of SVF file
+ *   stop_on_mismatch : 1 = stop a chain upon tdo mismatch
+ *                      0 = continue upon mismatch
+ *   ref_freq         : reference frequency for RUNTEST
+ *   results          : receives URJ_STATUS_OK for every chain that executed
+ *                      the file without error and TDO mismatch,
+ *                      URJ_STATUS_FAIL otherwise
+ *
+ * Return value:
+ *   URJ_STATUS_OK   : the file was executed, see results for each chain
+ *   URJ_STATUS_FAIL : the file could not be prepared, all results are set
+ *                     to URJ_STATUS_FAIL
+ * ***************************************************************************/
+int
+urj_svf_run_gang (urj_chain_t **chains, int num_chains, FILE *SVF_FILE,
+                  int stop_on_mismatch, uint32_t ref_freq, int *results)
+{
+    urj_svf_parser_priv_t *privs;
+    uint32_t *old_frequency;
+    char *initialized;
+    FILE *bin_file = SVF_FILE;
+    int result = URJ_STATUS_OK;
+    int i;
+
+    if (num_chains < 1)
+    {
+        urj_error_set (URJ_ERROR_INVALID, _("%s: no chains given"), "svf");
+        return URJ_STATUS_FAIL;
+    }
+    for (i = 0; i < num_chains; i++)
+        results[i] = URJ_STATUS_FAIL;
+    for (i = 0; i < num_chains; i++)
+        if (chains[i] == NULL || chains[i]->cable == NULL)
+        {
+            urj_error_set (URJ_ERROR_NO_CHAIN,
+                           _("%s: chain %d has no cable"), "svf", i);
+            return URJ_STATUS_FAIL;
+        }
+
+    /* translate once for all chains */
+    if (!urj_svf_is_compiled (SVF_FILE))
+    {
+        bin_file = tmpfile ();
+        if (bin_file == NULL)
+        {
+            urj_error_IO_set (_("%s: cannot create temporary file"), "svf");
+            return URJ_STATUS_FAIL;
+        }
+        if (urj_svf_compile (chains[0], SVF_FILE, bin_file, ref_freq)
+            != URJ_STATUS_OK || fflush (bin_file) != 0)
+        {
+            fclose (bin_file);
+            return URJ_STATUS_FAIL;
+        }
+    }
+
+    privs = calloc (num_chains, sizeof *privs);
+    old_frequency = calloc (num_chains, sizeof *old_frequency);
+    initialized = calloc (num_chains, 1);
+    if (privs == NULL || old_frequency == NULL || initialized == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%d) fails",
+                       num_chains);
+        result = URJ_STATUS_FAIL;
+        goto out;
+    }
+
+    for (i = 0; i < num_chains; i++)
+    {
+        old_frequency[i] = urj_tap_cable_get_frequency (chains[i]->cable);
+        if (urj_svf_init (chains[i], &privs[i], stop_on_mismatch, ref_freq)
+            != URJ_STATUS_OK)
+        {
+            urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+            continue;
+        }
+        snprintf (privs[i].name, sizeof privs[i].name, "svf[%d]", i);
+        /* TDO is verified once the scans of all chains are under way,
+           without the queue at once */
+        if (privs[i].pending_tdo == NULL)
+            privs[i].pending_tdo = calloc (URJ_SVF_PENDING_TDO_MAX,
+                                           sizeof (struct svf_pending_tdo));
+        initialized[i] = 1;
+        results[i] = URJ_STATUS_OK;
+    }
+
+    /* failures are recorded per chain */
+    if (urj_svf_play_gang (chains, privs, num_chains, bin_file, results)
+        != URJ_STATUS_OK)
+        urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+
+    for (i = 0; i < num_chains; i++)
+    {
+        if (initialized[i])
+        {
+            urj_svf_done (chains[i], &privs[i], 0);
+            if (privs[i].mismatch_occurred > 0)
+                results[i] = URJ_STATUS_FAIL;
+        }
+
+        /* restore previous frequency setting, required by SVF spec */
+        if (old_frequency[i]
+            != urj_tap_cable_get_frequency (chains[i]->cable))
+            urj_tap_cable_set_frequency (chains[i]->cable, old_frequency[i]);
+
+        urj_log (URJ_LOG_LEVEL_NORMAL, "svf[%d]: %s\n", i,
+                 results[i] == URJ_STATUS_OK ? _("passed") : _("FAILED"));
+    }
+
+ out:
+    free (privs);
+    free (old_frequency);
+    free (initialized);
+    if (bin_file != SVF_FILE)
+        fclose (bin_file);
+
+    return result;
+}
+
+
+/* ***************************************************************************
+ * urj_svf_compile(chain, SVF_FILE, BIN_FILE, ref_freq)
+ *
+ * Translates SVF_FILE into the binary vector format that is replayed by
+ * urj_svf_run(). State paths are resolved and RUNTEST times are converted
+ * to clock counts for ref_freq, or the cable frequency if ref_freq is 0.
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ * ***************************************************************************/
+int
+urj_svf_compile (urj_chain_t *chain, FILE *SVF_FILE, FILE *BIN_FILE,
+                 uint32_t ref_freq)
+{
+    urj_svf_parser_priv_t priv;
+    int old_state;
+    int result = URJ_STATUS_FAIL;
+
+    if (chain == NULL || chain->cable == NULL)
+        return  URJ_STATUS_FAIL;
+
+    if (urj_svf_init (chain, &priv, 1, ref_freq) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    priv.compile = urj_svf_compile_open (BIN_FILE, priv.ir->value->len,
+                                         ref_freq,
+                                         urj_tap_cable_get_frequency (chain->cable));
+    if (priv.compile == NULL)
+    {
+        urj_svf_done (chain, &priv, 0);
+        return URJ_STATUS_FAIL;
+    }
+
+    /* the player starts from whatever state the TAP is in */
+    old_state = urj_tap_state (chain);
+    urj_tap_state_init (chain);
+
+    if (urj_svf_bison_init (&priv, SVF_FILE, urj_svf_count_lines (SVF_FILE)))
+    {
+        if (urj_svf_parse (&priv, chain) == 0)
+            result = URJ_STATUS_OK;
+        urj_svf_bison_deinit (&priv);
+    }
+
+    if (urj_svf_compile_close (priv.compile) != URJ_STATUS_OK)
+        result = URJ_STATUS_FAIL;
+    priv.compile = NULL;
+
+    chain->state = old_state;
+
+    urj_svf_done (chain, &priv, 0);
+
+    return result;
 }
@@ -37,11 +37,25 @@ enum generic_irdr_coding
 };
 
 
+/* hexadecimal value inside the memory mapped input, including white space */
+struct hexa_slice
+{
+    const char *ptr;
+    size_t  len;
+};
+/* pieces of a hexadecimal value as returned by the scanner */
 struct hexa_frag
 {
-    char   *buf;
-    size_t  buflen;
-    size_t  strlen;
+    struct hexa_slice *pieces;
+    size_t  num;
+    size_t  alloc;
+    int     owned;              /* pieces are malloc'ed HEXA_NUM_FRAGMENTs */
+};
+/* value of TDI, TDO, MASK or SMASK, packed LSB first */
+struct hexa_value
+{
+    int     bits;               /* four per hexadecimal digit */
+    uint8_t *data;              /* (bits + 7) / 8 bytes, allocated along */
 };
 struct tdval
 {
@@ -59,10 +73,10 @@ struct tcval
 struct ths_params
 {
     double number;
-    char *tdi;
-    char *tdo;
-    char *mask;
-    char *smask;
+    struct hexa_value *tdi;
+    struct hexa_value *tdo;
+    struct hexa_value *mask;
+    struct hexa_value *smask;
 };
 
 struct path_states
@@ -89,6 +103,16 @@ typedef struct
 } urj_svf_sxr_t;
 
 
+/* HIR/HDR or TIR/TDR pattern, packed LSB first */
+struct svf_padding
+{
+    int len;
+    uint8_t *tdi;
+    uint8_t *tdo;               /* NULL if not checked */
+    uint8_t *mask;
+};
+
+
 struct svf_parser_params
 {
     struct ths_params ths_params;
@@ -97,6 +121,26 @@ struct svf_parser_params
 };
 
 
+/* SIR/SDR with TDO whose captured output has not been checked yet */
+struct svf_pending_tdo;
+
+/* output state of 'svf compile', see svf_compile.c */
+typedef struct svf_compile urj_svf_compile_t;
+
+/* time and bits per command type for 'svf ... profile=', see svf.c */
+struct svf_profile;
+
+enum svf_profile_type
+{
+    URJ_SVF_PROFILE_PARSE,      /* anything but the types below */
+    URJ_SVF_PROFILE_SIR,
+    URJ_SVF_PROFILE_SDR,
+    URJ_SVF_PROFILE_RUNTEST,
+    URJ_SVF_PROFILE_STATE,
+    URJ_SVF_PROFILE_VERIFY,     /* deferred TDO verification */
+    URJ_SVF_PROFILE_NUM
+};
+
 /* private data of the bison parser
    used to store variables the would end up as globals otherwise */
 struct parser_priv
@@ -116,7 +160,25 @@ struct parser_priv
     int svf_trst_absent;
     int svf_state_executed;
     uint32_t ref_freq;
+    /* prefix of mismatch reports, identifies the chain in gang mode */
+    char name[16];
     int mismatch_occurred;
+    /* deferred TDO verification, NULL if every scan is checked at once */
+    struct svf_pending_tdo *pending_tdo;
+    int num_pending_tdo;
+    long pending_tdo_bits;
+    /* HIR/HDR and TIR/TDR, indexed by enum generic_irdr_coding */
+    struct svf_padding header[2];
+    struct svf_padding trailer[2];
+    /* whole chain scan of SIR/SDR with header and trailer */
+    urj_tap_register_t *raw_in;
+    urj_tap_register_t *raw_out;
+    /* binary output, NULL if commands are executed on the chain */
+    urj_svf_compile_t *compile;
+    /* NULL unless profiling */
+    struct svf_profile *profile;
+    /* TDO is captured but not verified, SIR/SDR are whole chain scans */
+    int dry_run;
     /* protocol issued warnings */
     int issued_runtest_maxtime;
 };
@@ -127,12 +189,17 @@ struct scanner_extra
     int num_lines;
     int planb;
     char decimal_point;
+    /* input file mapped into memory, NULL if it is read through stdio */
+    char *map;
+    size_t map_len;
+    long double start;
+    struct svf_profile *profile;
 };
 typedef struct scanner_extra urj_svf_scanner_extra_t;
 
 struct YYLTYPE;
 
-void *urj_svf_flex_init (FILE *, int);
+void *urj_svf_flex_init (FILE *, int, struct svf_profile *);
 void urj_svf_flex_deinit (void *);
 
 int urj_svf_bison_init (urj_svf_parser_priv_t *, FILE *, int);
@@ -140,8 +207,9 @@ void urj_svf_bison_deinit (urj_svf_parser_priv_t *);
 
 void urj_svf_endxr (urj_svf_parser_priv_t *, enum generic_irdr_coding,
                     int);
-void urj_svf_frequency (urj_chain_t *, double);
-int urj_svf_hxr (enum generic_irdr_coding, struct ths_params *);
+void urj_svf_frequency (urj_chain_t *, urj_svf_parser_priv_t *, double);
+int urj_svf_hxr (urj_svf_parser_priv_t *, enum generic_irdr_coding,
+                 struct ths_params *);
 int urj_svf_runtest (urj_chain_t *, urj_svf_parser_priv_t *,
                      struct runtest *);
 int urj_svf_state (urj_chain_t *, urj_svf_parser_priv_t *,
@@ -150,4 +218,57 @@ int urj_svf_sxr (urj_chain_t *, urj_svf_parser_priv_t *,
                  enum generic_irdr_coding, struct ths_params *,
                  struct YYLTYPE *);
 int urj_svf_trst (urj_chain_t *, urj_svf_parser_priv_t *, int);
-int urj_svf_txr (enum generic_irdr_coding, struct ths_params *);
+int urj_svf_txr (urj_svf_parser_priv_t *, enum generic_irdr_coding,
+                 struct ths_params *);
+
+/* shared by the parser and the player of compiled files */
+void urj_svf_force_reset_state (urj_chain_t *, urj_svf_parser_priv_t *);
+void urj_svf_clock (urj_chain_t *, urj_svf_parser_priv_t *, int, uint32_t);
+void urj_svf_goto_state (urj_chain_t *, urj_svf_parser_priv_t *, int);
+int urj_svf_clock_max_time (urj_chain_t *, urj_svf_parser_priv_t *,
+                            uint32_t, double);
+int urj_svf_setup_register (urj_svf_parser_priv_t *,
+                            enum generic_irdr_coding, int, struct YYLTYPE *);
+int urj_svf_setup_raw (urj_svf_parser_priv_t *, int);
+int urj_svf_shift (urj_chain_t *, urj_svf_parser_priv_t *,
+                   enum generic_irdr_coding, int, const uint8_t *,
+                   const uint8_t *, int, struct YYLTYPE *);
+int urj_svf_check_pending_tdo (urj_chain_t *, urj_svf_parser_priv_t *);
+int urj_svf_pending_tdo_due (const urj_svf_parser_priv_t *);
+int urj_svf_match_tdo (const uint8_t *, const uint8_t *, const char *, int);
+int urj_svf_compare_tdo (urj_svf_parser_priv_t *, const uint8_t *,
+                         const uint8_t *, const char *, int,
+                         struct YYLTYPE *);
+int urj_svf_runtest_count (urj_chain_t *, urj_svf_parser_priv_t *, uint32_t,
+                           double, uint32_t *);
+struct hexa_value *urj_svf_hexa_decode (struct hexa_frag *);
+void urj_svf_hexa_free (struct hexa_frag *);
+uint8_t *urj_svf_value_to_packed (const struct hexa_value *, int);
+int urj_svf_profile_enter (urj_svf_parser_priv_t *, int);
+void urj_svf_profile_leave (urj_svf_parser_priv_t *, int, uint64_t);
+void urj_svf_profile_progress (struct svf_profile *, long, long);
+void urj_svf_packed_to_register (const uint8_t *, urj_tap_register_t *);
+void urj_svf_register_to_packed (const urj_tap_register_t *, uint8_t *);
+
+/* svf_compile.c */
+urj_svf_compile_t *urj_svf_compile_open (FILE *, int, uint32_t, uint32_t);
+int urj_svf_compile_close (urj_svf_compile_t *);
+uint32_t urj_svf_compile_get_frequency (urj_svf_compile_t *);
+void urj_svf_compile_clock (urj_chain_t *, urj_svf_compile_t *, int,
+                            uint32_t);
+void urj_svf_compile_reset (urj_svf_compile_t *);
+void urj_svf_compile_goto (urj_chain_t *, urj_svf_compile_t *, int);
+int urj_svf_compile_timed (urj_chain_t *, urj_svf_compile_t *, uint32_t,
+                           double);
+int urj_svf_compile_shift (urj_svf_compile_t *, enum generic_irdr_coding, int,
+                           const urj_tap_register_t *, const uint8_t *,
+                           const uint8_t *, struct YYLTYPE *);
+void urj_svf_compile_trst (urj_svf_compile_t *, int);
+void urj_svf_compile_frequency (urj_svf_compile_t *, double);
+int urj_svf_is_compiled (FILE *);
+int urj_svf_play (urj_chain_t *, urj_svf_parser_priv_t *, FILE *);
+int urj_svf_play_gang (urj_chain_t **, urj_svf_parser_priv_t *, int, FILE *,
+                       int *);
+
+/* xsvf.c */
+int urj_svf_xsvf_play (urj_chain_t *, urj_svf_parser_priv_t *, FILE *);
@@ -33,11 +33,15 @@
 %locations
 
 %{
+#include <sysdep.h>
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <ctype.h>
 
 #include <string.h>
 
+#include <urjtag/error.h>
 #include <urjtag/log.h>
 
 #include "svf.h"
@@ -55,6 +59,8 @@ int yylex (YYSTYPE *, YYLTYPE *, void *);
 void yyerror(YYLTYPE *, urj_svf_parser_priv_t *priv_data, urj_chain_t *, const char *);
 
 static void urj_svf_free_ths_params(struct ths_params *);
+static int urj_svf_hexa_append(struct hexa_frag *, const char *, size_t, int);
+static int urj_svf_set_value(struct hexa_value **, struct hexa_frag *);
 %}
 
 %union {
@@ -63,12 +69,13 @@ static void urj_svf_free_ths_params(struct ths_params *);
   char  *cvalue;
   int    ivalue;
   struct hexa_frag hexa_frag;
+  struct hexa_slice hexa_slice;
   struct tdval tdval;
   struct tcval *tcval;
 }
 
 
-%token IDENTIFIER NUMBER HEXA_NUM_FRAGMENT VECTOR_STRING
+%token IDENTIFIER NUMBER HEXA_NUM_FRAGMENT HEXA_NUM_SLICE VECTOR_STRING
 
 %token EMPTY
 %token ENDDR ENDIR
@@ -85,6 +92,7 @@ static void urj_svf_free_ths_params(struct ths_params *);
 
 %type <dvalue> NUMBER
 %type <cvalue> HEXA_NUM_FRAGMENT
+%type <hexa_slice> HEXA_NUM_SLICE
 %type <tdval>  runtest_clk_count
 %type <token>  runtest_run_state_opt
 %type <token>  runtest_end_state_opt
@@ -103,6 +111,10 @@ line
        * of yyparse() will read from this buffer, executing commands after the
        * previous error!
        */
+      {
+        /* report the failed command to the caller */
+        YYABORT;
+      }
 ;
 
 
@@ -119,30 +131,42 @@ svf_statement
 
     | FREQUENCY ';'
       {
-        urj_svf_frequency(chain, 0.0);
+        urj_svf_frequency(chain, priv_data, 0.0);
       }
 
     | FREQUENCY NUMBER HZ ';'
       {
-        urj_svf_frequency(chain, $2);
+        urj_svf_frequency(chain, priv_data, $2);
       }
 
     | HDR NUMBER ths_param_list ';'
       {
         struct ths_params *p = &(priv_data->parser_params.ths_params);
+        int result;
 
         p->number = $2;
-        urj_svf_hxr(generic_dr, p);
+        result = urj_svf_hxr(priv_data, generic_dr, p);
         urj_svf_free_ths_params(p);
+
+        if (result != URJ_STATUS_OK) {
+          yyerror(&@$, priv_data, chain, "HDR");
+          YYERROR;
+        }
       }
 
     | HIR NUMBER ths_param_list ';'
       {
         struct ths_params *p = &(priv_data->parser_params.ths_params);
+        int result;
 
         p->number = $2;
-        urj_svf_hxr(generic_ir, p);
+        result = urj_svf_hxr(priv_data, generic_ir, p);
         urj_svf_free_ths_params(p);
+
+        if (result != URJ_STATUS_OK) {
+          yyerror(&@$, priv_data, chain, "HIR");
+          YYERROR;
+        }
       }
 
     | PIOMAP '(' direction IDENTIFIER piomap_rec ')' ';'
@@ -164,12 +188,18 @@ svf_statement
       {
         struct runtest *rt = &(priv_data->parser_params.runtest);
 
+        int prev, result;
+
         rt->run_state = $2;
         rt->run_count = $3.dvalue;
         rt->run_clk   = $3.token;
         rt->end_state = $5;
 
-        if (urj_svf_runtest(chain, priv_data, rt) != URJ_STATUS_OK) {
+        prev = urj_svf_profile_enter(priv_data, URJ_SVF_PROFILE_RUNTEST);
+        result = urj_svf_runtest(chain, priv_data, rt);
+        urj_svf_profile_leave(priv_data, prev, 0);
+
+        if (result != URJ_STATUS_OK) {
           yyerror(&@$, priv_data, chain, "RUNTEST");
           YYERROR;
         }
@@ -179,12 +209,18 @@ svf_statement
       {
         struct runtest *rt = &(priv_data->parser_params.runtest);
 
+        int prev, result;
+
         rt->run_state = $2;
         rt->run_count = 0;
         rt->run_clk   = 0;
         rt->end_state = $4;
 
-        if (urj_svf_runtest(chain, priv_data, rt) != URJ_STATUS_OK) {
+        prev = urj_svf_profile_enter(priv_data, URJ_SVF_PROFILE_RUNTEST);
+        result = urj_svf_runtest(chain, priv_data, rt);
+        urj_svf_profile_leave(priv_data, prev, 0);
+
+        if (result != URJ_STATUS_OK) {
           yyerror(&@$, priv_data, chain, "RUNTEST");
           YYERROR;
         }
@@ -193,10 +229,12 @@ svf_statement
     | SDR NUMBER ths_param_list ';'
       {
         struct ths_params *p = &(priv_data->parser_params.ths_params);
-        int result;
+        int prev, result;
 
         p->number = $2;
+        prev = urj_svf_profile_enter(priv_data, URJ_SVF_PROFILE_SDR);
         result = urj_svf_sxr(chain, priv_data, generic_dr, p, &@$);
+        urj_svf_profile_leave(priv_data, prev, p->number);
         urj_svf_free_ths_params(p);
 
         if (result != URJ_STATUS_OK) {
@@ -208,10 +246,12 @@ svf_statement
     | SIR NUMBER ths_param_list ';'
       {
         struct ths_params *p = &(priv_data->parser_params.ths_params);
-        int result;
+        int prev, result;
 
         p->number = $2;
+        prev = urj_svf_profile_enter(priv_data, URJ_SVF_PROFILE_SIR);
         result = urj_svf_sxr(chain, priv_data, generic_ir, p, &@$);
+        urj_svf_profile_leave(priv_data, prev, p->number);
         urj_svf_free_ths_params(p);
 
         if (result != URJ_STATUS_OK) {
@@ -222,7 +262,13 @@ svf_statement
 
     | STATE path_states stable_state ';'
       {
-        if (urj_svf_state(chain, priv_data, &(priv_data->parser_params.path_states), $<token>3) != URJ_STATUS_OK) {
+        int prev, result;
+
+        prev = urj_svf_profile_enter(priv_data, URJ_SVF_PROFILE_STATE);
+        result = urj_svf_state(chain, priv_data, &(priv_data->parser_params.path_states), $<token>3);
+        urj_svf_profile_leave(priv_data, prev, 0);
+
+        if (result != URJ_STATUS_OK) {
           yyerror(&@$, priv_data, chain, "STATE");
           YYERROR;
         }
@@ -234,7 +280,7 @@ svf_statement
         int result;
 
         p->number = $2;
-        result = urj_svf_txr(generic_dr, p);
+        result = urj_svf_txr(priv_data, generic_dr, p);
         urj_svf_free_ths_params(p);
 
         if (result != URJ_STATUS_OK) {
@@ -249,7 +295,7 @@ svf_statement
         int result;
 
         p->number = $2;
-        result = urj_svf_txr(generic_ir, p);
+        result = urj_svf_txr(priv_data, generic_ir, p);
         urj_svf_free_ths_params(p);
 
         if (result != URJ_STATUS_OK) {
@@ -276,49 +322,76 @@ ths_param_list
 ths_opt_param
             : TDI   '(' hexa_num_sequence ')'
               {
-                priv_data->parser_params.ths_params.tdi = $3.buf;
+                if (urj_svf_set_value (&priv_data->parser_params.ths_params.tdi,
+                                       &$3) != URJ_STATUS_OK) {
+                  yyerror(&@$, priv_data, chain, "TDI");
+                  YYERROR;
+                }
               }
 
             | TDO   '(' hexa_num_sequence ')'
               {
-                priv_data->parser_params.ths_params.tdo = $3.buf;
+                if (urj_svf_set_value (&priv_data->parser_params.ths_params.tdo,
+                                       &$3) != URJ_STATUS_OK) {
+                  yyerror(&@$, priv_data, chain, "TDO");
+                  YYERROR;
+                }
               }
 
             | MASK  '(' hexa_num_sequence ')'
               {
-                priv_data->parser_params.ths_params.mask = $3.buf;
+                if (urj_svf_set_value (&priv_data->parser_params.ths_params.mask,
+                                       &$3) != URJ_STATUS_OK) {
+                  yyerror(&@$, priv_data, chain, "MASK");
+                  YYERROR;
+                }
               }
 
             | SMASK '(' hexa_num_sequence ')'
               {
-                priv_data->parser_params.ths_params.smask = $3.buf;
+                if (urj_svf_set_value (&priv_data->parser_params.ths_params.smask,
+                                       &$3) != URJ_STATUS_OK) {
+                  yyerror(&@$, priv_data, chain, "SMASK");
+                  YYERROR;
+                }
               }
 ;
 
 hexa_num_sequence
-           : HEXA_NUM_FRAGMENT
+           : HEXA_NUM_SLICE
              {
-                 $$.buf    = $1;
-                 $$.strlen = strlen ($1);
-                 $$.buflen = $$.strlen + 1;
+                 memset (&$$, 0, sizeof $$);
+                 if (urj_svf_hexa_append (&$$, $1.ptr, $1.len, 0)
+                     != URJ_STATUS_OK)
+                     YYERROR;
              }
-           | hexa_num_sequence HEXA_NUM_FRAGMENT
+           | HEXA_NUM_FRAGMENT
              {
-#define REALLOC_STEP (1 << 16)
-                 size_t frag_len = strlen ($2);
-                 size_t req_len = $1.strlen + frag_len;
-                 if ($1.buflen <= req_len) {
-                     size_t newlen = req_len - $1.buflen < REALLOC_STEP ?
-                         $1.buflen + REALLOC_STEP : req_len + 1;
-                     $1.buf = (char *)realloc ($1.buf, newlen);
-                     $1.buflen = newlen;
+                 memset (&$$, 0, sizeof $$);
+                 if (urj_svf_hexa_append (&$$, $1, strlen ($1), 1)
+                     != URJ_STATUS_OK) {
+                     free ($1);
+                     YYERROR;
                  }
-                 if ($1.buf != NULL) {
-                     memcpy ($1.buf + $1.strlen, $2, frag_len + 1);
-                     $1.strlen += frag_len;
+             }
+           | hexa_num_sequence HEXA_NUM_SLICE
+             {
+                 $$ = $1;
+                 if (urj_svf_hexa_append (&$$, $2.ptr, $2.len, 0)
+                     != URJ_STATUS_OK) {
+                     urj_svf_hexa_free (&$$);
+                     YYERROR;
                  }
-                 free ($2);
+             }
+           | hexa_num_sequence HEXA_NUM_FRAGMENT
+             {
                  $$ = $1;
+                 if (urj_svf_hexa_append (&$$, $2, strlen ($2), 1)
+                     != URJ_STATUS_OK) {
+                     free ($2);
+                     urj_svf_hexa_free (&$$);
+                     YYERROR;
+                 }
              }
 ;
 
@@ -449,6 +522,11 @@ yyerror (YYLTYPE *locp, urj_svf_parser_priv_t *priv_data, urj_chain_t *chain,
 {
     urj_log (URJ_LOG_LEVEL_ERROR, "Error occurred for SVF command, line %d, column %d-%d:\n %s.\n",
              locp->first_line, locp->first_column, locp->last_column, error_string);
+
+    /* set an error if nothing else is pending */
+    if (urj_error_get () == URJ_ERROR_OK)
+        urj_error_set (URJ_ERROR_INVALID, _("%s: error in line %d: %s"),
+                       "svf", locp->first_line, error_string);
 }
 
 
@@ -480,6 +558,53 @@ urj_svf_free_ths_params (struct ths_params *params)
 }
 
 
+/*
+ * Adds a piece of a hexadecimal value as returned by the scanner. Memory
+ * mapped input comes in slices, which may be split by tabs or carriage
+ * returns like the fragments read from a stream.
+ */
+static int
+urj_svf_hexa_append (struct hexa_frag *frag, const char *ptr, size_t len,
+                     int owned)
+{
+    if (frag->num == frag->alloc)
+    {
+        size_t alloc = frag->alloc ? 2 * frag->alloc : 16;
+        struct hexa_slice *pieces;
+
+        pieces = realloc (frag->pieces, alloc * sizeof *pieces);
+        if (pieces == NULL)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "realloc(%s,%zd) fails",
+                           "frag->pieces", alloc * sizeof *pieces);
+            return URJ_STATUS_FAIL;
+        }
+        frag->pieces = pieces;
+        frag->alloc = alloc;
+    }
+
+    frag->pieces[frag->num].ptr = ptr;
+    frag->pieces[frag->num].len = len;
+    frag->num++;
+    frag->owned = owned;
+
+    return URJ_STATUS_OK;
+}
+
+
+/*
+ * Decodes the value of TDI, TDO, MASK or SMASK for the current command.
+ */
+static int
+urj_svf_set_value (struct hexa_value **value, struct hexa_frag *frag)
+{
+    free (*value);
+    *value = urj_svf_hexa_decode (frag);
+
+    return *value != NULL ? URJ_STATUS_OK : URJ_STATUS_FAIL;
+}
+
+
 int
 urj_svf_bison_init (urj_svf_parser_priv_t *priv_data, FILE *f, int num_lines)
 {
@@ -492,7 +617,7 @@ urj_svf_bison_init (urj_svf_parser_priv_t *priv_data, FILE *f, int num_lines)
     priv_data->parser_params = params;
 
     if ((priv_data->scanner =
-         urj_svf_flex_init (f, num_lines)) == NULL)
+         urj_svf_flex_init (f, num_lines, priv_data->profile)) == NULL)
         return 0;
     else
         return 1;
@@ -502,5 +627,7 @@ urj_svf_bison_init (urj_svf_parser_priv_t *priv_data, FILE *f, int num_lines)
 void
 urj_svf_bison_deinit (urj_svf_parser_priv_t *priv_data)
 {
+    /* values of a command that failed to parse */
+    urj_svf_free_ths_params (&priv_data->parser_params.ths_params);
     urj_svf_flex_deinit (priv_data->scanner);
 }
@@ -0,0 +1,908 @@
+/*
+ * $Id$
+ *
+ * Copyright (C) 2026, UrJTAG developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ * Binary vector format produced by 'svf compile' and its player.
+ *
+ * All numbers are little endian. The file starts with the header
+ *
+ *   magic[8]  "UrJSVFb\0"
+ *   u32       format version
+ *   u32       reference frequency for RUNTEST times, 0 = cable frequency
+ *   u32       cable frequency at compile time
+ *   u32       SIR length
+ *
+ * followed by a sequence of operations, each introduced by an opcode byte:
+ *
+ *   CLOCK     u8 tms, u32 count            clock with TDI = 0
+ *   RESET                                  force Test-Logic-Reset
+ *   GOTO      u8 state                     move from an unknown state or
+ *                                          to the end state of SIR/SDR
+ *   TIMED     u32 count, f64 max_time      RUNTEST with MAXIMUM
+ *   SIR, SDR  u8 flags, u32 len, [4 x u32 location], tdi[],
+ *             [tdo[], mask[]]              packed LSB first, flags: TDO,
+ *                                          location, whole chain scan
+ *   TRST      u8 value                     TRST pin level
+ *   FREQUENCY u32 Hz                       cable frequency
+ *   END
+ */
+
+#include <sysdep.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#include <urjtag/error.h>
+#include <urjtag/log.h>
+#include <urjtag/cable.h>
+#include <urjtag/pod.h>
+#include <urjtag/chain.h>
+#include <urjtag/tap_state.h>
+#include <urjtag/tap_register.h>
+#include <urjtag/part_instruction.h>
+#include <urjtag/data_register.h>
+
+#include "svf.h"
+
+#include "svf_bison.h"
+
+#define URJ_SVF_MAGIC           "UrJSVFb"
+#define URJ_SVF_MAGIC_LEN       8
+#define URJ_SVF_VERSION         1
+
+enum
+{
+    URJ_SVF_OP_END,
+    URJ_SVF_OP_CLOCK,
+    URJ_SVF_OP_RESET,
+    URJ_SVF_OP_GOTO,
+    URJ_SVF_OP_TIMED,
+    URJ_SVF_OP_SIR,
+    URJ_SVF_OP_SDR,
+    URJ_SVF_OP_TRST,
+    URJ_SVF_OP_FREQUENCY,
+};
+
+/* flags of SIR/SDR */
+#define URJ_SVF_SXR_TDO         0x01
+#define URJ_SVF_SXR_LOC         0x02
+#define URJ_SVF_SXR_RAW         0x04    /* whole chain incl. HIR/TIR etc. */
+
+struct svf_compile
+{
+    FILE *file;
+    int error;
+    uint32_t frequency;         /* cable frequency as set by the SVF file */
+    int clock_tms;              /* TMS of the clocks not written yet */
+    uint32_t clock_count;
+};
+
+
+static void
+urj_svf_put (urj_svf_compile_t *c, const void *data, size_t len)
+{
+    if (!c->error && fwrite (data, 1, len, c->file) != len)
+        c->error = 1;
+}
+
+static void
+urj_svf_put_u8 (urj_svf_compile_t *c, unsigned int value)
+{
+    uint8_t b = value;
+
+    urj_svf_put (c, &b, 1);
+}
+
+static void
+urj_svf_put_u32 (urj_svf_compile_t *c, uint32_t value)
+{
+    uint8_t b[4];
+    int i;
+
+    for (i = 0; i < 4; i++)
+        b[i] = value >> (8 * i);
+    urj_svf_put (c, b, 4);
+}
+
+static void
+urj_svf_put_u64 (urj_svf_compile_t *c, uint64_t value)
+{
+    uint8_t b[8];
+    int i;
+
+    for (i = 0; i < 8; i++)
+        b[i] = value >> (8 * i);
+    urj_svf_put (c, b, 8);
+}
+
+/*
+ * Writes the run of clocks collected by urj_svf_compile_clock().
+ */
+static void
+urj_svf_compile_flush (urj_svf_compile_t *c)
+{
+    if (c->clock_count == 0)
+        return;
+
+    urj_svf_put_u8 (c, URJ_SVF_OP_CLOCK);
+    urj_svf_put_u8 (c, c->clock_tms);
+    urj_svf_put_u32 (c, c->clock_count);
+    c->clock_count = 0;
+}
+
+urj_svf_compile_t *
+urj_svf_compile_open (FILE *file, int ir_len, uint32_t ref_freq,
+                      uint32_t frequency)
+{
+    urj_svf_compile_t *c;
+
+    c = calloc (1, sizeof *c);
+    if (c == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd,%zd) fails",
+                       (size_t) 1, sizeof *c);
+        return NULL;
+    }
+
+    c->file = file;
+    c->frequency = frequency;
+
+    urj_svf_put (c, URJ_SVF_MAGIC, URJ_SVF_MAGIC_LEN);
+    urj_svf_put_u32 (c, URJ_SVF_VERSION);
+    urj_svf_put_u32 (c, ref_freq);
+    urj_svf_put_u32 (c, frequency);
+    urj_svf_put_u32 (c, ir_len);
+
+    if (c->error)
+    {
+        urj_error_set (URJ_ERROR_FILEIO, "fwrite fails");
+        free (c);
+        return NULL;
+    }
+
+    return c;
+}
+
+int
+urj_svf_compile_close (urj_svf_compile_t *c)
+{
+    int error;
+
+    urj_svf_compile_flush (c);
+    urj_svf_put_u8 (c, URJ_SVF_OP_END);
+    if (fflush (c->file) != 0)
+        c->error = 1;
+
+    error = c->error;
+    free (c);
+
+    if (error)
+    {
+        urj_error_set (URJ_ERROR_FILEIO, "fwrite fails");
+        return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+uint32_t
+urj_svf_compile_get_frequency (urj_svf_compile_t *c)
+{
+    return c->frequency;
+}
+
+void
+urj_svf_compile_clock (urj_chain_t *chain, urj_svf_compile_t *c, int tms,
+                       uint32_t n)
+{
+    uint32_t i;
+
+    if (n == 0)
+        return;
+
+    if (c->clock_count > 0
+        && (c->clock_tms != tms || c->clock_count > UINT32_MAX - n))
+        urj_svf_compile_flush (c);
+    c->clock_tms = tms;
+    c->clock_count += n;
+
+    /* every state is left or reached for good within 5 clocks */
+    for (i = 0; i < n && i < 6; i++)
+        urj_tap_state_clock (chain, tms);
+}
+
+void
+urj_svf_compile_reset (urj_svf_compile_t *c)
+{
+    urj_svf_compile_flush (c);
+    urj_svf_put_u8 (c, URJ_SVF_OP_RESET);
+}
+
+void
+urj_svf_compile_goto (urj_chain_t *chain, urj_svf_compile_t *c, int state)
+{
+    urj_svf_compile_flush (c);
+    urj_svf_put_u8 (c, URJ_SVF_OP_GOTO);
+    urj_svf_put_u8 (c, state);
+
+    /* the player takes care of reaching it */
+    chain->state = state;
+}
+
+int
+urj_svf_compile_timed (urj_chain_t *chain, urj_svf_compile_t *c,
+                       uint32_t n, double max_time)
+{
+    uint64_t bits;
+    uint32_t i;
+
+    memcpy (&bits, &max_time, sizeof bits);
+
+    urj_svf_compile_flush (c);
+    urj_svf_put_u8 (c, URJ_SVF_OP_TIMED);
+    urj_svf_put_u32 (c, n);
+    urj_svf_put_u64 (c, bits);
+
+    for (i = 0; i < n && i < 6; i++)
+        urj_tap_state_clock (chain, 0);
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_svf_compile_shift (urj_svf_compile_t *c, enum generic_irdr_coding ir_dr,
+                       int raw, const urj_tap_register_t *in,
+                       const uint8_t *tdo, const uint8_t *mask, YYLTYPE *loc)
+{
+    size_t bytes = (in->len + 7) / 8;
+    uint8_t *tdi;
+
+    tdi = malloc (bytes > 0 ? bytes : 1);
+    if (tdi == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails", bytes);
+        return URJ_STATUS_FAIL;
+    }
+    urj_svf_register_to_packed (in, tdi);
+
+    urj_svf_compile_flush (c);
+    urj_svf_put_u8 (c, ir_dr == generic_ir ? URJ_SVF_OP_SIR : URJ_SVF_OP_SDR);
+    urj_svf_put_u8 (c, (tdo ? URJ_SVF_SXR_TDO : 0)
+                    | (loc ? URJ_SVF_SXR_LOC : 0)
+                    | (raw ? URJ_SVF_SXR_RAW : 0));
+    urj_svf_put_u32 (c, in->len);
+    if (loc)
+    {
+        urj_svf_put_u32 (c, loc->first_line);
+        urj_svf_put_u32 (c, loc->first_column);
+        urj_svf_put_u32 (c, loc->last_line);
+        urj_svf_put_u32 (c, loc->last_column);
+    }
+    urj_svf_put (c, tdi, bytes);
+    if (tdo)
+    {
+        urj_svf_put (c, tdo, bytes);
+        urj_svf_put (c, mask, bytes);
+    }
+
+    free (tdi);
+
+    return URJ_STATUS_OK;
+}
+
+void
+urj_svf_compile_trst (urj_svf_compile_t *c, int trst)
+{
+    urj_svf_compile_flush (c);
+    urj_svf_put_u8 (c, URJ_SVF_OP_TRST);
+    urj_svf_put_u8 (c, trst);
+}
+
+void
+urj_svf_compile_frequency (urj_svf_compile_t *c, double freq)
+{
+    c->frequency = freq;
+
+    urj_svf_compile_flush (c);
+    urj_svf_put_u8 (c, URJ_SVF_OP_FREQUENCY);
+    urj_svf_put_u32 (c, c->frequency);
+}
+
+
+/*
+ * Player
+ */
+
+typedef struct
+{
+    const uint8_t *pos;
+    const uint8_t *end;
+}
+urj_svf_reader_t;
+
+static const uint8_t *
+urj_svf_get (urj_svf_reader_t *r, size_t len)
+{
+    const uint8_t *data = r->pos;
+
+    if ((size_t) (r->end - r->pos) < len)
+        return NULL;
+    r->pos += len;
+
+    return data;
+}
+
+static int
+urj_svf_get_u8 (urj_svf_reader_t *r, uint8_t *value)
+{
+    const uint8_t *b = urj_svf_get (r, 1);
+
+    if (b == NULL)
+        return URJ_STATUS_FAIL;
+    *value = b[0];
+
+    return URJ_STATUS_OK;
+}
+
+static int
+urj_svf_get_u32 (urj_svf_reader_t *r, uint32_t *value)
+{
+    const uint8_t *b = urj_svf_get (r, 4);
+
+    if (b == NULL)
+        return URJ_STATUS_FAIL;
+    *value = b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t) b[3] << 24);
+
+    return URJ_STATUS_OK;
+}
+
+static int
+urj_svf_get_u64 (urj_svf_reader_t *r, uint64_t *value)
+{
+    uint32_t lo, hi;
+
+    if (urj_svf_get_u32 (r, &lo) != URJ_STATUS_OK
+        || urj_svf_get_u32 (r, &hi) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    *value = lo | ((uint64_t) hi << 32);
+
+    return URJ_STATUS_OK;
+}
+
+static int
+urj_svf_valid_state (int state)
+{
+    static const int states[] = {
+        URJ_TAP_STATE_TEST_LOGIC_RESET, URJ_TAP_STATE_RUN_TEST_IDLE,
+        URJ_TAP_STATE_SELECT_DR_SCAN, URJ_TAP_STATE_CAPTURE_DR,
+        URJ_TAP_STATE_SHIFT_DR, URJ_TAP_STATE_EXIT1_DR,
+        URJ_TAP_STATE_PAUSE_DR, URJ_TAP_STATE_EXIT2_DR,
+        URJ_TAP_STATE_UPDATE_DR, URJ_TAP_STATE_SELECT_IR_SCAN,
+        URJ_TAP_STATE_CAPTURE_IR, URJ_TAP_STATE_SHIFT_IR,
+        URJ_TAP_STATE_EXIT1_IR, URJ_TAP_STATE_PAUSE_IR,
+        URJ_TAP_STATE_EXIT2_IR, URJ_TAP_STATE_UPDATE_IR,
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof states / sizeof states[0]; i++)
+        if (states[i] == state)
+            return 1;
+
+    return 0;
+}
+
+/*
+ * Executes one SIR/SDR operation. *failed is set if the scan itself failed,
+ * e.g. upon TDO mismatch with stop_on_mismatch. *shifted receives the
+ * number of bits scanned.
+ */
+static int
+urj_svf_play_shift (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+                    urj_svf_reader_t *r, enum generic_irdr_coding ir_dr,
+                    int *failed, uint64_t *shifted)
+{
+    const uint8_t *tdi, *tdo = NULL, *mask = NULL;
+    YYLTYPE loc;
+    uint8_t flags;
+    uint32_t len, v[4];
+    size_t bytes;
+    int i;
+
+    if (urj_svf_get_u8 (r, &flags) != URJ_STATUS_OK
+        || urj_svf_get_u32 (r, &len) != URJ_STATUS_OK || len > INT32_MAX)
+        return URJ_STATUS_FAIL;
+
+    memset (&loc, 0, sizeof loc);
+    if (flags & URJ_SVF_SXR_LOC)
+    {
+        for (i = 0; i < 4; i++)
+            if (urj_svf_get_u32 (r, &v[i]) != URJ_STATUS_OK)
+                return URJ_STATUS_FAIL;
+        loc.first_line = v[0];
+        loc.first_column = v[1];
+        loc.last_line = v[2];
+        loc.last_column = v[3];
+    }
+
+    bytes = ((size_t) len + 7) / 8;
+    if ((tdi = urj_svf_get (r, bytes)) == NULL)
+        return URJ_STATUS_FAIL;
+    if (flags & URJ_SVF_SXR_TDO)
+        if ((tdo = urj_svf_get (r, bytes)) == NULL
+            || (mask = urj_svf_get (r, bytes)) == NULL)
+            return URJ_STATUS_FAIL;
+
+    /* a dry run shifts whole chain scans of the command's length */
+    if (priv->dry_run)
+        flags |= URJ_SVF_SXR_RAW;
+
+    if (flags & URJ_SVF_SXR_RAW)
+    {
+        if (urj_svf_setup_raw (priv, len) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        urj_svf_packed_to_register (tdi, priv->raw_in);
+    }
+    else
+    {
+        if (urj_svf_setup_register (priv, ir_dr, len,
+                                    flags & URJ_SVF_SXR_LOC ? &loc : NULL)
+            != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+        urj_svf_packed_to_register (tdi, ir_dr == generic_ir
+                                    ? priv->ir->value : priv->dr->in);
+    }
+
+    if (urj_svf_shift (chain, priv, ir_dr, flags & URJ_SVF_SXR_RAW ? 1 : 0,
+                       tdo, mask, 0, flags & URJ_SVF_SXR_LOC ? &loc : NULL)
+        != URJ_STATUS_OK)
+        *failed = 1;
+    *shifted = len;
+
+    return URJ_STATUS_OK;
+}
+
+/* position of one chain in a compiled file in memory */
+typedef struct
+{
+    urj_svf_reader_t r;
+    const uint8_t *data;
+    const uint8_t *failed_pos;  /* operation that failed */
+    int failed;                 /* a scan failed, complete it and stop */
+    int completed;              /* end state of the failed scan reached */
+}
+urj_svf_player_t;
+
+/* result of urj_svf_play_op() */
+enum
+{
+    URJ_SVF_PLAY_NEXT,
+    URJ_SVF_PLAY_END,
+    URJ_SVF_PLAY_ERROR,
+};
+
+/*
+ * Checks the header of a compiled file in memory and positions the player
+ * on the first operation.
+ */
+static int
+urj_svf_play_start (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+                    urj_svf_player_t *p, const uint8_t *data, size_t size)
+{
+    uint32_t version, ref_freq, frequency, ir_len;
+
+    p->r.pos = p->data = data;
+    p->r.end = data + size;
+    p->failed_pos = NULL;
+    p->failed = 0;
+    p->completed = 0;
+
+    if (urj_svf_get (&p->r, URJ_SVF_MAGIC_LEN) == NULL
+        || urj_svf_get_u32 (&p->r, &version) != URJ_STATUS_OK
+        || urj_svf_get_u32 (&p->r, &ref_freq) != URJ_STATUS_OK
+        || urj_svf_get_u32 (&p->r, &frequency) != URJ_STATUS_OK
+        || urj_svf_get_u32 (&p->r, &ir_len) != URJ_STATUS_OK)
+    {
+        urj_error_set (URJ_ERROR_SYNTAX, _("%s: truncated header"), "svf");
+        return URJ_STATUS_FAIL;
+    }
+    if (version != URJ_SVF_VERSION)
+    {
+        urj_error_set (URJ_ERROR_UNSUPPORTED,
+                       _("%s: unsupported compiled format version %lu"),
+                       "svf", (unsigned long) version);
+        return URJ_STATUS_FAIL;
+    }
+    if (ir_len != (uint32_t) priv->ir->value->len)
+    {
+        urj_error_set (URJ_ERROR_INVALID,
+                       _("%s: compiled for instruction length %lu, part has %d"),
+                       "svf", (unsigned long) ir_len, priv->ir->value->len);
+        return URJ_STATUS_FAIL;
+    }
+    if (ref_freq == 0
+        && frequency != urj_tap_cable_get_frequency (chain->cable))
+        urj_warning (_("RUNTEST times were converted for %lu Hz\n"),
+                     (unsigned long) frequency);
+
+    return URJ_STATUS_OK;
+}
+
+/*
+ * Profile type of an operation, see urj_svf_profile_enter().
+ */
+static int
+urj_svf_play_profile_type (uint8_t op)
+{
+    switch (op)
+    {
+    case URJ_SVF_OP_SIR:
+        return URJ_SVF_PROFILE_SIR;
+    case URJ_SVF_OP_SDR:
+        return URJ_SVF_PROFILE_SDR;
+    case URJ_SVF_OP_TIMED:
+        return URJ_SVF_PROFILE_RUNTEST;
+    case URJ_SVF_OP_CLOCK:
+    case URJ_SVF_OP_RESET:
+    case URJ_SVF_OP_GOTO:
+        return URJ_SVF_PROFILE_STATE;
+    default:
+        return URJ_SVF_PROFILE_PARSE;
+    }
+}
+
+/*
+ * Executes the next operation of a compiled file.
+ *
+ * Return value:
+ *   URJ_SVF_PLAY_NEXT, URJ_SVF_PLAY_END, URJ_SVF_PLAY_ERROR
+ */
+static int
+urj_svf_play_op (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+                 urj_svf_player_t *p)
+{
+    const uint8_t *op_pos = p->r.pos;
+    uint32_t n;
+    uint64_t bits, shifted = 0;
+    double max_time;
+    uint8_t op, value;
+    int prev, result;
+
+    if (urj_svf_get_u8 (&p->r, &op) != URJ_STATUS_OK)
+        op = 0xff;
+
+    prev = urj_svf_profile_enter (priv, urj_svf_play_profile_type (op));
+
+    /* a failed scan is completed by moving to its end state like the
+       SVF command would, then execution stops */
+    if (p->failed && (op != URJ_SVF_OP_GOTO || p->completed))
+        result = URJ_STATUS_FAIL;
+    else
+        switch (op)
+        {
+        case URJ_SVF_OP_END:
+            urj_svf_profile_leave (priv, prev, 0);
+            return URJ_SVF_PLAY_END;
+
+        case URJ_SVF_OP_CLOCK:
+            result = urj_svf_get_u8 (&p->r, &value);
+            if (result == URJ_STATUS_OK)
+                result = urj_svf_get_u32 (&p->r, &n);
+            if (result == URJ_STATUS_OK)
+                urj_svf_clock (chain, priv, value & 1, n);
+            break;
+
+        case URJ_SVF_OP_RESET:
+            urj_svf_force_reset_state (chain, priv);
+            result = URJ_STATUS_OK;
+            break;
+
+        case URJ_SVF_OP_GOTO:
+            result = urj_svf_get_u8 (&p->r, &value);
+            if (result == URJ_STATUS_OK && !urj_svf_valid_state (value))
+                result = URJ_STATUS_FAIL;
+            if (result == URJ_STATUS_OK)
+                urj_svf_goto_state (chain, priv, value);
+            p->completed = p->failed;
+            break;
+
+        case URJ_SVF_OP_TIMED:
+            result = urj_svf_get_u32 (&p->r, &n);
+            if (result == URJ_STATUS_OK)
+                result = urj_svf_get_u64 (&p->r, &bits);
+            if (result == URJ_STATUS_OK)
+            {
+                memcpy (&max_time, &bits, sizeof max_time);
+                result = urj_svf_clock_max_time (chain, priv, n, max_time);
+            }
+            break;
+
+        case URJ_SVF_OP_SIR:
+        case URJ_SVF_OP_SDR:
+            result = urj_svf_play_shift (chain, priv, &p->r,
+                                         op == URJ_SVF_OP_SIR ? generic_ir
+                                                              : generic_dr,
+                                         &p->failed, &shifted);
+            if (p->failed)
+                p->failed_pos = op_pos;
+            break;
+
+        case URJ_SVF_OP_TRST:
+            result = urj_svf_get_u8 (&p->r, &value);
+            if (result == URJ_STATUS_OK)
+                urj_tap_chain_set_trst (chain, value);
+            break;
+
+        case URJ_SVF_OP_FREQUENCY:
+            result = urj_svf_get_u32 (&p->r, &n);
+            if (result == URJ_STATUS_OK)
+                urj_tap_cable_set_frequency (chain->cable, n);
+            break;
+
+        default:
+            result = URJ_STATUS_FAIL;
+            break;
+        }
+
+    urj_svf_profile_leave (priv, prev, shifted);
+
+    if (result == URJ_STATUS_OK)
+        return URJ_SVF_PLAY_NEXT;
+
+    if (!p->failed)
+        p->failed_pos = op_pos;
+    urj_log (URJ_LOG_LEVEL_ERROR,
+             _("Error occurred for compiled SVF operation at offset %ld.\n"),
+             (long) (p->failed_pos - p->data));
+    if (urj_error_get () == URJ_ERROR_OK)
+        urj_error_set (URJ_ERROR_INVALID,
+                       _("%s: operation at offset %ld failed"), "svf",
+                       (long) (p->failed_pos - p->data));
+
+    return URJ_SVF_PLAY_ERROR;
+}
+
+/*
+ * Maps or reads a compiled file into memory.
+ */
+static uint8_t *
+urj_svf_load (FILE *file, size_t *size, int *mapped)
+{
+    struct stat st;
+    uint8_t *data = NULL;
+
+    *mapped = 0;
+
+    if (fstat (fileno (file), &st) != 0)
+    {
+        urj_error_IO_set ("fstat fails");
+        return NULL;
+    }
+    *size = st.st_size;
+
+#if defined HAVE_MMAP && defined HAVE_SYS_MMAN_H
+    data = mmap (NULL, *size, PROT_READ, MAP_PRIVATE, fileno (file), 0);
+    if (data == MAP_FAILED)
+        data = NULL;
+    else
+        *mapped = 1;
+#endif
+
+    /* fall back to reading the whole file */
+    if (data == NULL)
+    {
+        data = malloc (*size > 0 ? *size : 1);
+        if (data == NULL)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
+                           *size);
+            return NULL;
+        }
+        rewind (file);
+        if (fread (data, 1, *size, file) != *size)
+        {
+            urj_error_set (URJ_ERROR_FILEIO, "fread fails");
+            free (data);
+            return NULL;
+        }
+    }
+
+    return data;
+}
+
+static void
+urj_svf_unload (uint8_t *data, size_t size, int mapped)
+{
+#if defined HAVE_MMAP && defined HAVE_SYS_MMAN_H
+    if (mapped)
+        munmap (data, size);
+    else
+#endif
+        free (data);
+}
+
+int
+urj_svf_is_compiled (FILE *file)
+{
+    char magic[URJ_SVF_MAGIC_LEN];
+    int compiled;
+
+    rewind (file);
+    compiled = fread (magic, 1, sizeof magic, file) == sizeof magic
+        && memcmp (magic, URJ_SVF_MAGIC, URJ_SVF_MAGIC_LEN) == 0;
+    rewind (file);
+
+    return compiled;
+}
+
+int
+urj_svf_play (urj_chain_t *chain, urj_svf_parser_priv_t *priv, FILE *file)
+{
+    urj_svf_player_t p;
+    uint8_t *data;
+    size_t size;
+    int mapped, step;
+    int result = URJ_STATUS_FAIL;
+
+    data = urj_svf_load (file, &size, &mapped);
+    if (data == NULL)
+        return URJ_STATUS_FAIL;
+
+    if (urj_svf_play_start (chain, priv, &p, data, size) == URJ_STATUS_OK)
+    {
+        do
+        {
+            step = urj_svf_play_op (chain, priv, &p);
+            urj_svf_profile_progress (priv->profile, p.r.pos - data, size);
+        }
+        while (step == URJ_SVF_PLAY_NEXT);
+
+        if (step == URJ_SVF_PLAY_END)
+            result = URJ_STATUS_OK;
+    }
+
+    /* deferred TDO checks refer to the data */
+    urj_svf_check_pending_tdo (chain, priv);
+
+    urj_svf_unload (data, size, mapped);
+
+    return result;
+}
+
+/*
+ * Plays a compiled file on several chains in lockstep: each chain executes
+ * one operation in turn. Scans with TDO are queued, the checks that are due
+ * are done after the round, when the transfers of all cables have been
+ * started, so that the cables work at the same time. Chains whose entry in
+ * results is not URJ_STATUS_OK are skipped, the entries of chains that fail
+ * are set to URJ_STATUS_FAIL. TDO mismatches are left to the caller, see
+ * priv->mismatch_occurred.
+ */
+int
+urj_svf_play_gang (urj_chain_t **chains, urj_svf_parser_priv_t *privs,
+                   int num_chains, FILE *file, int *results)
+{
+    urj_svf_player_t *players;
+    const uint8_t **op_pos;
+    char *running;
+    uint8_t *data;
+    size_t size;
+    int mapped, active = 0;
+    int i;
+
+    data = urj_svf_load (file, &size, &mapped);
+    players = calloc (num_chains, sizeof *players);
+    op_pos = calloc (num_chains, sizeof *op_pos);
+    running = calloc (num_chains, 1);
+    if (data == NULL || players == NULL || op_pos == NULL || running == NULL)
+    {
+        if (data != NULL)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%d) fails",
+                           num_chains);
+            urj_svf_unload (data, size, mapped);
+        }
+        free (players);
+        free (op_pos);
+        free (running);
+        for (i = 0; i < num_chains; i++)
+            results[i] = URJ_STATUS_FAIL;
+        return URJ_STATUS_FAIL;
+    }
+
+    for (i = 0; i < num_chains; i++)
+    {
+        if (results[i] != URJ_STATUS_OK)
+            continue;
+        if (urj_svf_play_start (chains[i], &privs[i], &players[i], data,
+                                size) != URJ_STATUS_OK)
+        {
+            urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+            results[i] = URJ_STATUS_FAIL;
+            continue;
+        }
+        running[i] = 1;
+        active++;
+    }
+
+    while (active > 0)
+    {
+        for (i = 0; i < num_chains; i++)
+        {
+            int step;
+
+            if (!running[i])
+                continue;
+
+            op_pos[i] = players[i].r.pos;
+            step = urj_svf_play_op (chains[i], &privs[i], &players[i]);
+            if (step == URJ_SVF_PLAY_NEXT)
+                continue;
+
+            if (step == URJ_SVF_PLAY_ERROR)
+            {
+                urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+                results[i] = URJ_STATUS_FAIL;
+            }
+            running[i] = 0;
+            active--;
+        }
+
+        /* start the transfers of all cables before waiting for any */
+        for (i = 0; i < num_chains; i++)
+            if (running[i] && urj_svf_pending_tdo_due (&privs[i]))
+                urj_tap_cable_flush (chains[i]->cable,
+                                     URJ_TAP_CABLE_TO_OUTPUT);
+
+        /* a mismatching scan is completed and stops the chain, as if it
+           had been verified at once */
+        for (i = 0; i < num_chains; i++)
+            if (running[i] && urj_svf_pending_tdo_due (&privs[i])
+                && urj_svf_check_pending_tdo (chains[i], &privs[i])
+                   != URJ_STATUS_OK)
+            {
+                players[i].failed = 1;
+                players[i].failed_pos = op_pos[i];
+            }
+    }
+
+    /* deferred TDO checks refer to the data, also those of chains which
+       stopped with an error */
+    for (i = 0; i < num_chains; i++)
+        if (urj_svf_check_pending_tdo (chains[i], &privs[i]) != URJ_STATUS_OK)
+            results[i] = URJ_STATUS_FAIL;
+
+    free (players);
+    free (op_pos);
+    free (running);
+    urj_svf_unload (data, size, mapped);
+
+    for (i = 0; i < num_chains; i++)
+        if (results[i] != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+    return URJ_STATUS_OK;
+}
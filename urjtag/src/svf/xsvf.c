@@ -0,0 +1,623 @@
+/*
+ * $Id$
+ *
+ * Copyright (C) 2026, UrJTAG developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ * XSVF player on top of the SVF execution engine.
+ *
+ * XSVF is the binary form of SVF described in Xilinx application note
+ * XAPP503. Every command is an opcode byte followed by its arguments.
+ * Numbers are big endian, TDI/TDO values are stored MSB first in
+ * (length + 7) / 8 bytes. The file is read sequentially, only the data of
+ * the current command is held in memory.
+ */
+
+#include <sysdep.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#include <urjtag/error.h>
+#include <urjtag/log.h>
+#include <urjtag/chain.h>
+#include <urjtag/tap_state.h>
+#include <urjtag/tap_register.h>
+#include <urjtag/part_instruction.h>
+#include <urjtag/data_register.h>
+
+#include "svf.h"
+
+enum
+{
+    URJ_XSVF_XCOMPLETE = 0x00,
+    URJ_XSVF_XTDOMASK = 0x01,
+    URJ_XSVF_XSIR = 0x02,
+    URJ_XSVF_XSDR = 0x03,
+    URJ_XSVF_XRUNTEST = 0x04,
+    URJ_XSVF_XREPEAT = 0x07,
+    URJ_XSVF_XSDRSIZE = 0x08,
+    URJ_XSVF_XSDRTDO = 0x09,
+    URJ_XSVF_XSETSDRMASKS = 0x0a,
+    URJ_XSVF_XSDRINC = 0x0b,
+    URJ_XSVF_XSDRB = 0x0c,
+    URJ_XSVF_XSDRC = 0x0d,
+    URJ_XSVF_XSDRE = 0x0e,
+    URJ_XSVF_XSDRTDOB = 0x0f,
+    URJ_XSVF_XSDRTDOC = 0x10,
+    URJ_XSVF_XSDRTDOE = 0x11,
+    URJ_XSVF_XSTATE = 0x12,
+    URJ_XSVF_XENDIR = 0x13,
+    URJ_XSVF_XENDDR = 0x14,
+    URJ_XSVF_XSIR2 = 0x15,
+    URJ_XSVF_XCOMMENT = 0x16,
+    URJ_XSVF_XWAIT = 0x17,
+};
+
+/* TAP states in XSVF encoding */
+static const int urj_xsvf_state[] = {
+    URJ_TAP_STATE_TEST_LOGIC_RESET, URJ_TAP_STATE_RUN_TEST_IDLE,
+    URJ_TAP_STATE_SELECT_DR_SCAN, URJ_TAP_STATE_CAPTURE_DR,
+    URJ_TAP_STATE_SHIFT_DR, URJ_TAP_STATE_EXIT1_DR,
+    URJ_TAP_STATE_PAUSE_DR, URJ_TAP_STATE_EXIT2_DR,
+    URJ_TAP_STATE_UPDATE_DR, URJ_TAP_STATE_SELECT_IR_SCAN,
+    URJ_TAP_STATE_CAPTURE_IR, URJ_TAP_STATE_SHIFT_IR,
+    URJ_TAP_STATE_EXIT1_IR, URJ_TAP_STATE_PAUSE_IR,
+    URJ_TAP_STATE_EXIT2_IR, URJ_TAP_STATE_UPDATE_IR,
+};
+
+#define URJ_XSVF_NUM_STATES \
+    ((int) (sizeof urj_xsvf_state / sizeof urj_xsvf_state[0]))
+
+typedef struct
+{
+    FILE *file;
+    long pos;                   /* offset of the next byte in file */
+    size_t size;                /* bytes allocated for each of the values */
+    uint8_t *tdi;               /* packed LSB first */
+    uint8_t *tdo;               /* expected TDO of the last XSDRTDO */
+    uint8_t *mask;              /* XTDOMASK */
+    uint8_t *all;               /* all bits care, for XSDRTDOB/C/E */
+    uint32_t sdr_size;          /* XSDRSIZE */
+    uint32_t runtest;           /* XRUNTEST in microseconds */
+    int max_repeat;             /* XREPEAT */
+    int endir;                  /* XENDIR */
+    int enddr;                  /* XENDDR */
+}
+urj_xsvf_t;
+
+
+static int
+urj_xsvf_read (urj_xsvf_t *x, void *data, size_t len)
+{
+    if (fread (data, 1, len, x->file) != len)
+    {
+        urj_error_set (URJ_ERROR_FILEIO,
+                       _("unexpected end of XSVF file at offset %ld"),
+                       x->pos);
+        return URJ_STATUS_FAIL;
+    }
+    x->pos += len;
+
+    return URJ_STATUS_OK;
+}
+
+static int
+urj_xsvf_get_u8 (urj_xsvf_t *x, uint32_t *value)
+{
+    uint8_t b;
+
+    if (urj_xsvf_read (x, &b, 1) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    *value = b;
+
+    return URJ_STATUS_OK;
+}
+
+static int
+urj_xsvf_get_u16 (urj_xsvf_t *x, uint32_t *value)
+{
+    uint8_t b[2];
+
+    if (urj_xsvf_read (x, b, 2) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    *value = (b[0] << 8) | b[1];
+
+    return URJ_STATUS_OK;
+}
+
+static int
+urj_xsvf_get_u32 (urj_xsvf_t *x, uint32_t *value)
+{
+    uint8_t b[4];
+
+    if (urj_xsvf_read (x, b, 4) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    *value = ((uint32_t) b[0] << 24) | (b[1] << 16) | (b[2] << 8) | b[3];
+
+    return URJ_STATUS_OK;
+}
+
+/*
+ * Makes room for values of len bits. Mask bits beyond the previous size
+ * are cleared.
+ */
+static int
+urj_xsvf_reserve (urj_xsvf_t *x, uint32_t len)
+{
+    size_t bytes = ((size_t) len + 7) / 8;
+    uint8_t **buf[] = { &x->tdi, &x->tdo, &x->mask, &x->all };
+    size_t i;
+
+    if (bytes <= x->size)
+        return URJ_STATUS_OK;
+
+    for (i = 0; i < sizeof buf / sizeof buf[0]; i++)
+    {
+        uint8_t *p = realloc (*buf[i], bytes);
+
+        if (p == NULL)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "realloc(%zd) fails",
+                           bytes);
+            return URJ_STATUS_FAIL;
+        }
+        *buf[i] = p;
+    }
+
+    memset (x->tdo + x->size, 0, bytes - x->size);
+    memset (x->mask + x->size, 0, bytes - x->size);
+    memset (x->all + x->size, 0xff, bytes - x->size);
+    x->size = bytes;
+
+    return URJ_STATUS_OK;
+}
+
+/*
+ * Reads a value of len bits into buf and converts it to the packed,
+ * LSB first representation of the SVF engine.
+ */
+static int
+urj_xsvf_get_value (urj_xsvf_t *x, uint8_t *buf, uint32_t len)
+{
+    size_t bytes = ((size_t) len + 7) / 8;
+    size_t i;
+
+    if (urj_xsvf_read (x, buf, bytes) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    for (i = 0; i < bytes / 2; i++)
+    {
+        uint8_t b = buf[i];
+
+        buf[i] = buf[bytes - 1 - i];
+        buf[bytes - 1 - i] = b;
+    }
+    if (len % 8)
+        buf[bytes - 1] &= (1 << (len % 8)) - 1;
+
+    return URJ_STATUS_OK;
+}
+
+static int
+urj_xsvf_get_state (urj_xsvf_t *x, int *state)
+{
+    uint32_t value;
+
+    if (urj_xsvf_get_u8 (x, &value) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    if (value >= URJ_XSVF_NUM_STATES)
+    {
+        urj_error_set (URJ_ERROR_INVALID, _("invalid XSVF TAP state %u"),
+                       (unsigned int) value);
+        return URJ_STATUS_FAIL;
+    }
+    *state = urj_xsvf_state[value];
+
+    return URJ_STATUS_OK;
+}
+
+/*
+ * Moves to state. Test-Logic-Reset is always entered with 5 clocks with
+ * TMS = 1, like the reference player does.
+ */
+static void
+urj_xsvf_goto_state (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+                     int state)
+{
+    if (state == URJ_TAP_STATE_TEST_LOGIC_RESET)
+        urj_svf_force_reset_state (chain, priv);
+    else
+        urj_svf_goto_state (chain, priv, state);
+}
+
+/*
+ * Stays in the current stable state for usecs microseconds, converted to
+ * clocks like the minimum time of RUNTEST.
+ */
+static int
+urj_xsvf_wait (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+               uint32_t usecs)
+{
+    uint32_t count;
+
+    if (urj_svf_runtest_count (chain, priv, 0, usecs / 1000000.0, &count)
+        != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    urj_svf_clock (chain, priv,
+                   urj_tap_state (chain) == URJ_TAP_STATE_TEST_LOGIC_RESET,
+                   count);
+
+    return URJ_STATUS_OK;
+}
+
+/*
+ * Shifts len bits of x->tdi from Shift-IR/DR, leaves the Shift state to
+ * end_state unless it is the Shift state itself and then waits runtest
+ * microseconds in Run-Test/Idle. If tdo is not NULL, the output is compared
+ * and the scan is repeated up to max_repeat times upon mismatch, following
+ * the exception handling of the XSVF specification. Like the reference
+ * player this is done whatever the run-test time; only with a run-test time
+ * the retry goes through Pause-DR and waits 25% longer each time.
+ */
+static int
+urj_xsvf_shift (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+                urj_xsvf_t *x, enum generic_irdr_coding ir_dr, uint32_t len,
+                int end_state, const uint8_t *tdo, const uint8_t *mask,
+                uint32_t runtest, int max_repeat)
+{
+    int shift_state = ir_dr == generic_ir ? URJ_TAP_STATE_SHIFT_IR
+                                          : URJ_TAP_STATE_SHIFT_DR;
+    int exit_shift = end_state != shift_state;
+    urj_tap_register_t *out;
+    int repeat, mismatch;
+
+    if (len == 0)
+    {
+        /* no shift, only wait in Run-Test/Idle (XSVF 2.00) */
+        if (runtest == 0)
+            return URJ_STATUS_OK;
+        urj_svf_goto_state (chain, priv, URJ_TAP_STATE_RUN_TEST_IDLE);
+        return urj_xsvf_wait (chain, priv, runtest);
+    }
+
+    if (urj_svf_setup_register (priv, ir_dr, len, NULL) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    urj_svf_packed_to_register (x->tdi, ir_dr == generic_ir ? priv->ir->value
+                                                            : priv->dr->in);
+    out = ir_dr == generic_ir ? priv->ir->out : priv->dr->out;
+
+    if (exit_shift && (tdo == NULL || max_repeat == 0))
+    {
+        /* nothing to retry, this is a plain SIR/SDR */
+        uint8_t *tdo_copy = NULL, *mask_copy = NULL;
+        size_t bytes = ((size_t) len + 7) / 8;
+        int result;
+
+        /* deferred verification keeps the expected values until checked */
+        if (tdo && priv->pending_tdo)
+        {
+            tdo_copy = malloc (bytes);
+            mask_copy = malloc (bytes);
+            if (tdo_copy == NULL || mask_copy == NULL)
+            {
+                free (tdo_copy);
+                free (mask_copy);
+                urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
+                               bytes);
+                return URJ_STATUS_FAIL;
+            }
+            memcpy (tdo_copy, tdo, bytes);
+            memcpy (mask_copy, mask, bytes);
+            tdo = tdo_copy;
+            mask = mask_copy;
+        }
+
+        urj_svf_goto_state (chain, priv, shift_state);
+        result = urj_svf_shift (chain, priv, ir_dr, 0, tdo, mask,
+                                tdo_copy != NULL, NULL);
+        urj_svf_goto_state (chain, priv, end_state);
+        if (result != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+        if (runtest)
+        {
+            urj_svf_goto_state (chain, priv, URJ_TAP_STATE_RUN_TEST_IDLE);
+            return urj_xsvf_wait (chain, priv, runtest);
+        }
+
+        return URJ_STATUS_OK;
+    }
+
+    /* the result of this scan is needed right away */
+    if (tdo && priv->num_pending_tdo > 0)
+        if (urj_svf_check_pending_tdo (chain, priv) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+    for (repeat = 0;; repeat++)
+    {
+        int chain_exit = exit_shift ? URJ_CHAIN_EXITMODE_EXIT1
+                                    : URJ_CHAIN_EXITMODE_SHIFT;
+
+        urj_svf_goto_state (chain, priv, shift_state);
+        if (ir_dr == generic_ir)
+            urj_tap_chain_shift_instructions_mode (chain, tdo != NULL, 0,
+                                                   chain_exit);
+        else
+            urj_tap_chain_shift_data_registers_mode (chain, tdo != NULL, 0,
+                                                     chain_exit);
+        mismatch = tdo != NULL
+            && urj_svf_match_tdo (tdo, mask, out->data, out->len) >= 0;
+
+        if (exit_shift)
+        {
+            if (mismatch && runtest && repeat < max_repeat)
+            {
+                /* shift one more bit via Pause-DR and wait 25% longer */
+                urj_svf_goto_state (chain, priv, URJ_TAP_STATE_PAUSE_DR);
+                urj_svf_goto_state (chain, priv, URJ_TAP_STATE_SHIFT_DR);
+                runtest += runtest >> 2;
+            }
+            else
+                urj_svf_goto_state (chain, priv, end_state);
+
+            if (runtest)
+            {
+                urj_svf_goto_state (chain, priv, URJ_TAP_STATE_RUN_TEST_IDLE);
+                if (urj_xsvf_wait (chain, priv, runtest) != URJ_STATUS_OK)
+                    return URJ_STATUS_FAIL;
+            }
+        }
+
+        if (!mismatch || repeat >= max_repeat)
+            break;
+
+        urj_log (URJ_LOG_LEVEL_DETAIL, _("%s: TDO mismatch, retry %d of %d\n"),
+                 "xsvf", repeat + 1, max_repeat);
+    }
+
+    if (!mismatch)
+        return URJ_STATUS_OK;
+
+    priv->mismatch_occurred = 1;
+
+    return urj_svf_compare_tdo (priv, tdo, mask, out->data, out->len, NULL);
+}
+
+/*
+ * Skips the text of XCOMMENT, it is shown with progress output.
+ */
+static int
+urj_xsvf_comment (urj_xsvf_t *x)
+{
+    char text[256];
+    size_t len = 0;
+    int c;
+
+    while ((c = getc (x->file)) != EOF)
+    {
+        x->pos++;
+        if (c == '\0')
+            break;
+        if (len < sizeof text - 1)
+            text[len++] = c;
+    }
+    if (c == EOF)
+    {
+        urj_error_set (URJ_ERROR_FILEIO,
+                       _("unexpected end of XSVF file at offset %ld"),
+                       x->pos);
+        return URJ_STATUS_FAIL;
+    }
+
+    text[len] = '\0';
+    urj_log (URJ_LOG_LEVEL_DETAIL, "%s\n", text);
+
+    return URJ_STATUS_OK;
+}
+
+/*
+ * Executes one XSVF command. *complete is set by XCOMPLETE.
+ */
+static int
+urj_xsvf_command (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+                  urj_xsvf_t *x, uint32_t cmd, int *complete)
+{
+    uint32_t len, value, usecs;
+    int state, end_state;
+
+    switch (cmd)
+    {
+    case URJ_XSVF_XCOMPLETE:
+        *complete = 1;
+        return URJ_STATUS_OK;
+
+    case URJ_XSVF_XTDOMASK:
+        return urj_xsvf_get_value (x, x->mask, x->sdr_size);
+
+    case URJ_XSVF_XSIR:
+    case URJ_XSVF_XSIR2:
+        if ((cmd == URJ_XSVF_XSIR ? urj_xsvf_get_u8 (x, &len)
+                                  : urj_xsvf_get_u16 (x, &len))
+            != URJ_STATUS_OK
+            || urj_xsvf_reserve (x, len) != URJ_STATUS_OK
+            || urj_xsvf_get_value (x, x->tdi, len) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        return urj_xsvf_shift (chain, priv, x, generic_ir, len, x->endir,
+                               NULL, NULL, x->runtest, 0);
+
+    case URJ_XSVF_XSDR:
+    case URJ_XSVF_XSDRTDO:
+        if (urj_xsvf_get_value (x, x->tdi, x->sdr_size) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        if (cmd == URJ_XSVF_XSDRTDO
+            && urj_xsvf_get_value (x, x->tdo, x->sdr_size) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        return urj_xsvf_shift (chain, priv, x, generic_dr, x->sdr_size,
+                               x->enddr, x->tdo, x->mask, x->runtest,
+                               x->max_repeat);
+
+    case URJ_XSVF_XSDRB:
+    case URJ_XSVF_XSDRC:
+    case URJ_XSVF_XSDRE:
+        if (urj_xsvf_get_value (x, x->tdi, x->sdr_size) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        return urj_xsvf_shift (chain, priv, x, generic_dr, x->sdr_size,
+                               cmd == URJ_XSVF_XSDRE ? x->enddr
+                                                     : URJ_TAP_STATE_SHIFT_DR,
+                               NULL, NULL, 0, 0);
+
+    case URJ_XSVF_XSDRTDOB:
+    case URJ_XSVF_XSDRTDOC:
+    case URJ_XSVF_XSDRTDOE:
+        if (urj_xsvf_get_value (x, x->tdi, x->sdr_size) != URJ_STATUS_OK
+            || urj_xsvf_get_value (x, x->tdo, x->sdr_size) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        return urj_xsvf_shift (chain, priv, x, generic_dr, x->sdr_size,
+                               cmd == URJ_XSVF_XSDRTDOE ? x->enddr
+                                                      : URJ_TAP_STATE_SHIFT_DR,
+                               x->tdo, x->all, 0, 0);
+
+    case URJ_XSVF_XRUNTEST:
+        return urj_xsvf_get_u32 (x, &x->runtest);
+
+    case URJ_XSVF_XREPEAT:
+        if (urj_xsvf_get_u8 (x, &value) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        x->max_repeat = value;
+        return URJ_STATUS_OK;
+
+    case URJ_XSVF_XSDRSIZE:
+        if (urj_xsvf_get_u32 (x, &len) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        if (len > INT_MAX)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_BOUNDS,
+                           _("XSDRSIZE %lu exceeds the supported size"),
+                           (unsigned long) len);
+            return URJ_STATUS_FAIL;
+        }
+        if (urj_xsvf_reserve (x, len) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        x->sdr_size = len;
+        return URJ_STATUS_OK;
+
+    case URJ_XSVF_XSTATE:
+        if (urj_xsvf_get_state (x, &state) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        urj_xsvf_goto_state (chain, priv, state);
+        return URJ_STATUS_OK;
+
+    case URJ_XSVF_XENDIR:
+    case URJ_XSVF_XENDDR:
+        if (urj_xsvf_get_u8 (x, &value) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        if (value > 1)
+        {
+            urj_error_set (URJ_ERROR_INVALID,
+                           _("invalid end state %u for %s"),
+                           (unsigned int) value,
+                           cmd == URJ_XSVF_XENDIR ? "XENDIR" : "XENDDR");
+            return URJ_STATUS_FAIL;
+        }
+        if (cmd == URJ_XSVF_XENDIR)
+            x->endir = value ? URJ_TAP_STATE_PAUSE_IR
+                             : URJ_TAP_STATE_RUN_TEST_IDLE;
+        else
+            x->enddr = value ? URJ_TAP_STATE_PAUSE_DR
+                             : URJ_TAP_STATE_RUN_TEST_IDLE;
+        return URJ_STATUS_OK;
+
+    case URJ_XSVF_XCOMMENT:
+        return urj_xsvf_comment (x);
+
+    case URJ_XSVF_XWAIT:
+        if (urj_xsvf_get_state (x, &state) != URJ_STATUS_OK
+            || urj_xsvf_get_state (x, &end_state) != URJ_STATUS_OK
+            || urj_xsvf_get_u32 (x, &usecs) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        urj_xsvf_goto_state (chain, priv, state);
+        if (urj_xsvf_wait (chain, priv, usecs) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        urj_xsvf_goto_state (chain, priv, end_state);
+        return URJ_STATUS_OK;
+
+    case URJ_XSVF_XSETSDRMASKS:
+    case URJ_XSVF_XSDRINC:
+        urj_error_set (URJ_ERROR_UNSUPPORTED,
+                       _("obsolete XSVF command %s not supported"),
+                       cmd == URJ_XSVF_XSDRINC ? "XSDRINC" : "XSETSDRMASKS");
+        return URJ_STATUS_FAIL;
+
+    default:
+        urj_error_set (URJ_ERROR_UNSUPPORTED,
+                       _("unknown XSVF command 0x%02x"), (unsigned int) cmd);
+        return URJ_STATUS_FAIL;
+    }
+}
+
+/*
+ * urj_svf_xsvf_play(chain, priv, file)
+ *
+ * Executes the XSVF commands in file until XCOMPLETE or end of file.
+ *
+ * Return value:
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ */
+int
+urj_svf_xsvf_play (urj_chain_t *chain, urj_svf_parser_priv_t *priv,
+                   FILE *file)
+{
+    urj_xsvf_t x;
+    long offset = 0;
+    int complete = 0;
+    int c, result = URJ_STATUS_OK;
+
+    memset (&x, 0, sizeof x);
+    x.file = file;
+    x.endir = x.enddr = URJ_TAP_STATE_RUN_TEST_IDLE;
+
+    while (!complete && (c = getc (file)) != EOF)
+    {
+        offset = x.pos++;
+        if (urj_xsvf_command (chain, priv, &x, c, &complete)
+            != URJ_STATUS_OK)
+        {
+            result = URJ_STATUS_FAIL;
+            break;
+        }
+    }
+
+    /* report mismatches of the commands executed so far */
+    if (urj_svf_check_pending_tdo (chain, priv) != URJ_STATUS_OK)
+        result = URJ_STATUS_FAIL;
+
+    if (result != URJ_STATUS_OK)
+        urj_log (URJ_LOG_LEVEL_ERROR,
+                 _("Error occurred for XSVF command at offset %ld.\n"),
+                 offset);
+
+    free (x.tdi);
+    free (x.tdo);
+    free (x.mask);
+    free (x.all);
+
+    return result;
+}
@@ -42,6 +42,7 @@
 #include <urjtag/chain.h>
 #include <urjtag/tap.h>
 #include <urjtag/cable.h>
+#include <urjtag/fclock.h>
 
 #include "cable.h"
 
@@ -105,10 +106,38 @@ urj_tap_cable_init (urj_cable_t *cable)
     return cable->driver->init (cable);
 }
 
+/* start and end of a driver call counted in cable->io_time */
+static long double
+urj_tap_cable_io_begin (urj_cable_t *cable)
+{
+    return cable->io_timing ? urj_lib_fmonotime () : 0;
+}
+
+static void
+urj_tap_cable_io_end (urj_cable_t *cable, long double start)
+{
+    if (cable->io_timing)
+        cable->io_time += urj_lib_fmonotime () - start;
+}
+
+/* TCK cycles and round trips counted in cable->io_clocks/io_round_trips */
+static void
+urj_tap_cable_io_count (urj_cable_t *cable, int clocks, int round_trips)
+{
+    if (cable->io_timing)
+    {
+        cable->io_clocks += clocks;
+        cable->io_round_trips += round_trips;
+    }
+}
+
 void
 urj_tap_cable_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
 {
+    long double start = urj_tap_cable_io_begin (cable);
+
     cable->driver->flush (cable, how_much);
+    urj_tap_cable_io_end (cable, start);
 }
 
 void
@@ -297,8 +326,13 @@ urj_tap_cable_purge_queue (urj_cable_queue_info_t *q, int io)
 void
 urj_tap_cable_clock (urj_cable_t *cable, int tms, int tdi, int n)
 {
+    long double start;
+
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+    urj_tap_cable_io_count (cable, n, 0);
+    start = urj_tap_cable_io_begin (cable);
     cable->driver->clock (cable, tms, tdi, n);
+    urj_tap_cable_io_end (cable, start);
 }
 
 int
@@ -311,6 +345,7 @@ urj_tap_cable_defer_clock (urj_cable_t *cable, int tms, int tdi, int n)
     cable->todo.data[i].arg.clock.tms = tms;
     cable->todo.data[i].arg.clock.tdi = tdi;
     cable->todo.data[i].arg.clock.n = n;
+    urj_tap_cable_io_count (cable, n, 0);
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
     return URJ_STATUS_OK;                   /* success */
 }
@@ -318,14 +353,23 @@ urj_tap_cable_defer_clock (urj_cable_t *cable, int tms, int tdi, int n)
 int
 urj_tap_cable_get_tdo (urj_cable_t *cable)
 {
+    long double start;
+    int tdo;
+
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
-    return cable->driver->get_tdo (cable);
+    urj_tap_cable_io_count (cable, 0, 1);
+    start = urj_tap_cable_io_begin (cable);
+    tdo = cable->driver->get_tdo (cable);
+    urj_tap_cable_io_end (cable, start);
+
+    return tdo;
 }
 
 int
 urj_tap_cable_get_tdo_late (urj_cable_t *cable)
 {
     int i;
+    urj_tap_cable_io_count (cable, 0, cable->done.num_items == 0);
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_TO_OUTPUT);
     i = urj_tap_cable_get_queue_item (cable, &cable->done);
     if (i >= 0)
@@ -380,6 +424,7 @@ int
 urj_tap_cable_get_signal (urj_cable_t *cable, urj_pod_sigsel_t sig)
 {
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+    urj_tap_cable_io_count (cable, 0, 1);
     return cable->driver->get_signal (cable, sig);
 }
 
@@ -387,6 +432,7 @@ int
 urj_tap_cable_get_signal_late (urj_cable_t *cable, urj_pod_sigsel_t sig)
 {
     int i;
+    urj_tap_cable_io_count (cable, 0, cable->done.num_items == 0);
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_TO_OUTPUT);
     i = urj_tap_cable_get_queue_item (cable, &cable->done);
     if (i >= 0)
@@ -428,14 +474,23 @@ urj_tap_cable_defer_get_signal (urj_cable_t *cable, urj_pod_sigsel_t sig)
 int
 urj_tap_cable_transfer (urj_cable_t *cable, int len, char *in, char *out)
 {
+    long double start;
+    int result;
+
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
-    return cable->driver->transfer (cable, len, in, out);
+    urj_tap_cable_io_count (cable, len, out != NULL);
+    start = urj_tap_cable_io_begin (cable);
+    result = cable->driver->transfer (cable, len, in, out);
+    urj_tap_cable_io_end (cable, start);
+
+    return result;
 }
 
 int
 urj_tap_cable_transfer_late (urj_cable_t *cable, char *out)
 {
     int i;
+    urj_tap_cable_io_count (cable, 0, cable->done.num_items == 0);
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_TO_OUTPUT);
     i = urj_tap_cable_get_queue_item (cable, &cable->done);
 
@@ -512,6 +567,7 @@ urj_tap_cable_defer_transfer (urj_cable_t *cable, int len, char *in,
         memcpy (ibuf, in, len);
     cable->todo.data[i].arg.transfer.in = ibuf;
     cable->todo.data[i].arg.transfer.out = obuf;
+    urj_tap_cable_io_count (cable, len, 0);
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
     return URJ_STATUS_OK;                   /* success */
 }
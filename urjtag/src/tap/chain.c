@@ -33,6 +33,7 @@
 #include <urjtag/tap_state.h>
 #include <urjtag/tap.h>
 #include <urjtag/data_register.h>
+#include <urjtag/tap_register.h>
 #include <urjtag/cmd.h>
 #include <urjtag/bsdl.h>
 
@@ -53,6 +54,10 @@ urj_tap_chain_alloc (void)
     chain->parts = NULL;
     chain->total_instr_len = 0;
     chain->active_part = 0;
+    chain->scan_in = NULL;
+    chain->scan_out = NULL;
+    chain->ir_shifted = NULL;
+    chain->ir_valid = 0;
     URJ_BSDL_GLOBS_INIT (chain->bsdl);
     urj_tap_state_init (chain);
 
@@ -68,6 +73,9 @@ urj_tap_chain_free (urj_chain_t *chain)
     urj_tap_chain_disconnect (chain);
 
     urj_part_parts_free (chain->parts);
+    urj_tap_register_free (chain->scan_in);
+    urj_tap_register_free (chain->scan_out);
+    urj_tap_register_free (chain->ir_shifted);
     free (chain);
 }
 
@@ -242,13 +250,22 @@ urj_tap_chain_get_pod_signal (urj_chain_t *chain, urj_pod_sigsel_t sig)
     return urj_tap_cable_get_signal (chain->cable, sig);
 }
 
-int
-urj_tap_chain_shift_instructions_mode (urj_chain_t *chain,
-                                       int capture_output, int capture,
-                                       int chain_exit)
+static urj_tap_register_t *
+chain_part_register (urj_part_t *part, int ir, int out)
+{
+    if (ir)
+        return out ? part->active_instruction->out
+            : part->active_instruction->value;
+
+    return out ? part->active_instruction->data_register->out
+        : part->active_instruction->data_register->in;
+}
+
+static int
+chain_check_parts (urj_chain_t *chain, int ir)
 {
-    int i;
     urj_parts_t *ps;
+    int i;
 
     if (!chain || !chain->parts)
     {
@@ -266,40 +283,235 @@ urj_tap_chain_shift_instructions_mode (urj_chain_t *chain,
                            _("Part %d without active instruction"), i);
             return URJ_STATUS_FAIL;
         }
+        if (!ir && ps->parts[i]->active_instruction->data_register == NULL)
+        {
+            urj_error_set (URJ_ERROR_NO_DATA_REGISTER,
+                           _("Part %d without data register"), i);
+            return URJ_STATUS_FAIL;
+        }
     }
 
-    if (capture)
-        urj_tap_capture_ir (chain);
+    return URJ_STATUS_OK;
+}
 
-    /* new implementation: split into defer + retrieve part
-       shift the data register of each part in the chain one by one */
+static int
+chain_registers_length (urj_chain_t *chain, int ir)
+{
+    urj_parts_t *ps = chain->parts;
+    int i, len;
 
+    len = 0;
     for (i = 0; i < ps->len; i++)
+        len += chain_part_register (ps->parts[i], ir, 0)->len;
+
+    return len;
+}
+
+/*
+ * Shift the instruction (ir != 0) or data registers of all parts in one
+ * go.  The registers are concatenated into a single scan register, part 0
+ * first, so the cable sees one transfer for the whole chain instead of one
+ * per part; a bypassed part just adds its single bit.  The scan registers
+ * are kept in the chain and only resized when the total length changes.
+ * The part offsets are summed up while copying rather than cached in the
+ * chain: instructions and data registers change without the chain being
+ * told (urj_part_set_instruction() knows no chain, SVF and PLD code resize
+ * data registers), and checking a cache costs the same walk over the parts.
+ * If defer_out is given, the captured bits of all parts are left in the
+ * cable queue for a later urj_tap_shift_register_output() into defer_out.
+ */
+static int
+chain_shift_registers (urj_chain_t *chain, int ir, int capture_output,
+                       int chain_exit, urj_tap_register_t *defer_out)
+{
+    urj_parts_t *ps = chain->parts;
+    urj_tap_register_t *in, *out;
+    int i, len, offset;
+
+    if (ps->len == 1)
     {
-        urj_tap_defer_shift_register (chain,
-                ps->parts[i]->active_instruction->value,
-                capture_output ? ps->parts[i]->active_instruction->out
-                    : NULL,
-                (i + 1) == ps->len ? chain_exit : URJ_CHAIN_EXITMODE_SHIFT);
+        in = chain_part_register (ps->parts[0], ir, 0);
+        if (defer_out)
+            out = defer_out;
+        else
+            out = capture_output ? chain_part_register (ps->parts[0], ir, 1)
+                : NULL;
+
+        urj_tap_defer_shift_register (chain, in, out, chain_exit);
+        if (defer_out)
+            return URJ_STATUS_OK;
+        if (capture_output)
+            urj_tap_shift_register_output (chain, in, out, chain_exit);
+        else
+            /* give the cable driver a chance to flush if it's considered useful */
+            urj_tap_cable_flush (chain->cable, URJ_TAP_CABLE_TO_OUTPUT);
+
+        return URJ_STATUS_OK;
     }
 
-    if (capture_output)
+    len = chain_registers_length (chain, ir);
+
+    if (chain->scan_in == NULL || chain->scan_in->len != len)
     {
-        for (i = 0; i < ps->len; i++)
+        in = urj_tap_register_realloc (chain->scan_in, len);
+        if (in == NULL)
         {
-            urj_tap_shift_register_output (chain,
-                    ps->parts[i]->active_instruction->value,
-                    ps->parts[i]->active_instruction->out,
-                    (i + 1) == ps->len ? chain_exit
-                        : URJ_CHAIN_EXITMODE_SHIFT);
+            urj_tap_register_free (chain->scan_in);
+            chain->scan_in = NULL;
+            return URJ_STATUS_FAIL;
         }
+        chain->scan_in = in;
     }
-    else
+
+    if (capture_output && !defer_out
+        && (chain->scan_out == NULL || chain->scan_out->len != len))
+    {
+        out = urj_tap_register_realloc (chain->scan_out, len);
+        if (out == NULL)
+        {
+            urj_tap_register_free (chain->scan_out);
+            chain->scan_out = NULL;
+            return URJ_STATUS_FAIL;
+        }
+        chain->scan_out = out;
+    }
+
+    for (i = 0, offset = 0; i < ps->len; i++)
+    {
+        in = chain_part_register (ps->parts[i], ir, 0);
+        memcpy (chain->scan_in->data + offset, in->data, in->len);
+        offset += in->len;
+    }
+
+    if (defer_out)
+    {
+        urj_tap_defer_shift_register (chain, chain->scan_in, defer_out,
+                                      chain_exit);
+        return URJ_STATUS_OK;
+    }
+
+    urj_tap_defer_shift_register (chain, chain->scan_in,
+                                  capture_output ? chain->scan_out : NULL,
+                                  chain_exit);
+
+    if (!capture_output)
     {
         /* give the cable driver a chance to flush if it's considered useful */
         urj_tap_cable_flush (chain->cable, URJ_TAP_CABLE_TO_OUTPUT);
+        return URJ_STATUS_OK;
+    }
+
+    urj_tap_shift_register_output (chain, chain->scan_in, chain->scan_out,
+                                   chain_exit);
+
+    for (i = 0, offset = 0; i < ps->len; i++)
+    {
+        in = chain_part_register (ps->parts[i], ir, 0);
+        out = chain_part_register (ps->parts[i], ir, 1);
+        memcpy (out->data, chain->scan_out->data + offset,
+                out->len < in->len ? out->len : in->len);
+        offset += in->len;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+/*
+ * The IR contents of the last complete instruction scan are kept in
+ * chain->ir_shifted.  chain->ir_valid is cleared whenever the instruction
+ * registers may have changed behind our back (any other IR scan, TAP reset,
+ * TRST), see urj_tap_chain_invalidate_ir().
+ */
+static int
+chain_ir_unchanged (urj_chain_t *chain)
+{
+    urj_parts_t *ps = chain->parts;
+    int i, offset;
+
+    if (!chain->ir_valid)
+        return 0;
+
+    for (i = 0, offset = 0; i < ps->len; i++)
+    {
+        urj_tap_register_t *ir = ps->parts[i]->active_instruction->value;
+
+        if (offset + ir->len > chain->ir_shifted->len
+            || memcmp (chain->ir_shifted->data + offset, ir->data, ir->len))
+            return 0;
+        offset += ir->len;
+    }
+
+    return offset == chain->ir_shifted->len;
+}
+
+static void
+chain_ir_remember (urj_chain_t *chain)
+{
+    urj_parts_t *ps = chain->parts;
+    urj_tap_register_t *r;
+    int i, len, offset;
+
+    len = 0;
+    for (i = 0; i < ps->len; i++)
+        len += ps->parts[i]->active_instruction->value->len;
+
+    if (chain->ir_shifted == NULL || chain->ir_shifted->len != len)
+    {
+        r = urj_tap_register_realloc (chain->ir_shifted, len);
+        if (r == NULL)
+        {
+            /* not fatal, the next IR scan is just not suppressed */
+            urj_tap_register_free (chain->ir_shifted);
+            chain->ir_shifted = NULL;
+            chain->ir_valid = 0;
+            return;
+        }
+        chain->ir_shifted = r;
     }
 
+    for (i = 0, offset = 0; i < ps->len; i++)
+    {
+        r = ps->parts[i]->active_instruction->value;
+        memcpy (chain->ir_shifted->data + offset, r->data, r->len);
+        offset += r->len;
+    }
+
+    chain->ir_valid = 1;
+}
+
+void
+urj_tap_chain_invalidate_ir (urj_chain_t *chain)
+{
+    if (chain)
+        chain->ir_valid = 0;
+}
+
+int
+urj_tap_chain_shift_instructions_mode (urj_chain_t *chain,
+                                       int capture_output, int capture,
+                                       int chain_exit)
+{
+    if (chain_check_parts (chain, 1) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    /* nothing to do if the chain is idle and every part still holds the
+       instruction it got with the last complete IR scan */
+    if (capture && !capture_output && chain_exit == URJ_CHAIN_EXITMODE_IDLE
+        && urj_tap_state (chain) == URJ_TAP_STATE_RUN_TEST_IDLE
+        && chain_ir_unchanged (chain))
+        return URJ_STATUS_OK;
+
+    if (capture)
+        urj_tap_capture_ir (chain);
+
+    if (chain_shift_registers (chain, 1, capture_output, chain_exit, NULL)
+        != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    if (capture && (chain_exit == URJ_CHAIN_EXITMODE_IDLE
+                    || chain_exit == URJ_CHAIN_EXITMODE_UPDATE))
+        chain_ir_remember (chain);
+
     return URJ_STATUS_OK;
 }
 
@@ -315,66 +527,58 @@ urj_tap_chain_shift_data_registers_mode (urj_chain_t *chain,
                                          int capture_output, int capture,
                                          int chain_exit)
 {
-    int i;
-    urj_parts_t *ps;
-
-    if (!chain || !chain->parts)
-    {
-        urj_error_set (URJ_ERROR_NO_CHAIN, "no chain or no part");
+    if (chain_check_parts (chain, 0) != URJ_STATUS_OK)
         return URJ_STATUS_FAIL;
-    }
-
-    ps = chain->parts;
-
-    for (i = 0; i < ps->len; i++)
-    {
-        if (ps->parts[i]->active_instruction == NULL)
-        {
-            urj_error_set (URJ_ERROR_NO_ACTIVE_INSTRUCTION,
-                           _("Part %d without active instruction"), i);
-            return URJ_STATUS_FAIL;
-        }
-        if (ps->parts[i]->active_instruction->data_register == NULL)
-        {
-            urj_error_set (URJ_ERROR_NO_DATA_REGISTER,
-                           _("Part %d without data register"), i);
-            return URJ_STATUS_FAIL;
-        }
-    }
 
     if (capture)
         urj_tap_capture_dr (chain);
 
-    /* new implementation: split into defer + retrieve part
-       shift the data register of each part in the chain one by one */
+    return chain_shift_registers (chain, 0, capture_output, chain_exit, NULL);
+}
 
-    for (i = 0; i < ps->len; i++)
-    {
-        urj_tap_defer_shift_register (chain,
-                ps->parts[i]->active_instruction->data_register->in,
-                capture_output ?
-                    ps->parts[i]->active_instruction->data_register->out
-                    : NULL,
-                (i + 1) == ps->len ? chain_exit : URJ_CHAIN_EXITMODE_SHIFT);
-    }
+static urj_tap_register_t *
+chain_defer_shift_registers (urj_chain_t *chain, int ir, int capture,
+                             int chain_exit)
+{
+    urj_tap_register_t *out;
+
+    if (chain_check_parts (chain, ir) != URJ_STATUS_OK)
+        return NULL;
 
-    if (capture_output)
+    out = urj_tap_register_alloc (chain_registers_length (chain, ir));
+    if (out == NULL)
+        return NULL;
+
+    if (capture)
     {
-        for (i = 0; i < ps->len; i++)
-        {
-            urj_tap_shift_register_output (chain,
-                    ps->parts[i]->active_instruction->data_register->in,
-                    ps->parts[i]->active_instruction->data_register->out,
-                    (i + 1) == ps->len ? chain_exit : URJ_CHAIN_EXITMODE_SHIFT);
-        }
+        if (ir)
+            urj_tap_capture_ir (chain);
+        else
+            urj_tap_capture_dr (chain);
     }
-    else
+
+    if (chain_shift_registers (chain, ir, 1, chain_exit, out)
+        != URJ_STATUS_OK)
     {
-        /* give the cable driver a chance to flush if it's considered useful */
-        urj_tap_cable_flush (chain->cable, URJ_TAP_CABLE_TO_OUTPUT);
+        urj_tap_register_free (out);
+        return NULL;
     }
 
-    return URJ_STATUS_OK;
+    return out;
+}
+
+urj_tap_register_t *
+urj_tap_chain_defer_shift_instructions_mode (urj_chain_t *chain, int capture,
+                                             int chain_exit)
+{
+    return chain_defer_shift_registers (chain, 1, capture, chain_exit);
+}
+
+urj_tap_register_t *
+urj_tap_chain_defer_shift_data_registers_mode (urj_chain_t *chain,
+                                               int capture, int chain_exit)
+{
+    return chain_defer_shift_registers (chain, 0, capture, chain_exit);
 }
 
 int
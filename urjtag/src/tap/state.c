@@ -75,6 +75,7 @@ urj_tap_state (urj_chain_t *chain)
 int
 urj_tap_state_init (urj_chain_t *chain)
 {
+    urj_tap_chain_invalidate_ir (chain);
     urj_tap_state_dump (URJ_TAP_STATE_UNKNOWN_STATE);
     return chain->state = URJ_TAP_STATE_UNKNOWN_STATE;
 }
@@ -82,6 +83,7 @@ urj_tap_state_init (urj_chain_t *chain)
 int
 urj_tap_state_done (urj_chain_t *chain)
 {
+    urj_tap_chain_invalidate_ir (chain);
     urj_tap_state_dump (URJ_TAP_STATE_UNKNOWN_STATE);
     return chain->state = URJ_TAP_STATE_UNKNOWN_STATE;
 }
@@ -89,6 +91,7 @@ urj_tap_state_done (urj_chain_t *chain)
 int
 urj_tap_state_reset (urj_chain_t *chain)
 {
+    urj_tap_chain_invalidate_ir (chain);
     urj_tap_state_dump (URJ_TAP_STATE_TEST_LOGIC_RESET);
     return chain->state = URJ_TAP_STATE_TEST_LOGIC_RESET;
 }
@@ -101,6 +104,7 @@ urj_tap_state_set_trst (urj_chain_t *chain, int old_trst, int new_trst)
 
     if (old_trst != new_trst)
     {
+        urj_tap_chain_invalidate_ir (chain);
         if (new_trst)
             chain->state = URJ_TAP_STATE_TEST_LOGIC_RESET;
         else
@@ -200,6 +204,12 @@ urj_tap_state_clock (urj_chain_t *chain, int tms)
         }
     }
 
+    /* Test-Logic-Reset loads IDCODE or BYPASS into the instruction registers,
+       any IR scan may shift something else than the parts' instructions */
+    if ((chain->state & URJ_TAP_STATE_RESET)
+        || chain->state == URJ_TAP_STATE_CAPTURE_IR)
+        urj_tap_chain_invalidate_ir (chain);
+
     urj_tap_state_dump_2 (oldstate, chain->state, tms);
     return chain->state;
 }